@@ -0,0 +1,624 @@
+/**
+ * @file dmem_bench.c
+ * @author Southern Sandbox
+ * @brief dmem 性能测试：在同一组可重复的负载下对比 dmem 与系统 malloc
+ * @note 负载包括固定大小反复申请释放、幂律分布的混合大小、realloc 逐步扩容的缓冲区、长短生命周期混合，
+ *       每次操作单独计时，输出每次操作耗时的均值与分位数 (ns)、峰值占用 (KiB) 以及负载结束前的外部碎片率 (‰)。
+ *       用法：dmem_bench [--ops N] [--seed S] [--quick] [--slab] [--policy P] [--workload NAME] [--record FILE] [--events FILE] [--walk FILE]
+ *       --record 将 dmem 运行各负载时的分配记录写入文件，可用 dmem_replay 重放（此时 dmem 的耗时包含记录的开销）
+ *       --events 以 DEBUG 级别记录 dmem 的事件日志并写入文件，可用 dmem_events 格式化（此时 dmem 的耗时包含事件日志的开销）
+ *       --walk 在各负载结束前将 dmem 的内存块布局写入文件，可用 dmem_fragmap 绘制碎片分布图
+ * @date 2025-08-09
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 199309L     // clock_gettime()
+#endif
+#include "dmem.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+#include "time.h"
+#if defined(__GLIBC__)
+    #include "malloc.h"
+#endif
+
+#define BENCH_POOL_SIZE         (64u << 20)     // 内存池大小，需 DMEM_OFFSET_WIDTH >= 32
+#define BENCH_DEFAULT_OPS       200000          // 每个负载默认的操作次数
+#define BENCH_QUICK_OPS         5000            // --quick 时每个负载的操作次数
+#define BENCH_SAMPLE_PERIOD     256             // 每隔多少次操作采样一次内存占用
+#define BENCH_FRAG_UNKNOWN      UINT32_MAX
+
+#if DMEM_OFFSET_WIDTH < 32
+    #error "dmem_bench requires DMEM_OFFSET_WIDTH >= 32"
+#endif
+
+DMEM_DEFAULT_ALIGNED(static char bench_pool[BENCH_POOL_SIZE]);
+
+/**
+ * @brief 被测分配器
+ */
+struct bench_allocator
+{
+    const char* name;
+    void  (*reset)(void);                       /** 每个负载开始前调用 **/
+    void* (*alloc)(size_t size);
+    void* (*realloc)(void* mem, size_t size);
+    void  (*free)(void* mem);
+    size_t (*footprint)(void);                  /** 当前（或历史峰值）占用，单位：字节，定期采样取最大值 **/
+    uint32_t (*frag)(void);                     /** 外部碎片率 (‰)，不支持时返回 BENCH_FRAG_UNKNOWN **/
+};
+
+/**
+ * @brief 单个负载的运行上下文与结果
+ */
+struct bench_ctx
+{
+    const struct bench_allocator* a;
+    uint64_t rng;
+    uint32_t* samples;          /** 每次操作的耗时 (ns) **/
+    size_t ops;                 /** 需要执行的操作次数 **/
+    size_t done;                /** 已执行的操作次数 **/
+    size_t fails;               /** 分配失败次数 **/
+    size_t base;                /** 负载开始时的占用 **/
+    size_t peak;                /** 负载期间的峰值占用 **/
+    uint32_t frag;
+};
+
+static struct dmem_heap bench_heap;
+static bool bench_slab = false;
+static int bench_policy = -1;
+static uint32_t bench_timer_overhead = 0;
+#if ENABLE_DMEM_RECORD
+static FILE* bench_record_fp = NULL;
+static struct dmem_record bench_records[4096];
+#endif
+#if ENABLE_DMEM_EVENT
+static FILE* bench_event_fp = NULL;
+static struct dmem_event bench_events[8192];       // 每次采样时读出，需容纳 BENCH_SAMPLE_PERIOD 次操作产生的事件
+#endif
+static FILE* bench_walk_fp = NULL;
+
+/*********************************************************************************************************
+ * 计时与随机数
+ *********************************************************************************************************/
+
+static inline uint64_t _now_ns(void)
+{
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+static inline uint32_t _rand(struct bench_ctx* ctx)
+{
+    // xorshift64*，保证各分配器在同一种子下得到完全相同的操作序列
+    ctx->rng ^= ctx->rng >> 12;
+    ctx->rng ^= ctx->rng << 25;
+    ctx->rng ^= ctx->rng >> 27;
+    return (uint32_t) ((ctx->rng * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static int _cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 估计一次计时本身的开销，结果从每次操作的耗时中扣除
+ */
+static void _calibrate_timer(void)
+{
+    enum { N = 4096 };
+    static uint32_t t[N];
+    for(int i = 0; i < N; i++)
+    {
+        uint64_t t0 = _now_ns();
+        t[i] = (uint32_t) (_now_ns() - t0);
+    }
+    qsort(t, N, sizeof(t[0]), _cmp_u32);
+    bench_timer_overhead = t[N / 2];
+}
+
+/*********************************************************************************************************
+ * 被测分配器：dmem
+ *********************************************************************************************************/
+
+#if ENABLE_DMEM_RECORD
+static void _dmem_record_drain(const struct dmem_record* records, size_t count, void* arg)
+{
+    fwrite(records, sizeof(records[0]), count, (FILE*) arg);
+}
+#endif
+
+#if ENABLE_DMEM_EVENT
+static void _dmem_event_drain(void)
+{
+    static struct dmem_event out[1024];
+    size_t n;
+    uint32_t lost;
+
+    while((n = dmem_heap_event_read(&bench_heap, out, sizeof(out) / sizeof(out[0]), &lost)) > 0)
+    {
+        if(lost)
+            fprintf(stderr, "dmem_bench: %lu events lost\n", (unsigned long) lost);
+        fwrite(out, sizeof(out[0]), n, bench_event_fp);
+    }
+}
+#endif
+
+static bool _dmem_walk_dump(const struct dmem_walk_info* info, void* arg)
+{
+    return fwrite(info, sizeof(*info), 1, (FILE*) arg) == 1;
+}
+
+static void _dmem_reset(void)
+{
+#if ENABLE_DMEM_RECORD
+    if(bench_record_fp != NULL)
+        dmem_heap_record_stop(&bench_heap);         // 取走上一个负载的记录
+#endif
+#if ENABLE_DMEM_EVENT
+    if(bench_event_fp != NULL)
+    {
+        _dmem_event_drain();                        // 读出上一个负载的事件
+        dmem_heap_event_stop(&bench_heap);
+    }
+#endif
+    dmem_heap_init(&bench_heap, bench_pool, sizeof(bench_pool));
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+    if(bench_policy >= 0)
+        dmem_heap_set_policy(&bench_heap, bench_policy);
+#endif
+#if ENABLE_DMEM_SLAB
+    if(bench_slab)
+        dmem_heap_slab_enable(&bench_heap, true);
+#endif
+#if ENABLE_DMEM_RECORD
+    if(bench_record_fp != NULL)
+        dmem_heap_record_start(&bench_heap, bench_records, sizeof(bench_records) / sizeof(bench_records[0]), _dmem_record_drain, bench_record_fp);
+#endif
+#if ENABLE_DMEM_EVENT
+    if(bench_event_fp != NULL)
+        dmem_heap_event_start(&bench_heap, bench_events, sizeof(bench_events) / sizeof(bench_events[0]), DMEM_EVENT_LEVEL_DEBUG);
+#endif
+}
+
+static void* _dmem_alloc(size_t size)               { return dmem_heap_alloc(&bench_heap, size); }
+static void* _dmem_realloc(void* mem, size_t size)  { return dmem_heap_realloc(&bench_heap, mem, size); }
+static void  _dmem_free(void* mem)                  { dmem_heap_free(&bench_heap, mem); }
+
+static size_t _dmem_footprint(void)
+{
+    struct dmem_use_report r;
+    dmem_heap_report(&bench_heap, &r);
+    return (size_t) r.max_usage;
+}
+
+static uint32_t _dmem_frag(void)
+{
+    struct dmem_frag_report f;
+    dmem_heap_frag_report(&bench_heap, &f);
+    return f.fragmentation;
+}
+
+/*********************************************************************************************************
+ * 被测分配器：系统 malloc
+ *********************************************************************************************************/
+
+static void _malloc_reset(void)
+{
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+static void* _malloc_alloc(size_t size)             { return malloc(size); }
+static void* _malloc_realloc(void* mem, size_t size){ return realloc(mem, size); }
+static void  _malloc_free(void* mem)                { free(mem); }
+
+static size_t _malloc_footprint(void)
+{
+    // 已分配的堆内存（含块头）与 mmap 分配的大块内存，与 dmem 的 max_usage 口径一致
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+    #if __GLIBC_PREREQ(2, 33)
+        struct mallinfo2 mi = mallinfo2();
+        return mi.uordblks + mi.hblkhd;
+    #else
+        struct mallinfo mi = mallinfo();
+        return (size_t) (unsigned) mi.uordblks + (size_t) (unsigned) mi.hblkhd;
+    #endif
+#else
+    return 0;
+#endif
+}
+
+static uint32_t _malloc_frag(void)
+{
+    return BENCH_FRAG_UNKNOWN;
+}
+
+static const struct bench_allocator bench_allocators[] =
+{
+    { "dmem",   _dmem_reset,   _dmem_alloc,   _dmem_realloc,   _dmem_free,   _dmem_footprint,   _dmem_frag   },
+    { "malloc", _malloc_reset, _malloc_alloc, _malloc_realloc, _malloc_free, _malloc_footprint, _malloc_frag },
+};
+
+/*********************************************************************************************************
+ * 计时包装：每次调用记为一次操作
+ *********************************************************************************************************/
+
+static void _sample(struct bench_ctx* ctx)
+{
+    if(ctx->done % BENCH_SAMPLE_PERIOD == 0)
+    {
+        size_t fp = ctx->a->footprint();
+        if(fp > ctx->peak)
+            ctx->peak = fp;
+#if ENABLE_DMEM_EVENT
+        if(bench_event_fp != NULL && ctx->a->reset == _dmem_reset)
+            _dmem_event_drain();
+#endif
+    }
+}
+
+static void _record(struct bench_ctx* ctx, uint64_t t0, uint64_t t1)
+{
+    uint64_t dt = t1 - t0;
+    dt = dt > bench_timer_overhead ? dt - bench_timer_overhead : 0;
+    ctx->samples[ctx->done++] = dt > UINT32_MAX ? UINT32_MAX : (uint32_t) dt;
+    _sample(ctx);
+}
+
+static void* _op_alloc(struct bench_ctx* ctx, size_t size)
+{
+    uint64_t t0 = _now_ns();
+    void* p = ctx->a->alloc(size);
+    _record(ctx, t0, _now_ns());
+    if(p == NULL)
+        ctx->fails++;
+    else
+        memset(p, 0xA5, size < 64 ? size : 64);     // 模拟写入，计时之外进行
+    return p;
+}
+
+static void* _op_realloc(struct bench_ctx* ctx, void* mem, size_t size)
+{
+    uint64_t t0 = _now_ns();
+    void* p = ctx->a->realloc(mem, size);
+    _record(ctx, t0, _now_ns());
+    if(p == NULL)
+        ctx->fails++;
+    return p;
+}
+
+static void _op_free(struct bench_ctx* ctx, void* mem)
+{
+    uint64_t t0 = _now_ns();
+    ctx->a->free(mem);
+    _record(ctx, t0, _now_ns());
+}
+
+/**
+ * @brief 负载主循环结束、释放剩余内存前记录碎片率
+ */
+static void _steady_state(struct bench_ctx* ctx)
+{
+    size_t fp = ctx->a->footprint();
+    if(fp > ctx->peak)
+        ctx->peak = fp;
+    ctx->frag = ctx->a->frag();
+    if(bench_walk_fp != NULL && ctx->a->reset == _dmem_reset)
+        dmem_heap_walk(&bench_heap, _dmem_walk_dump, bench_walk_fp);
+}
+
+/*********************************************************************************************************
+ * 负载
+ *********************************************************************************************************/
+
+/**
+ * @brief 固定大小反复申请释放：4096 个槽位随机翻转，每次 64 字节
+ */
+static void _wl_churn(struct bench_ctx* ctx)
+{
+    enum { SLOTS = 4096, SIZE = 64 };
+    static void* slot[SLOTS];
+    memset(slot, 0, sizeof(slot));
+    while(ctx->done < ctx->ops)
+    {
+        uint32_t i = _rand(ctx) % SLOTS;
+        if(slot[i] == NULL)
+            slot[i] = _op_alloc(ctx, SIZE);
+        else
+        {
+            _op_free(ctx, slot[i]);
+            slot[i] = NULL;
+        }
+    }
+    _steady_state(ctx);
+    for(int i = 0; i < SLOTS; i++)
+        if(slot[i]) ctx->a->free(slot[i]);
+}
+
+/**
+ * @brief 幂律分布的混合大小：第 k 档 [16 * 2^k, 32 * 2^k) 字节的概率为 2^-(k+1)，k = 0..10
+ */
+static void _wl_powerlaw(struct bench_ctx* ctx)
+{
+    enum { SLOTS = 4096 };
+    static void* slot[SLOTS];
+    memset(slot, 0, sizeof(slot));
+    while(ctx->done < ctx->ops)
+    {
+        uint32_t i = _rand(ctx) % SLOTS;
+        if(slot[i] == NULL)
+        {
+            uint32_t r = _rand(ctx), k = 0;
+            while(k < 10 && (r & (1u << k)) == 0)
+                k++;
+            size_t size = ((size_t) 16 << k) + _rand(ctx) % ((size_t) 16 << k);
+            slot[i] = _op_alloc(ctx, size);
+        }
+        else
+        {
+            _op_free(ctx, slot[i]);
+            slot[i] = NULL;
+        }
+    }
+    _steady_state(ctx);
+    for(int i = 0; i < SLOTS; i++)
+        if(slot[i]) ctx->a->free(slot[i]);
+}
+
+/**
+ * @brief realloc 逐步扩容：256 个缓冲区从 16 字节起每次扩大 1.5 倍，超过 64 KiB 后释放重新开始
+ */
+static void _wl_realloc(struct bench_ctx* ctx)
+{
+    enum { BUFS = 256, LIMIT = 64 * 1024 };
+    static void* buf[BUFS];
+    static size_t len[BUFS];
+    memset(buf, 0, sizeof(buf));
+    while(ctx->done < ctx->ops)
+    {
+        uint32_t i = _rand(ctx) % BUFS;
+        if(buf[i] == NULL)
+        {
+            len[i] = 16;
+            buf[i] = _op_alloc(ctx, len[i]);
+        }
+        else if(len[i] >= LIMIT)
+        {
+            _op_free(ctx, buf[i]);
+            buf[i] = NULL;
+        }
+        else
+        {
+            size_t n = len[i] + len[i] / 2;
+            void* p = _op_realloc(ctx, buf[i], n);
+            if(p != NULL)
+            {
+                ((char*) p)[n - 1] = (char) n;
+                buf[i] = p;
+                len[i] = n;
+            }
+        }
+    }
+    _steady_state(ctx);
+    for(int i = 0; i < BUFS; i++)
+        if(buf[i]) ctx->a->free(buf[i]);
+}
+
+/**
+ * @brief 长短生命周期混合：1/16 的操作替换 2048 个长期对象之一 (32~2047 字节)，
+ *        其余操作在深度 64 的 FIFO 中申请或释放短期对象 (16~511 字节)
+ */
+static void _wl_lifetime(struct bench_ctx* ctx)
+{
+    enum { LONG = 2048, DEPTH = 64 };
+    static void* lng[LONG];
+    static void* fifo[DEPTH];
+    size_t head = 0, count = 0;
+    memset(lng, 0, sizeof(lng));
+    while(ctx->done < ctx->ops)
+    {
+        uint32_t r = _rand(ctx);
+        if(r % 16 == 0)
+        {
+            uint32_t i = _rand(ctx) % LONG;
+            if(lng[i] == NULL)
+                lng[i] = _op_alloc(ctx, 32 + _rand(ctx) % 2016);
+            else
+            {
+                _op_free(ctx, lng[i]);
+                lng[i] = NULL;
+            }
+        }
+        else if(count == DEPTH || (count > 0 && (r >> 8) % 2 == 0))
+        {
+            if(fifo[head]) _op_free(ctx, fifo[head]);
+            head = (head + 1) % DEPTH;
+            count--;
+        }
+        else
+        {
+            fifo[(head + count) % DEPTH] = _op_alloc(ctx, 16 + _rand(ctx) % 496);
+            count++;
+        }
+    }
+    _steady_state(ctx);
+    for(; count > 0; count--, head = (head + 1) % DEPTH)
+        if(fifo[head]) ctx->a->free(fifo[head]);
+    for(int i = 0; i < LONG; i++)
+        if(lng[i]) ctx->a->free(lng[i]);
+}
+
+static const struct
+{
+    const char* name;
+    void (*run)(struct bench_ctx* ctx);
+} bench_workloads[] =
+{
+    { "churn",    _wl_churn    },
+    { "powerlaw", _wl_powerlaw },
+    { "realloc",  _wl_realloc  },
+    { "lifetime", _wl_lifetime },
+};
+
+/*********************************************************************************************************
+ * 运行与输出
+ *********************************************************************************************************/
+
+static void _run(const char* wl, void (*run)(struct bench_ctx*), const struct bench_allocator* a, size_t ops, uint64_t seed, uint32_t* samples)
+{
+    struct bench_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.a = a;
+    ctx.rng = seed * 0x9E3779B97F4A7C15ull + 1;
+    ctx.samples = samples;
+    ctx.ops = ops;
+
+    a->reset();
+    ctx.base = a->footprint();
+    ctx.peak = ctx.base;
+    run(&ctx);
+
+    uint64_t sum = 0;
+    for(size_t i = 0; i < ctx.done; i++)
+        sum += samples[i];
+    qsort(samples, ctx.done, sizeof(samples[0]), _cmp_u32);
+    #define PCT(p)  samples[(size_t) ((ctx.done - 1) * (p))]
+
+    printf("%-10s %-8s %8.1f %6u %6u %6u %7u %8u %10lu ",
+           wl, a->name, (double) sum / ctx.done, PCT(0.50), PCT(0.90), PCT(0.99), PCT(0.999), samples[ctx.done - 1],
+           (unsigned long) ((ctx.peak - ctx.base) >> 10));
+    if(ctx.frag == BENCH_FRAG_UNKNOWN)
+        printf("%8s", "-");
+    else
+        printf("%8u", ctx.frag);
+    printf(" %6lu\n", (unsigned long) ctx.fails);
+    #undef PCT
+}
+
+static void _usage(const char* prog)
+{
+    printf("usage: %s [--ops N] [--seed S] [--quick] [--slab] [--policy P] [--workload NAME] [--record FILE] [--events FILE] [--walk FILE]\n", prog);
+    printf("workloads:");
+    for(size_t i = 0; i < sizeof(bench_workloads) / sizeof(bench_workloads[0]); i++)
+        printf(" %s", bench_workloads[i].name);
+    printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+    size_t ops = BENCH_DEFAULT_OPS;
+    uint64_t seed = 1;
+    const char* only = NULL;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--ops") == 0 && i + 1 < argc)
+            ops = strtoul(argv[++i], NULL, 0);
+        else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 0);
+        else if(strcmp(argv[i], "--quick") == 0)
+            ops = BENCH_QUICK_OPS;
+        else if(strcmp(argv[i], "--slab") == 0)
+            bench_slab = true;
+        else if(strcmp(argv[i], "--policy") == 0 && i + 1 < argc)
+            bench_policy = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--workload") == 0 && i + 1 < argc)
+            only = argv[++i];
+#if ENABLE_DMEM_RECORD
+        else if(strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            if((bench_record_fp = fopen(argv[++i], "wb")) == NULL)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+        }
+#endif
+#if ENABLE_DMEM_EVENT
+        else if(strcmp(argv[i], "--events") == 0 && i + 1 < argc)
+        {
+            if((bench_event_fp = fopen(argv[++i], "wb")) == NULL)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+        }
+#endif
+        else if(strcmp(argv[i], "--walk") == 0 && i + 1 < argc)
+        {
+            if((bench_walk_fp = fopen(argv[++i], "wb")) == NULL)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+        }
+        else
+        {
+            _usage(argv[0]);
+            return 1;
+        }
+    }
+    if(ops == 0)
+    {
+        _usage(argv[0]);
+        return 1;
+    }
+
+    uint32_t* samples = malloc(ops * sizeof(uint32_t));
+    if(samples == NULL)
+        return 1;
+    _calibrate_timer();
+
+    printf("dmem_bench: engine %s, pool %u MiB, %lu ops/workload, seed %llu, slab %s, policy %d, timer overhead %u ns\n",
+           DMEM_ALLOC_ENGINE == DMEM_ENGINE_TLSF ? "tlsf" : "first-fit", BENCH_POOL_SIZE >> 20, (unsigned long) ops,
+           (unsigned long long) seed, bench_slab ? "on" : "off", bench_policy, bench_timer_overhead);
+    printf("%-10s %-8s %8s %6s %6s %6s %7s %8s %10s %8s %6s\n",
+           "workload", "alloc", "mean(ns)", "p50", "p90", "p99", "p99.9", "max", "peak(KiB)", "frag(‰)", "fail");
+
+    int ran = 0;
+    for(size_t w = 0; w < sizeof(bench_workloads) / sizeof(bench_workloads[0]); w++)
+    {
+        if(only && strcmp(only, bench_workloads[w].name) != 0)
+            continue;
+        for(size_t k = 0; k < sizeof(bench_allocators) / sizeof(bench_allocators[0]); k++)
+            _run(bench_workloads[w].name, bench_workloads[w].run, &bench_allocators[k], ops, seed, samples);
+        ran++;
+    }
+    free(samples);
+#if ENABLE_DMEM_RECORD
+    if(bench_record_fp != NULL)
+    {
+        dmem_heap_record_stop(&bench_heap);
+        fclose(bench_record_fp);
+    }
+#endif
+#if ENABLE_DMEM_EVENT
+    if(bench_event_fp != NULL)
+    {
+        _dmem_event_drain();
+        dmem_heap_event_stop(&bench_heap);
+        fclose(bench_event_fp);
+    }
+#endif
+    if(bench_walk_fp != NULL)
+        fclose(bench_walk_fp);
+    if(ran == 0)
+    {
+        _usage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,347 @@
+/**
+ * @file dmem_bench_cpp.cpp
+ * @author Southern Sandbox
+ * @brief C++ 容器性能测试：在同一组可重复的容器负载下对比 std::allocator、dmem::allocator 与 std::pmr
+ * @note 负载包括 std::vector 逐个追加元素、std::unordered_map 与 std::map 随机插入删除、std::string 随机创建销毁，
+ *       输出每次容器操作的平均耗时 (ns)、dmem 的峰值占用 (KiB) 与校验和，各分配器的校验和必须一致，
+ *       dmem 在每个负载结束后不得残留内存块，否则以非 0 退出。
+ *       pmr-new 使用 std::pmr::new_delete_resource()，用于区分虚函数调用与分配器本身的开销。
+ *       用法：dmem_bench_cpp [--ops N] [--seed S] [--quick] [--slab] [--workload NAME]
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "dmem.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define BENCH_POOL_SIZE         (64u << 20)     // 内存池大小，需 DMEM_OFFSET_WIDTH >= 32
+#define BENCH_DEFAULT_OPS       1000000         // 每个负载默认的容器操作次数
+#define BENCH_QUICK_OPS         20000           // --quick 时每个负载的容器操作次数
+#define BENCH_KEY_RANGE         4096            // 关联容器的键范围
+#define BENCH_STRING_LIVE       1024            // 同时存活的字符串数量上限
+
+#if DMEM_OFFSET_WIDTH < 32
+    #error "dmem_bench_cpp requires DMEM_OFFSET_WIDTH >= 32"
+#endif
+
+DMEM_DEFAULT_ALIGNED(static char bench_pool[BENCH_POOL_SIZE]);
+
+static bool bench_slab = false;
+
+/*********************************************************************************************************
+ * 随机数
+ *********************************************************************************************************/
+
+struct bench_rng
+{
+    uint64_t s;
+};
+
+static inline uint32_t _rand(bench_rng& r)
+{
+    // xorshift64*，保证各分配器在同一种子下得到完全相同的操作序列
+    r.s ^= r.s >> 12;
+    r.s ^= r.s << 25;
+    r.s ^= r.s >> 27;
+    return (uint32_t) ((r.s * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+template <class A, class T>
+using rebind_t = typename std::allocator_traits<A>::template rebind_alloc<T>;
+
+/*********************************************************************************************************
+ * 负载：以 char 的分配器为参数，容器各自 rebind 到所需的类型，返回与分配器无关的校验和
+ *********************************************************************************************************/
+
+/**
+ * @brief std::vector 逐个追加元素，每轮追加随机数量后销毁，考察扩容时的重新分配
+ */
+template <class A>
+static uint64_t _wl_vector(const A& a, bench_rng& r, size_t ops)
+{
+    uint64_t sum = 0;
+    size_t done = 0;
+    while(done < ops)
+    {
+        std::vector<uint64_t, rebind_t<A, uint64_t>> v{rebind_t<A, uint64_t>(a)};
+        size_t n = _rand(r) % 1024 + 1;
+        for(size_t i = 0; i < n; i++)
+            v.push_back(_rand(r));
+        for(uint64_t x : v)
+            sum += x;
+        done += n;
+    }
+    return sum;
+}
+
+/**
+ * @brief std::unordered_map 随机插入删除，每次插入分配一个节点，扩容时重新分配桶数组
+ */
+template <class A>
+static uint64_t _wl_umap(const A& a, bench_rng& r, size_t ops)
+{
+    using value_type = std::pair<const uint32_t, uint64_t>;
+    std::unordered_map<uint32_t, uint64_t, std::hash<uint32_t>, std::equal_to<uint32_t>, rebind_t<A, value_type>>
+        m(16, std::hash<uint32_t>(), std::equal_to<uint32_t>(), rebind_t<A, value_type>(a));
+    uint64_t sum = 0;
+    for(size_t i = 0; i < ops; i++)
+    {
+        uint32_t x = _rand(r);
+        uint32_t key = x % BENCH_KEY_RANGE;
+        if(x & 0x80000000u)
+            m.erase(key);
+        else
+            m[key] += x;
+    }
+    for(const auto& kv : m)
+        sum += kv.first * 31ull + kv.second;
+    return sum + m.size();
+}
+
+/**
+ * @brief std::map 随机插入删除，节点大小固定
+ */
+template <class A>
+static uint64_t _wl_map(const A& a, bench_rng& r, size_t ops)
+{
+    using value_type = std::pair<const uint32_t, uint64_t>;
+    std::map<uint32_t, uint64_t, std::less<uint32_t>, rebind_t<A, value_type>> m{std::less<uint32_t>(), rebind_t<A, value_type>(a)};
+    uint64_t sum = 0;
+    for(size_t i = 0; i < ops; i++)
+    {
+        uint32_t x = _rand(r);
+        uint32_t key = x % BENCH_KEY_RANGE;
+        if(x & 0x80000000u)
+            m.erase(key);
+        else
+            m[key] += x;
+    }
+    for(const auto& kv : m)
+        sum += kv.first * 31ull + kv.second;
+    return sum + m.size();
+}
+
+/**
+ * @brief std::string 随机创建与销毁，长度超过短字符串优化的容量，大小随机
+ */
+template <class A>
+static uint64_t _wl_string(const A& a, bench_rng& r, size_t ops)
+{
+    using string_type = std::basic_string<char, std::char_traits<char>, rebind_t<A, char>>;
+    std::vector<string_type, rebind_t<A, string_type>> v{rebind_t<A, string_type>(a)};
+    uint64_t sum = 0;
+    v.reserve(BENCH_STRING_LIVE);
+    for(size_t i = 0; i < ops; i++)
+    {
+        uint32_t x = _rand(r);
+        if(v.size() < BENCH_STRING_LIVE && (v.empty() || (x & 1)))
+        {
+            // 元素由容器按 uses-allocator 规则构造，std::pmr 容器会自动传入内存资源
+            v.emplace_back((size_t) (x >> 8) % 240 + 16, (char) ('a' + (x >> 1) % 26));
+            sum += v.back().size() * (unsigned char) v.back()[0];
+        }
+        else
+        {
+            size_t k = (x >> 1) % v.size();
+            sum += v[k].size();
+            v[k].swap(v.back());
+            v.pop_back();
+        }
+    }
+    return sum + v.size();
+}
+
+static const struct
+{
+    const char* name;
+} bench_workloads[] =
+{
+    { "vector" },
+    { "umap"   },
+    { "map"    },
+    { "string" },
+};
+
+template <class A>
+static uint64_t _run_workload(size_t wl, const A& a, bench_rng& r, size_t ops)
+{
+    switch(wl)
+    {
+    case 0:  return _wl_vector(a, r, ops);
+    case 1:  return _wl_umap(a, r, ops);
+    case 2:  return _wl_map(a, r, ops);
+    default: return _wl_string(a, r, ops);
+    }
+}
+
+/*********************************************************************************************************
+ * 被测分配器
+ *********************************************************************************************************/
+
+enum bench_alloc_kind
+{
+    BENCH_STD,
+    BENCH_DMEM,
+#if DMEM_HPP_PMR
+    BENCH_PMR_NEW,
+    BENCH_PMR_DMEM,
+#endif
+    BENCH_ALLOC_COUNT
+};
+
+static const char* const bench_alloc_names[BENCH_ALLOC_COUNT] =
+{
+    "std",
+    "dmem",
+#if DMEM_HPP_PMR
+    "pmr-new",
+    "pmr-dmem",
+#endif
+};
+
+static void _dmem_reset(void)
+{
+    dmem_init(bench_pool, sizeof(bench_pool));
+#if ENABLE_DMEM_SLAB
+    if(bench_slab)
+        dmem_heap_slab_enable(dmem_default_heap(), true);
+#endif
+}
+
+/**
+ * @brief 运行一个负载
+ * @return int 0 成功，1 dmem 残留内存块
+ */
+static int _run(size_t wl, int kind, size_t ops, uint64_t seed, uint64_t* sum)
+{
+    bench_rng r = { seed * 0x9E3779B97F4A7C15ull + 1 };
+    bool uses_dmem = kind != BENCH_STD;
+#if DMEM_HPP_PMR
+    uses_dmem = uses_dmem && kind != BENCH_PMR_NEW;
+#endif
+    if(uses_dmem)
+        _dmem_reset();
+
+    auto t0 = std::chrono::steady_clock::now();
+    switch(kind)
+    {
+    case BENCH_STD:
+        *sum = _run_workload(wl, std::allocator<char>(), r, ops);
+        break;
+    case BENCH_DMEM:
+        *sum = _run_workload(wl, dmem::allocator<char>(), r, ops);
+        break;
+#if DMEM_HPP_PMR
+    case BENCH_PMR_NEW:
+        *sum = _run_workload(wl, std::pmr::polymorphic_allocator<char>(std::pmr::new_delete_resource()), r, ops);
+        break;
+    case BENCH_PMR_DMEM:
+    {
+        dmem::memory_resource res;
+        *sum = _run_workload(wl, std::pmr::polymorphic_allocator<char>(&res), r, ops);
+        break;
+    }
+#endif
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+
+    printf("%-8s %-9s %9.1f ", bench_workloads[wl].name, bench_alloc_names[kind], ns / ops);
+    if(!uses_dmem)
+    {
+        printf("%10s %18llx\n", "-", (unsigned long long) *sum);
+        return 0;
+    }
+
+    struct dmem_use_report rep;
+    dmem_read_use_report(&rep);
+    printf("%10lu %18llx\n", (unsigned long) (rep.max_usage >> 10), (unsigned long long) *sum);
+    if(rep.used_count != 0)
+    {
+        fprintf(stderr, "dmem_bench_cpp: %s/%s leaves %lu blocks\n", bench_workloads[wl].name, bench_alloc_names[kind], (unsigned long) rep.used_count);
+        return 1;
+    }
+    return 0;
+}
+
+static void _usage(const char* prog)
+{
+    printf("usage: %s [--ops N] [--seed S] [--quick] [--slab] [--workload NAME]\n", prog);
+    printf("workloads:");
+    for(size_t i = 0; i < sizeof(bench_workloads) / sizeof(bench_workloads[0]); i++)
+        printf(" %s", bench_workloads[i].name);
+    printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+    size_t ops = BENCH_DEFAULT_OPS;
+    uint64_t seed = 1;
+    const char* only = NULL;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--ops") == 0 && i + 1 < argc)
+            ops = strtoul(argv[++i], NULL, 0);
+        else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 0);
+        else if(strcmp(argv[i], "--quick") == 0)
+            ops = BENCH_QUICK_OPS;
+        else if(strcmp(argv[i], "--slab") == 0)
+            bench_slab = true;
+        else if(strcmp(argv[i], "--workload") == 0 && i + 1 < argc)
+            only = argv[++i];
+        else
+        {
+            _usage(argv[0]);
+            return 1;
+        }
+    }
+    if(ops == 0)
+    {
+        _usage(argv[0]);
+        return 1;
+    }
+
+    printf("dmem_bench_cpp: engine %s, pool %u MiB, %lu ops/workload, seed %llu, slab %s, align %d\n",
+           DMEM_ALLOC_ENGINE == DMEM_ENGINE_TLSF ? "tlsf" : "first-fit", BENCH_POOL_SIZE >> 20, (unsigned long) ops,
+           (unsigned long long) seed, bench_slab ? "on" : "off", DMEM_DEFINE_ALIGN_SIZE);
+    printf("%-8s %-9s %9s %10s %18s\n", "workload", "alloc", "ns/op", "peak(KiB)", "checksum");
+
+    int ran = 0, err = 0;
+    for(size_t w = 0; w < sizeof(bench_workloads) / sizeof(bench_workloads[0]); w++)
+    {
+        if(only && strcmp(only, bench_workloads[w].name) != 0)
+            continue;
+        uint64_t expect = 0;
+        for(int k = 0; k < BENCH_ALLOC_COUNT; k++)
+        {
+            uint64_t sum;
+            err |= _run(w, k, ops, seed, &sum);
+            if(k == 0)
+                expect = sum;
+            else if(sum != expect)
+            {
+                fprintf(stderr, "dmem_bench_cpp: %s/%s checksum mismatch\n", bench_workloads[w].name, bench_alloc_names[k]);
+                err = 1;
+            }
+        }
+        ran++;
+    }
+    if(ran == 0)
+    {
+        _usage(argv[0]);
+        return 1;
+    }
+    return err;
+}
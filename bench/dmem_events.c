@@ -0,0 +1,144 @@
+/**
+ * @file dmem_events.c
+ * @author Southern Sandbox
+ * @brief 事件日志格式化工具：将 dmem_event_read() 读出的二进制事件格式化为文本
+ * @note 事件文件即按顺序拼接的 struct dmem_event（读出后直接 fwrite() 写入即可），
+ *       内存堆只在临界区内写入事件类型与数值参数，格式化在此完成，不占用被追踪程序的时间。
+ *       每个事件输出一行：时间戳、级别、事件类型及参数，最后输出各类型的事件数量。
+ *       用法：dmem_events EVENTS [--level N] [--summary]
+ *       --level 只输出不高于该级别的事件（1 ERROR ~ 4 DEBUG），--summary 只输出统计
+ * @date 2025-08-10
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "dmem.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+
+#if !ENABLE_DMEM_EVENT
+    #error "dmem_events requires ENABLE_DMEM_EVENT=1"
+#endif
+
+#define EVENTS_ID_MAX           DMEM_EVENT_COMPACT
+
+/**
+ * @brief 事件类型的名称及参数 a、b 的名称
+ */
+static const struct
+{
+    const char* name;
+    const char* a;
+    const char* b;
+} event_desc[EVENTS_ID_MAX + 1] =
+{
+    [DMEM_EVENT_ALLOC]              = { "alloc",        "block",    "size"  },
+    [DMEM_EVENT_ALLOC_FAIL]         = { "alloc-fail",   "request",  "free"  },
+    [DMEM_EVENT_FREE]               = { "free",         "block",    "size"  },
+    [DMEM_EVENT_FREE_ERROR]         = { "free-error",   "addr",     "error" },
+    [DMEM_EVENT_MERGE]              = { "merge",        "block",    "size"  },
+    [DMEM_EVENT_SPLIT]              = { "split",        "block",    "size"  },
+    [DMEM_EVENT_EXPAND]             = { "expand",       "block",    "size"  },
+    [DMEM_EVENT_EXPAND_BACKWARD]    = { "expand-back",  "block",    "size"  },
+    [DMEM_EVENT_SLAB_NEW]           = { "slab-new",     "page",     "class" },
+    [DMEM_EVENT_SLAB_RELEASE]       = { "slab-release", "page",     "class" },
+    [DMEM_EVENT_REGION_ADD]         = { "region-add",   "region",   "size"  },
+    [DMEM_EVENT_PURGE]              = { "purge",        "page",     "size"  },
+    [DMEM_EVENT_HUGE_MAP]           = { "huge-map",     "request",  "size"  },
+    [DMEM_EVENT_HUGE_UNMAP]         = { "huge-unmap",   "count",    "size"  },
+    [DMEM_EVENT_HUGE_REMAP]         = { "huge-remap",   "old",      "size"  },
+    [DMEM_EVENT_COMPACT]            = { "compact",      "block",    "size"  },
+};
+
+static const char* const level_name[] = { "OFF", "ERROR", "WARN", "INFO", "DEBUG" };
+
+/**
+ * @brief 格式化一条事件
+ * @param e 事件
+ */
+static void _print(const struct dmem_event* e)
+{
+    const char* lv = e->level <= DMEM_EVENT_LEVEL_DEBUG ? level_name[e->level] : "?";
+
+    if(e->id == 0 || e->id > EVENTS_ID_MAX)
+    {
+        printf("%10u %-5s unknown(%u) a=%u b=%u\n", e->tick, lv, e->id, e->a, e->b);
+        return;
+    }
+    // 偏移量以十六进制显示，大小、数量与错误码以十进制显示
+    if(e->id == DMEM_EVENT_ALLOC_FAIL || (e->id >= DMEM_EVENT_HUGE_MAP && e->id <= DMEM_EVENT_HUGE_REMAP))
+        printf("%10u %-5s %-12s %s=%u %s=%u\n", e->tick, lv, event_desc[e->id].name, event_desc[e->id].a, e->a, event_desc[e->id].b, e->b);
+    else if(e->id == DMEM_EVENT_FREE_ERROR)
+        printf("%10u %-5s %-12s %s=0x%08x %s=-%u\n", e->tick, lv, event_desc[e->id].name, event_desc[e->id].a, e->a, event_desc[e->id].b, e->b);
+    else
+        printf("%10u %-5s %-12s %s=0x%08x %s=%u\n", e->tick, lv, event_desc[e->id].name, event_desc[e->id].a, e->a, event_desc[e->id].b, e->b);
+}
+
+static void _usage(const char* prog)
+{
+    printf("usage: %s EVENTS [--level N] [--summary]\n", prog);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = NULL;
+    int level = DMEM_EVENT_LEVEL_DEBUG;
+    int summary = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+            level = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--summary") == 0)
+            summary = 1;
+        else if(path == NULL && argv[i][0] != '-')
+            path = argv[i];
+        else
+        {
+            _usage(argv[0]);
+            return 1;
+        }
+    }
+    if(path == NULL)
+    {
+        _usage(argv[0]);
+        return 1;
+    }
+
+    FILE* fp = fopen(path, "rb");
+    if(fp == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+
+    struct dmem_event buf[1024];
+    size_t counts[EVENTS_ID_MAX + 2] = {0};         // 最后一项统计未知的事件类型
+    size_t total = 0, got;
+    while((got = fread(buf, sizeof(buf[0]), sizeof(buf) / sizeof(buf[0]), fp)) > 0)
+    {
+        for(size_t i = 0; i < got; i++)
+        {
+            const struct dmem_event* e = &buf[i];
+            if(e->level > level)
+                continue;
+            counts[(e->id == 0 || e->id > EVENTS_ID_MAX) ? EVENTS_ID_MAX + 1 : e->id]++;
+            total++;
+            if(!summary)
+                _print(e);
+        }
+    }
+    fclose(fp);
+
+    printf("dmem_events: %lu events\n", (unsigned long) total);
+    for(int id = 1; id <= EVENTS_ID_MAX; id++)
+    {
+        if(counts[id])
+            printf("  %-12s %10lu\n", event_desc[id].name, (unsigned long) counts[id]);
+    }
+    if(counts[EVENTS_ID_MAX + 1])
+        printf("  %-12s %10lu\n", "unknown", (unsigned long) counts[EVENTS_ID_MAX + 1]);
+    return 0;
+}
@@ -0,0 +1,372 @@
+/**
+ * @file dmem_fragmap.c
+ * @author Southern Sandbox
+ * @brief 碎片分布图工具：将 dmem_walk() 报告的内存块布局绘制为字符条，或以 JSON 输出各段连续空闲内存的位置与大小
+ * @note 布局文件即按顺序拼接的 struct dmem_walk_info（回调函数直接 fwrite() 写入即可），可连续写入多次遍历，
+ *       每次遍历从首内存块开始，偏移量回落处即为下一次遍历的开始。工具需与被检查程序使用相同的 DMEM_OFFSET_WIDTH。
+ *       字符条中每个字符代表内存池中相同大小的一段：'#' 已分配，'S' 小对象页，'M' 可移动内存块，'.' 空闲，
+ *       '+' 已分配为主、夹杂空闲，'-' 空闲为主、夹杂已分配，' ' 内存区域之间的间隔。
+ *       用法：dmem_fragmap LAYOUT [--width N] [--rows N] [--json]
+ *       --width 每行的字符数（默认 64），--rows 行数（默认 16），--json 以 JSON 输出而不绘制字符条
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "dmem.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+
+#define FRAGMAP_DEFAULT_WIDTH   64
+#define FRAGMAP_DEFAULT_ROWS    16
+#define FRAGMAP_HIST_BINS       DMEM_STATS_HIST_BINS
+
+/**
+ * @brief 字符条中一个字符所代表的一段内存的统计
+ */
+struct fragmap_cell
+{
+    uint64_t bytes[DMEM_WALK_GAP + 1];          /** 各状态的内存块在该段中占用的字节数 **/
+};
+
+/**
+ * @brief 一次遍历的汇总
+ */
+struct fragmap_summary
+{
+    size_t blocks;              /** 内存块数量 **/
+    uint64_t start;             /** 第一个内存块的偏移量 **/
+    uint64_t end;               /** 最后一个内存块的结束位置 **/
+    uint64_t used;              /** 已分配的用户内存（含小对象页与可移动内存块） **/
+    uint64_t free;              /** 空闲的用户内存 **/
+    uint64_t largest;           /** 最大的一段连续空闲内存 **/
+    uint64_t slack;             /** 已分配内存块的内部浪费 **/
+    size_t runs;                /** 连续空闲内存的段数 **/
+    size_t hist[FRAGMAP_HIST_BINS];             /** 连续空闲内存按大小分档的段数，分档与 dmem_stats.free_hist 相同 **/
+};
+
+/**
+ * @brief 读取布局文件
+ * @param path 文件路径
+ * @param count 用于返回内存块数量
+ * @return struct dmem_walk_info* 内存块数组，失败时返回 NULL
+ */
+static struct dmem_walk_info* _load(const char* path, size_t* count)
+{
+    FILE* fp = fopen(path, "rb");
+    struct dmem_walk_info* infos = NULL;
+    size_t cap = 0, n = 0;
+
+    if(fp == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    for(;;)
+    {
+        if(n == cap)
+        {
+            struct dmem_walk_info* p;
+            cap = cap ? cap * 2 : 4096;
+            if((p = realloc(infos, cap * sizeof(*infos))) == NULL)
+            {
+                free(infos);
+                fclose(fp);
+                return NULL;
+            }
+            infos = p;
+        }
+        size_t got = fread(infos + n, sizeof(*infos), cap - n, fp);
+        n += got;
+        if(got == 0 || n < cap)
+            break;
+    }
+    fclose(fp);
+    *count = n;
+    return infos;
+}
+
+/**
+ * @brief 内存块信息头的大小：相邻内存块的偏移量之差减去前一个内存块的用户内存大小
+ * @param w 一次遍历的内存块
+ * @param n 内存块数量
+ * @return uint64_t 信息头大小，只有一个内存块时返回 0
+ */
+static uint64_t _header_size(const struct dmem_walk_info* w, size_t n)
+{
+    uint64_t hdr = UINT64_MAX;
+    for(size_t i = 0; i + 1 < n; i++)
+    {
+        uint64_t d = (uint64_t) w[i + 1].offset - w[i].offset - w[i].size;
+        if(d < hdr)
+            hdr = d;
+    }
+    return hdr == UINT64_MAX ? 0 : hdr;
+}
+
+/**
+ * @brief 内存块占用的结束位置（下一个内存块的偏移量）
+ */
+static uint64_t _block_end(const struct dmem_walk_info* w, size_t n, size_t i, uint64_t hdr)
+{
+    return i + 1 < n ? (uint64_t) w[i + 1].offset : (uint64_t) w[i].offset + hdr + w[i].size;
+}
+
+static int _hist_bin(uint64_t size)
+{
+    int bin = 0;
+    for(size >>= 4; size != 0 && bin < FRAGMAP_HIST_BINS - 1; size >>= 1)
+        bin++;
+    return bin;
+}
+
+/**
+ * @brief 汇总一次遍历，同时依次回调每一段连续空闲内存
+ * @param w 一次遍历的内存块
+ * @param n 内存块数量
+ * @param sum 汇总结果
+ * @param run 每段连续空闲内存的回调，可为 NULL
+ * @param arg 回调的参数
+ */
+static void _summarize(const struct dmem_walk_info* w, size_t n, struct fragmap_summary* sum,
+                       void (*run)(uint64_t offset, uint64_t size, void* arg), void* arg)
+{
+    uint64_t hdr = _header_size(w, n);
+
+    memset(sum, 0, sizeof(*sum));
+    sum->blocks = n;
+    if(n == 0)
+        return;
+    sum->start = w[0].offset;
+    sum->end = _block_end(w, n, n - 1, hdr);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        if(w[i].state == DMEM_WALK_GAP)
+            continue;
+        if(w[i].state != DMEM_WALK_FREE)
+        {
+            sum->used += w[i].size;
+            sum->slack += w[i].slack;
+            continue;
+        }
+
+        /** 相邻的空闲内存块在批量释放的间隙中可能尚未合并，合并为一段（含中间的信息头） **/
+        uint64_t offset = w[i].offset, size = w[i].size;
+        sum->free += w[i].size;
+        while(i + 1 < n && w[i + 1].state == DMEM_WALK_FREE)
+        {
+            i++;
+            sum->free += w[i].size;
+            size = (uint64_t) w[i].offset + w[i].size - offset - hdr;
+        }
+        sum->runs++;
+        sum->hist[_hist_bin(size)]++;
+        if(size > sum->largest)
+            sum->largest = size;
+        if(run != NULL)
+            run(offset, size, arg);
+    }
+}
+
+/**
+ * @brief 外部碎片率，千分比，与 dmem_frag_report.fragmentation 的口径相同
+ */
+static unsigned _fragmentation(const struct fragmap_summary* sum)
+{
+    return sum->free ? (unsigned) (1000 - sum->largest * 1000 / sum->free) : 0;
+}
+
+/**
+ * @brief 选择代表一段内存的字符
+ * @param c 该段的统计
+ * @return char
+ */
+static char _cell_char(const struct fragmap_cell* c)
+{
+    uint64_t free = c->bytes[DMEM_WALK_FREE];
+    uint64_t used = c->bytes[DMEM_WALK_USED] + c->bytes[DMEM_WALK_SLAB] + c->bytes[DMEM_WALK_MOVABLE];
+
+    if(c->bytes[DMEM_WALK_GAP] >= free + used)
+        return ' ';
+    if(used == 0)
+        return '.';
+    if(free == 0)
+    {
+        if(c->bytes[DMEM_WALK_SLAB] > c->bytes[DMEM_WALK_USED] && c->bytes[DMEM_WALK_SLAB] >= c->bytes[DMEM_WALK_MOVABLE])
+            return 'S';
+        if(c->bytes[DMEM_WALK_MOVABLE] > c->bytes[DMEM_WALK_USED])
+            return 'M';
+        return '#';
+    }
+    return free > used ? '-' : '+';
+}
+
+/**
+ * @brief 绘制一次遍历的字符条
+ * @param w 一次遍历的内存块
+ * @param n 内存块数量
+ * @param index 遍历的序号
+ * @param width 每行的字符数
+ * @param rows 行数
+ * @return int 0 成功，内存不足时返回 -1
+ */
+static int _draw(const struct dmem_walk_info* w, size_t n, size_t index, size_t width, size_t rows)
+{
+    struct fragmap_summary sum;
+    struct fragmap_cell* cells;
+    size_t count = width * rows;
+    uint64_t hdr = _header_size(w, n);
+    uint64_t span, per;
+
+    _summarize(w, n, &sum, NULL, NULL);
+    printf("walk %lu: %lu blocks, span 0x%llx-0x%llx, used %llu, free %llu bytes in %lu runs, largest %llu, fragmentation %u‰, waste %llu\n",
+           (unsigned long) index, (unsigned long) sum.blocks, (unsigned long long) sum.start, (unsigned long long) sum.end,
+           (unsigned long long) sum.used, (unsigned long long) sum.free, (unsigned long) sum.runs,
+           (unsigned long long) sum.largest, _fragmentation(&sum), (unsigned long long) sum.slack);
+    if(n == 0)
+        return 0;
+
+    /** 每个字符代表 per 字节，不足时减少字符数 **/
+    span = sum.end - sum.start;
+    per = (span + count - 1) / count;
+    if(per == 0)
+        per = 1;
+    count = (size_t) ((span + per - 1) / per);
+    if((cells = calloc(count, sizeof(*cells))) == NULL)
+        return -1;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        uint64_t a = (uint64_t) w[i].offset - sum.start;
+        uint64_t b = _block_end(w, n, i, hdr) - sum.start;
+        int state = w[i].state <= DMEM_WALK_GAP ? w[i].state : DMEM_WALK_USED;
+        while(a < b)
+        {
+            size_t c = (size_t) (a / per);
+            uint64_t cell_end = (uint64_t) (c + 1) * per;
+            uint64_t take = (b < cell_end ? b : cell_end) - a;
+            cells[c].bytes[state] += take;
+            a += take;
+        }
+    }
+
+    printf("%llu bytes per char\n", (unsigned long long) per);
+    for(size_t r = 0; r * width < count; r++)
+    {
+        printf("0x%08llx |", (unsigned long long) (sum.start + (uint64_t) r * width * per));
+        for(size_t c = r * width; c < count && c < (r + 1) * width; c++)
+            putchar(_cell_char(&cells[c]));
+        printf("|\n");
+    }
+    printf("free runs:");
+    for(int bin = 0; bin < FRAGMAP_HIST_BINS; bin++)
+        if(sum.hist[bin])
+            printf(" %s%llu:%lu", bin == 0 ? "<" : ">=", (unsigned long long) 1 << (bin == 0 ? 4 : bin + 3), (unsigned long) sum.hist[bin]);
+    printf("\n\n");
+    free(cells);
+    return 0;
+}
+
+static void _json_run(uint64_t offset, uint64_t size, void* arg)
+{
+    int* first = (int*) arg;
+    printf("%s\n      { \"offset\": %llu, \"size\": %llu }", *first ? "" : ",", (unsigned long long) offset, (unsigned long long) size);
+    *first = 0;
+}
+
+/**
+ * @brief 以 JSON 输出一次遍历的汇总与各段连续空闲内存
+ * @param w 一次遍历的内存块
+ * @param n 内存块数量
+ * @param last 是否为最后一次遍历
+ */
+static void _json(const struct dmem_walk_info* w, size_t n, int last)
+{
+    struct fragmap_summary sum;
+    int first = 1;
+
+    printf("  {\n    \"free_runs\": [");
+    _summarize(w, n, &sum, _json_run, &first);
+    printf("%s],\n", first ? "" : "\n    ");
+    printf("    \"blocks\": %lu, \"start\": %llu, \"end\": %llu, \"used\": %llu, \"free\": %llu,\n",
+           (unsigned long) sum.blocks, (unsigned long long) sum.start, (unsigned long long) sum.end,
+           (unsigned long long) sum.used, (unsigned long long) sum.free);
+    printf("    \"runs\": %lu, \"largest_free\": %llu, \"fragmentation\": %u, \"waste\": %llu,\n",
+           (unsigned long) sum.runs, (unsigned long long) sum.largest, _fragmentation(&sum), (unsigned long long) sum.slack);
+    printf("    \"run_hist\": [");
+    for(int bin = 0; bin < FRAGMAP_HIST_BINS; bin++)
+        printf("%s%lu", bin ? ", " : "", (unsigned long) sum.hist[bin]);
+    printf("]\n  }%s\n", last ? "" : ",");
+}
+
+static void _usage(const char* prog)
+{
+    printf("usage: %s LAYOUT [--width N] [--rows N] [--json]\n", prog);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = NULL;
+    size_t width = FRAGMAP_DEFAULT_WIDTH, rows = FRAGMAP_DEFAULT_ROWS;
+    int json = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--width") == 0 && i + 1 < argc)
+            width = strtoul(argv[++i], NULL, 0);
+        else if(strcmp(argv[i], "--rows") == 0 && i + 1 < argc)
+            rows = strtoul(argv[++i], NULL, 0);
+        else if(strcmp(argv[i], "--json") == 0)
+            json = 1;
+        else if(path == NULL && argv[i][0] != '-')
+            path = argv[i];
+        else
+        {
+            _usage(argv[0]);
+            return 1;
+        }
+    }
+    if(path == NULL || width == 0 || rows == 0)
+    {
+        _usage(argv[0]);
+        return 1;
+    }
+
+    size_t n = 0;
+    struct dmem_walk_info* infos = _load(path, &n);
+    if(infos == NULL)
+        return 1;
+
+    /** 按偏移量回落拆分为多次遍历 **/
+    size_t walks = 0, index = 0;
+    for(size_t i = 0; i < n; i++)
+        if(i == 0 || infos[i].offset <= infos[i - 1].offset)
+            walks++;
+
+    if(json)
+        printf("[\n");
+    for(size_t i = 0, start = 0; i < n; i++)
+    {
+        if(i + 1 < n && infos[i + 1].offset > infos[i].offset)
+            continue;
+        index++;
+        if(json)
+            _json(infos + start, i + 1 - start, index == walks);
+        else if(_draw(infos + start, i + 1 - start, index, width, rows) != 0)
+        {
+            printf("out of memory\n");
+            free(infos);
+            return 1;
+        }
+        start = i + 1;
+    }
+    if(json)
+        printf("]\n");
+    else if(walks == 0)
+        printf("%s: no blocks\n", path);
+    free(infos);
+    return 0;
+}
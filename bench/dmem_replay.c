@@ -0,0 +1,334 @@
+/**
+ * @file dmem_replay.c
+ * @author Southern Sandbox
+ * @brief 分配记录重放工具：在指定的内存池大小与配置下重放 dmem_record_start() 记录的分配与释放
+ * @note 记录文件即按顺序拼接的 struct dmem_record（回调函数直接 fwrite() 写入即可），
+ *       重放时每次操作单独计时，输出耗时分位数、分配失败次数、峰值占用以及碎片率，用于确定内存池大小与调整 dmem_conf.h。
+ *       记录中的句柄在内存释放后可能被复用，重放按记录顺序维护句柄与内存的对应关系；
+ *       开始记录之前分配的内存在重放中没有对应的内存，其释放与 realloc 分别按忽略与新分配处理。
+ *       用法：dmem_replay TRACE [--pool SIZE[K|M]] [--slab] [--policy P]
+ * @date 2025-08-09
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 199309L     // clock_gettime()
+#endif
+#include "dmem.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+#include "time.h"
+
+#define REPLAY_DEFAULT_POOL     (16u << 20)     // 默认内存池大小
+#define REPLAY_FRAG_PERIOD      1024            // 每隔多少次操作采样一次碎片率
+
+#if !ENABLE_DMEM_RECORD
+    #error "dmem_replay requires ENABLE_DMEM_RECORD=1"
+#endif
+
+/**
+ * @brief 重放结果
+ */
+struct replay_result
+{
+    size_t ops[DMEM_RECORD_ALIGNED + 1];        /** 各操作类型的次数 **/
+    uint64_t ns[DMEM_RECORD_ALIGNED + 1];       /** 各操作类型的总耗时 **/
+    size_t fails;               /** 记录中成功、重放时失败的分配次数 **/
+    size_t trace_fails;         /** 记录中本身失败的分配次数 **/
+    size_t unknown;             /** 开始记录之前分配的内存的释放次数 **/
+    size_t reused;              /** 句柄仍对应未释放内存时被再次分配的次数（多线程记录的先后顺序误差） **/
+    uint32_t frag_max;          /** 采样到的最大碎片率 **/
+    struct dmem_frag_report frag;               /** 记录结束时的碎片报告 **/
+    struct dmem_stats stats;                    /** 记录结束时的扩展统计 **/
+    struct dmem_use_report report;              /** 记录结束时的内存使用报告 **/
+};
+
+static struct dmem_heap replay_heap;
+
+static inline uint64_t _now_ns(void)
+{
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+static int _cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 读取记录文件
+ * @param path 文件路径
+ * @param count 用于返回记录数量
+ * @return struct dmem_record* 记录数组，失败时返回 NULL
+ */
+static struct dmem_record* _load(const char* path, size_t* count)
+{
+    FILE* fp = fopen(path, "rb");
+    struct dmem_record* recs = NULL;
+    size_t cap = 0, n = 0;
+
+    if(fp == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    for(;;)
+    {
+        if(n == cap)
+        {
+            struct dmem_record* p;
+            cap = cap ? cap * 2 : 4096;
+            if((p = realloc(recs, cap * sizeof(*recs))) == NULL)
+            {
+                free(recs);
+                fclose(fp);
+                return NULL;
+            }
+            recs = p;
+        }
+        size_t got = fread(recs + n, sizeof(*recs), cap - n, fp);
+        n += got;
+        if(got == 0 || n < cap)
+            break;
+    }
+    fclose(fp);
+    *count = n;
+    return recs;
+}
+
+/**
+ * @brief 按顺序重放记录
+ * @param recs 记录数组
+ * @param n 记录数量
+ * @param map 句柄到内存的映射表，长度为最大句柄 + 1
+ * @param samples 每次操作的耗时
+ * @param res 重放结果
+ * @return size_t 计时的操作次数
+ */
+static size_t _replay(const struct dmem_record* recs, size_t n, void** map, uint32_t* samples, struct replay_result* res)
+{
+    size_t done = 0;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        const struct dmem_record* r = &recs[i];
+        void* p = NULL;
+        uint32_t fail_count = replay_heap.fail_count;
+        uint64_t t0, t1;
+
+        if(r->op < DMEM_RECORD_ALLOC || r->op > DMEM_RECORD_ALIGNED)
+            continue;
+
+        switch(r->op)
+        {
+        case DMEM_RECORD_FREE:
+            if(map[r->id] == NULL)
+            {
+                res->unknown++;
+                continue;
+            }
+            t0 = _now_ns();
+            dmem_heap_free(&replay_heap, map[r->id]);
+            t1 = _now_ns();
+            map[r->id] = NULL;
+            break;
+
+        case DMEM_RECORD_REALLOC:
+        {
+            void* old = map[r->old];
+            if(old == NULL && r->old != DMEM_RECORD_NULL)
+                res->unknown++;
+            t0 = _now_ns();
+            p = old ? dmem_heap_realloc(&replay_heap, old, r->size) : dmem_heap_alloc(&replay_heap, r->size);
+            t1 = _now_ns();
+            map[r->old] = NULL;
+            break;
+        }
+
+        default:
+            t0 = _now_ns();
+            if(r->op == DMEM_RECORD_CALLOC)
+                p = dmem_heap_calloc(&replay_heap, 1, r->size);
+            else if(r->op == DMEM_RECORD_ALIGNED)
+                p = dmem_heap_aligned_alloc(&replay_heap, (size_t) 1 << r->align_log2, r->size);
+            else
+                p = dmem_heap_alloc(&replay_heap, r->size);
+            t1 = _now_ns();
+            break;
+        }
+
+        res->ops[r->op]++;
+        res->ns[r->op] += t1 - t0;
+        samples[done++] = (t1 - t0) > UINT32_MAX ? UINT32_MAX : (uint32_t) (t1 - t0);
+
+        if(r->op != DMEM_RECORD_FREE)
+        {
+            if(r->id == DMEM_RECORD_NULL)
+            {
+                // 记录中本身失败的分配：重放成功时立即释放，不影响之后的操作
+                res->trace_fails++;
+                if(p != NULL)
+                    dmem_heap_free(&replay_heap, p);
+            }
+            else
+            {
+                // 扩展失败时 dmem_heap_realloc() 返回原内存，以失败计数判断
+                if(p == NULL || replay_heap.fail_count != fail_count)
+                    res->fails++;
+                if(map[r->id] != NULL)
+                {
+                    res->reused++;
+                    dmem_heap_free(&replay_heap, map[r->id]);
+                }
+                map[r->id] = p;
+            }
+        }
+
+        if(done % REPLAY_FRAG_PERIOD == 0)
+        {
+            struct dmem_frag_report f;
+            dmem_heap_frag_report(&replay_heap, &f);
+            if(f.fragmentation > res->frag_max)
+                res->frag_max = f.fragmentation;
+        }
+    }
+    return done;
+}
+
+static size_t _parse_size(const char* s)
+{
+    char* end;
+    size_t v = strtoul(s, &end, 0);
+    if(*end == 'k' || *end == 'K')
+        v <<= 10;
+    else if(*end == 'm' || *end == 'M')
+        v <<= 20;
+    return v;
+}
+
+static void _usage(const char* prog)
+{
+    printf("usage: %s TRACE [--pool SIZE[K|M]] [--slab] [--policy P]\n", prog);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = NULL;
+    size_t pool_size = REPLAY_DEFAULT_POOL;
+    bool slab = false;
+    int policy = -1;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--pool") == 0 && i + 1 < argc)
+            pool_size = _parse_size(argv[++i]);
+        else if(strcmp(argv[i], "--slab") == 0)
+            slab = true;
+        else if(strcmp(argv[i], "--policy") == 0 && i + 1 < argc)
+            policy = atoi(argv[++i]);
+        else if(path == NULL && argv[i][0] != '-')
+            path = argv[i];
+        else
+        {
+            _usage(argv[0]);
+            return 1;
+        }
+    }
+    if(path == NULL)
+    {
+        _usage(argv[0]);
+        return 1;
+    }
+
+    size_t n = 0;
+    struct dmem_record* recs = _load(path, &n);
+    if(recs == NULL)
+        return 1;
+
+    uint32_t max_id = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        if(recs[i].id > max_id) max_id = recs[i].id;
+        if(recs[i].old > max_id) max_id = recs[i].old;
+    }
+
+    void** map = calloc((size_t) max_id + 1, sizeof(void*));
+    uint32_t* samples = malloc((n ? n : 1) * sizeof(uint32_t));
+    char* pool = malloc(pool_size + DMEM_DEFINE_ALIGN_SIZE);
+    if(map == NULL || samples == NULL || pool == NULL)
+    {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    char* aligned = (char*) (((uintptr_t) pool + DMEM_DEFINE_ALIGN_SIZE - 1) & ~(uintptr_t) (DMEM_DEFINE_ALIGN_SIZE - 1));
+    if(dmem_heap_init(&replay_heap, aligned, pool_size) != DMEM_ERR_NONE)
+    {
+        printf("invalid pool size: %lu\n", (unsigned long) pool_size);
+        return 1;
+    }
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+    if(policy >= 0 && dmem_heap_set_policy(&replay_heap, policy) != DMEM_ERR_NONE)
+    {
+        printf("invalid policy: %d\n", policy);
+        return 1;
+    }
+#else
+    (void) policy;
+#endif
+#if ENABLE_DMEM_SLAB
+    if(slab)
+        dmem_heap_slab_enable(&replay_heap, true);
+#endif
+
+    struct replay_result res;
+    memset(&res, 0, sizeof(res));
+    size_t done = _replay(recs, n, map, samples, &res);
+
+    dmem_heap_report(&replay_heap, &res.report);
+    dmem_heap_frag_report(&replay_heap, &res.frag);
+    dmem_heap_stats(&replay_heap, &res.stats);
+
+    printf("dmem_replay: %s, %lu records, engine %s, pool %lu bytes, slab %s, policy %d\n",
+           path, (unsigned long) n, DMEM_ALLOC_ENGINE == DMEM_ENGINE_TLSF ? "tlsf" : "first-fit",
+           (unsigned long) pool_size, slab ? "on" : "off", policy);
+
+    static const char* names[] = { "", "alloc", "free", "realloc", "calloc", "aligned" };
+    printf("%-8s %10s %10s\n", "op", "count", "mean(ns)");
+    for(int op = DMEM_RECORD_ALLOC; op <= DMEM_RECORD_ALIGNED; op++)
+        if(res.ops[op])
+            printf("%-8s %10lu %10.1f\n", names[op], (unsigned long) res.ops[op], (double) res.ns[op] / res.ops[op]);
+
+    if(done > 0)
+    {
+        qsort(samples, done, sizeof(samples[0]), _cmp_u32);
+        #define PCT(p)  samples[(size_t) ((done - 1) * (p))]
+        printf("latency(ns): p50 %u, p90 %u, p99 %u, p99.9 %u, max %u\n",
+               PCT(0.50), PCT(0.90), PCT(0.99), PCT(0.999), samples[done - 1]);
+        #undef PCT
+    }
+    printf("failures: %lu (trace already failed: %lu), unknown handles: %lu, reordered: %lu\n",
+           (unsigned long) res.fails, (unsigned long) res.trace_fails, (unsigned long) res.unknown, (unsigned long) res.reused);
+    printf("peak usage: %lu bytes (pool %lu bytes), live at end: %lu blocks / %lu bytes\n",
+           (unsigned long) res.report.max_usage, (unsigned long) pool_size,
+           (unsigned long) res.report.used_count, (unsigned long) (res.report.initf - res.report.free));
+    printf("fragmentation: end %u‰, max sampled %u‰, free blocks %lu, largest free %lu bytes, waste %lu bytes\n",
+           res.frag.fragmentation, res.frag_max, (unsigned long) res.frag.free_blocks,
+           (unsigned long) res.frag.largest_free, (unsigned long) res.stats.waste);
+
+    free(pool);
+    free(samples);
+    free(map);
+    free(recs);
+    return 0;
+}
@@ -11,12 +11,13 @@
 
 #include "dmem.h"
 #include "stdio.h"
+#include "errno.h"
 
 /**
  * @brief 辅助宏定义
  */
 #define MAKE_ALLOC_SIZE_ALIGN(size)        \
-        (size + (DMEM_DEFINE_ALIGN_SIZE - 1)) & ~(DMEM_DEFINE_ALIGN_SIZE - 1)       // 计算比 size 大且最接近 size 的 n 字节对齐值
+        (((size) + (DMEM_DEFINE_ALIGN_SIZE - 1)) & ~(DMEM_DEFINE_ALIGN_SIZE - 1))   // 计算比 size 大且最接近 size 的 n 字节对齐值
 #define MAKE_POOL_SIZE_ALIGN(size)         \
         ((size) < DMEM_DEFINE_ALIGN_SIZE ? 0 : \
         ((size) - (DMEM_DEFINE_ALIGN_SIZE - 1)) & ~(DMEM_DEFINE_ALIGN_SIZE - 1))    // 计算比 size 小且最接近 size 的 n 字节对齐值
@@ -25,27 +26,77 @@
 /**
  * @brief 线程锁函数声明
  */
-extern int dmem_get_lock(void);
-extern int dmem_rel_lock(void);
+extern int dmem_get_lock(dmem_heap_t heap);
+extern int dmem_rel_lock(dmem_heap_t heap);
+#if ENABLE_DMEM_RECORD || ENABLE_DMEM_EVENT || ENABLE_DMEM_PURGE
+extern uint32_t dmem_get_tick(void);
+#endif
+#if ENABLE_DMEM_GROW
+extern void* dmem_get_region(dmem_heap_t heap, size_t min_size, size_t* size);
+extern void dmem_put_region(dmem_heap_t heap, void* region, size_t size);
+#endif
+#if ENABLE_DMEM_PURGE
+extern void dmem_purge_pages(dmem_heap_t heap, void* addr, size_t size);
+#endif
+#if ENABLE_DMEM_TCACHE
+extern void dmem_thread_at_exit(void (*fn)(void));
+#endif
+#if ENABLE_DMEM_HUGE
+extern void* dmem_map_huge(dmem_heap_t heap, size_t size);
+extern void dmem_unmap_huge(dmem_heap_t heap, void* addr, size_t size);
+extern void* dmem_remap_huge(dmem_heap_t heap, void* addr, size_t old_size, size_t new_size);
+#endif
 
-struct dmem_block;
 typedef struct dmem_block* dmem_block_t;
 
 /**
- * @brief 内存块管理器
+ * @brief 默认内存堆，供 dmem_init()/dmem_alloc() 等兼容接口使用，
+ *        DMEM_ARENA_COUNT 大于 1 时改用默认多分区内存堆
  */
-struct dmem_mgr
-{
-    char* pool;                 /** 内存池 **/
-    uint32_t size;              /** 内存池大小 **/
-    uint32_t free;              /** 当前空闲的内存大小 **/
-    uint32_t max_usage;         /** 记录内存消耗的最大值 @note 记录所有的非空闲内存的占用，包括内存块消息结构体 **/
-    uint32_t inited_free;       /** 记录初始化时，空闲内存块的大小 **/
-    dmem_block_t bhead;         /** 首内存块且始终指向首内存块 **/
-    dmem_block_t btail;         /** 尾内存块且始终指向尾内存块 **/
-    dmem_block_t bfree;         /** 始终指向第一个空闲内存块 **/
-};
-static struct dmem_mgr mgr = {0};
+#if DMEM_USE_DEFAULT_ARENAS
+static struct dmem_arenas default_arenas = {0};
+#else
+static struct dmem_heap default_heap = {0};
+#endif
+
+/**
+ * @brief 线程局部存储，供线程缓存及按轮询分配分区使用
+ */
+#if ENABLE_DMEM_TCACHE || (ENABLE_DMEM_ARENA && DMEM_ARENA_POLICY == DMEM_ARENA_ROUND_ROBIN)
+    #if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+        #define DMEM_THREAD_LOCAL           _Thread_local
+    #elif defined(__GNUC__) || defined(__clang__)
+        #define DMEM_THREAD_LOCAL           __thread
+    #elif defined(_MSC_VER)
+        #define DMEM_THREAD_LOCAL           __declspec(thread)
+    #else
+        #error "ENABLE_DMEM_TCACHE and DMEM_ARENA_ROUND_ROBIN require thread-local storage support"
+    #endif
+#endif
+
+/**
+ * @brief 原子访问，供内存使用报告的无锁快照 (seqlock)、线程缓存读取页映射表及多分区共享的标签预算使用
+ * @note 不支持原子内建函数的编译器退化为 volatile 访问，适用于单核平台
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define dmem_atomic_load(ptr)               __atomic_load_n(ptr, __ATOMIC_RELAXED)
+    #define dmem_atomic_load_acquire(ptr)       __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+    #define dmem_atomic_store(ptr, val)         __atomic_store_n(ptr, val, __ATOMIC_RELAXED)
+    #define dmem_atomic_store_release(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+    #define dmem_fence_acquire()                __atomic_thread_fence(__ATOMIC_ACQUIRE)
+    #define dmem_fence_release()                __atomic_thread_fence(__ATOMIC_RELEASE)
+    #define dmem_atomic_fetch_add(ptr, val)     __atomic_fetch_add(ptr, val, __ATOMIC_RELAXED)
+    #define dmem_atomic_fetch_sub(ptr, val)     __atomic_fetch_sub(ptr, val, __ATOMIC_RELAXED)
+#else
+    #define dmem_atomic_load(ptr)               (*(ptr))
+    #define dmem_atomic_load_acquire(ptr)       (*(ptr))
+    #define dmem_atomic_store(ptr, val)         (*(ptr) = (val))
+    #define dmem_atomic_store_release(ptr, val) (*(ptr) = (val))
+    #define dmem_fence_acquire()
+    #define dmem_fence_release()
+    #define dmem_atomic_fetch_add(ptr, val)     ((*(ptr) += (val)) - (val))
+    #define dmem_atomic_fetch_sub(ptr, val)     ((*(ptr) -= (val)) + (val))
+#endif
 
 /**
  * @brief 内存块信息结构体
@@ -53,593 +104,5360 @@ static struct dmem_mgr mgr = {0};
 struct dmem_block
 {
     uint16_t magic;         /** 幻数 **/
-    uint16_t used;          /** 是否已使用 **/
-    uint16_t prev;          /** 前一个节点的偏移量 **/
-    uint16_t next;          /** 后一个后节点的偏移量 **/
+    uint16_t used;          /** 使用标志位 DMEM_BLOCK_xxx **/
+    dmem_off_t prev;        /** 前一个节点的偏移量 **/
+    dmem_off_t next;        /** 后一个后节点的偏移量 **/
 };
 
-#define dmem_pool_at(offset)            (mgr.pool + (offset))
-#define dmem_pool_size()                (mgr.size)
-#define dmem_block_magic()              (0xf00d)
-#define dmem_block_size()               (sizeof(struct dmem_block))
-#define dmem_head_block()               (mgr.bhead)
-#define dmem_tail_block()               (mgr.btail)
-#define dmem_free_block()               (mgr.bfree)
-#define dmem_block_offset(block)        (unsigned int)((char*)(block) - (char*)(dmem_head_block()))
-#define dmem_min_alloc_size()           (DMEM_MIN_ALLOC_SIZE)
-#define dmem_block_mem_size(block)      ((block)->next - dmem_block_offset(block) - dmem_block_size())
-#define dmem_block_mem_addr(block)      (((char*)(block)) + dmem_block_size())
-#define dmem_block_prev(block)          ((dmem_block_t) dmem_pool_at((block)->prev))
-#define dmem_block_next(block)          ((dmem_block_t) dmem_pool_at((block)->next))
-#define dmem_block_entry(mem)           ((dmem_block_t)(((char*)mem) - dmem_block_size()))
-#define dmem_block_is_valid(block)      ((block)->magic == dmem_block_magic())
-#define dmem_block_is_unused(block)     ((!(block)->used) && dmem_block_is_valid(block))
+/**
+ * @brief 内存块使用标志位
+ */
+#define DMEM_BLOCK_USED     0x0001      /** 内存块已使用 **/
+#define DMEM_BLOCK_SLAB     0x0002      /** 内存块为小对象分配器的页，不可直接释放 **/
+#define DMEM_BLOCK_PENDING  0x0004      /** 内存块在批量释放中等待合并，视为空闲但尚未加入空闲链表 **/
+#define DMEM_BLOCK_PURGED   0x0008      /** 空闲内存块内部的整页已归还系统，移出空闲链表时清除 **/
+#define DMEM_BLOCK_MOVABLE  0x0010      /** 内存块通过句柄分配，可被紧凑整理移动，只能通过句柄释放 **/
+#define DMEM_BLOCK_FLAGS    0x001F      /** 标志位掩码，其余高位记录已分配内存块的标签（ENABLE_DMEM_TAG）及内部浪费 **/
+#if ENABLE_DMEM_TAG
+#define DMEM_BLOCK_TAG_SHIFT            5
+#define DMEM_BLOCK_TAG_MASK             ((DMEM_TAG_COUNT - 1) << DMEM_BLOCK_TAG_SHIFT)
+#define DMEM_BLOCK_SLACK_SHIFT          (DMEM_BLOCK_TAG_SHIFT + DMEM_TAG_BITS)
+#define dmem_block_tag(block)           ((uint8_t)(((block)->used & DMEM_BLOCK_TAG_MASK) >> DMEM_BLOCK_TAG_SHIFT))
+#else
+#define DMEM_BLOCK_SLACK_SHIFT          5
+#define dmem_block_tag(block)           0
+#endif
+#define DMEM_BLOCK_META_MASK            ((1u << DMEM_BLOCK_SLACK_SHIFT) - 1)       /** 标志位与标签的掩码 **/
+#define DMEM_BLOCK_SLACK_MAX            (0xFFFF >> DMEM_BLOCK_SLACK_SHIFT)
+#define dmem_block_slack(block)         ((dmem_size_t)((block)->used >> DMEM_BLOCK_SLACK_SHIFT))
 
 /**
- * @brief 合并相邻的空闲内存块
- * @param prev 前一个空闲内存块 
- * @param next 后一个空闲内存块
+ * @brief 空闲链表节点，存放在空闲内存块的用户内存中，因此不占用额外的空间
  */
-static void _merge_free_blocks(dmem_block_t prev, dmem_block_t next)
+struct dmem_free_node
 {
-    /** 检查内存块是否被使用 **/
-    if(!dmem_block_is_unused(prev) || !dmem_block_is_unused(next))
-        return;
+    dmem_off_t prev_free;   /** 前一个空闲内存块的偏移量 **/
+    dmem_off_t next_free;   /** 后一个空闲内存块的偏移量 **/
+};
 
-    dmem_trace (DMEM_LEVEL_DEBUG, 
-                "Merging blocks | Prev: %p (%u bytes) | Next: %p (%u bytes)", 
-                prev, dmem_block_mem_size(prev),
-                next, dmem_block_mem_size(next));
+/**
+ * @brief 编译期检查：内存块信息结构体的大小必须满足内存对齐，否则紧随其后的用户内存将无法对齐
+ */
+#define DMEM_STATIC_ASSERT(name, cond)      typedef char dmem_static_assert_##name[(cond) ? 1 : -1]
+DMEM_STATIC_ASSERT(block_size_aligned, (sizeof(struct dmem_block) % DMEM_DEFINE_ALIGN_SIZE) == 0);
+DMEM_STATIC_ASSERT(offset_aligned, DMEM_DEFINE_ALIGN_SIZE >= sizeof(dmem_off_t));
 
-    dmem_block_t next_next = dmem_block_next(next);
-    prev->next = dmem_block_offset(next_next);
-    next_next->prev = dmem_block_offset(prev);
+#define dmem_pool_at(heap, offset)          ((heap)->pool + (offset))
+#define dmem_pool_size(heap)                ((heap)->size)
+#define dmem_block_magic()                  (0xf00d)
+#define dmem_block_size()                   (sizeof(struct dmem_block))
+#define dmem_head_block(heap)               ((heap)->bhead)
+#define dmem_tail_block(heap)               ((heap)->btail)
+#define dmem_free_block(heap)               ((heap)->bfree)
+#define dmem_block_offset(heap, block)      (dmem_off_t)((char*)(block) - (char*)(dmem_head_block(heap)))
+#define dmem_min_alloc_size()               (DMEM_MIN_ALLOC_SIZE > sizeof(struct dmem_free_node) ? DMEM_MIN_ALLOC_SIZE : \
+                                             MAKE_ALLOC_SIZE_ALIGN(sizeof(struct dmem_free_node)))   // 空闲内存块至少要能容纳空闲链表节点
+#define dmem_offset_max()                   ((dmem_off_t) ~(dmem_off_t) 0)
+#define dmem_off_null()                     dmem_offset_max()
+#define dmem_free_node(block)               ((struct dmem_free_node*) dmem_block_mem_addr(block))
+#define dmem_block_mem_size(heap, block)    ((dmem_size_t)((block)->next - dmem_block_offset(heap, block) - dmem_block_size()))
+#define dmem_block_mem_addr(block)          (((char*)(block)) + dmem_block_size())
+#define dmem_block_prev(heap, block)        ((dmem_block_t) dmem_pool_at(heap, (block)->prev))
+#define dmem_block_next(heap, block)        ((dmem_block_t) dmem_pool_at(heap, (block)->next))
+#define dmem_block_entry(mem)               ((dmem_block_t)(((char*)mem) - dmem_block_size()))
+#define dmem_block_is_valid(block)          ((block)->magic == dmem_block_magic())
+#define dmem_block_is_unused(block)         ((!((block)->used & DMEM_BLOCK_USED)) && dmem_block_is_valid(block))
+#if ENABLE_DMEM_GROW
+#define dmem_mem_in_pool(heap, mem)         _mem_in_regions(heap, mem)
 
-    mgr.free += dmem_block_size();
+/**
+ * @brief 检查内存地址是否位于内存堆的某个内存区域中
+ * @note 内存区域只增不减，region_count 以 release 语义发布，未持有线程锁时也可调用
+ * @param heap 内存堆
+ * @param mem 内存地址
+ * @return true 位于某个内存区域的首内存块信息头之后
+ */
+static bool _mem_in_regions(dmem_heap_t heap, const void* mem)
+{
+    uintptr_t offset = (uintptr_t)(const char*) mem - (uintptr_t) heap->pool;      // 低于内存池的地址回绕为极大值
+    uint32_t count = dmem_atomic_load_acquire(&heap->region_count);
+    uint32_t i;
 
-    dmem_trace (DMEM_LEVEL_DEBUG,
-                "Merged result | Block: %p | Size: %u bytes | Total free: %u bytes", 
-                prev, dmem_block_mem_size(prev), mgr.free);
+    for(i = 0; i < count; i++)
+    {
+        if(offset >= heap->region_start[i] + dmem_block_size() && offset < heap->region_end[i])
+            return true;
+    }
+    return false;
 }
+#else
+#define dmem_mem_in_pool(heap, mem)         ((char*)(mem) >= dmem_pool_at(heap, dmem_block_size()) && \
+                                             (char*)(mem) < dmem_pool_at(heap, dmem_pool_size(heap)))
+#endif
 
+#if ENABLE_DMEM_EVENT
 /**
- * @brief 更新最大内存消耗
+ * ----------------------------------------------------------------------------
+ * 事件日志
+ * 事件在持有内存堆线程锁时写入，只保存事件类型与数值参数，格式化留给读出事件的一方。
+ * event_head 与 event_tail 为累计计数，缓冲区容量为 2 的幂，写入位置由 event_head & event_mask 得到，
+ * 未读出的事件超过容量时最早的事件被覆盖。
+ * ----------------------------------------------------------------------------
+ */
+#define dmem_event_offset(heap, ptr)        ((uint32_t)((const char*)(ptr) - (heap)->pool))
+#define _event(heap, lv, id, a, b)          do { if((lv) <= (heap)->event_level) \
+                                                _event_write(heap, lv, id, (uint32_t)(a), (uint32_t)(b)); } while(0)
+
+/**
+ * @brief 写入一条事件
+ * @note 调用者需持有内存堆的线程锁，并已确认事件级别不高于内存堆的当前级别
+ * @param heap 内存堆
+ * @param level 事件级别
+ * @param id 事件类型
+ * @param a 参数
+ * @param b 参数
  */
-static void _update_max_usage(void)
+static void _event_write(dmem_heap_t heap, uint8_t level, uint8_t id, uint32_t a, uint32_t b)
 {
-    int usage = dmem_pool_size() - mgr.free;
-    if(usage > mgr.max_usage)
-        mgr.max_usage = usage;
+    struct dmem_event* e = &heap->event_buf[heap->event_head & heap->event_mask];
+
+    heap->event_head++;
+    e->id = id;
+    e->level = level;
+    e->reserved = 0;
+    e->tick = dmem_get_tick();
+    e->a = a;
+    e->b = b;
 }
+#else
+    #define _event(...)             ((void)0)
+#endif
 
 /**
- * @brief 查找第一个空闲内存块
- * @note 该函数仅在 _alloc() 中调用
- * @param start 当前的内存块信息结构体
- * @return dmem_block_t 
+ * @brief 惰性清零：提高从未写入部分的起始位置
+ * @note 内存块信息头、空闲链表节点以及交给用户的内存都位于 heap->dirty 之前，
+ *       因此只需在创建内存块信息头、分配或扩展内存块时调用
+ * @param heap 内存堆
+ * @param end 可能被写入的部分的结束地址
  */
-static dmem_block_t _search_free_block_for_alloc(dmem_block_t start)
+static void _mark_dirty(dmem_heap_t heap, const void* end)
 {
-    if(dmem_block_is_unused(dmem_free_block()))
-        return dmem_free_block();
-    else
-    {
-        dmem_block_t pos = dmem_block_next(start);
-        if(dmem_block_is_unused(pos))
-            return pos;
-        else 
-        {
-            for( ; pos != dmem_tail_block(); pos = dmem_block_next(pos))
-                if(dmem_block_is_unused(pos))
-                    return pos;
-            return NULL;
-        }
-    }
+    dmem_size_t offset = (dmem_size_t)((const char*) end - heap->pool);
+    if(offset > heap->dirty)
+        heap->dirty = offset;
 }
 
 /**
- * @brief 依据指定的大小分配连续的内存空间
- * @note 该函数不具备线程安全
- * @param size 待分配的内存的大小
- * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ * @brief 惰性清零：calloc 分配前记录的内存堆状态
  */
-static void* _alloc(unsigned int size)
+struct dmem_zero_mark
 {
-    dmem_block_t pos = NULL;
-    int free_size = 0;
+    dmem_size_t dirty;          /** 分配前从未写入部分的起始位置 **/
+#if ENABLE_DMEM_GROW
+    uint32_t regions;           /** 分配前的内存区域数量 **/
+#endif
+};
 
-    if(size == 0)
-        return NULL;
-    if(!IS_DMEM_VAR_ALIGNED(size, DMEM_DEFINE_ALIGN_SIZE))   // 如果分配的内存大小不符合对齐要求, 则数值向上分配内存对齐的待大小（如127->128）
-        size = MAKE_ALLOC_SIZE_ALIGN(size);
-    if(size < dmem_min_alloc_size())
-        size = dmem_min_alloc_size();
-    if((pos = dmem_free_block()) == NULL)
-        goto _ALLOC_FAILED_;
+/**
+ * @brief 惰性清零：在分配前记录内存堆的状态
+ * @note 调用者需持有内存堆的线程锁
+ * @param heap 内存堆
+ * @param mark 用于返回记录的状态
+ */
+static void _zero_mark(dmem_heap_t heap, struct dmem_zero_mark* mark)
+{
+    mark->dirty = heap->dirty;
+#if ENABLE_DMEM_GROW
+    mark->regions = heap->region_count;
+#endif
+}
 
-    /** 遍历，搜寻可用的内存块 **/
-    for( ; pos != dmem_tail_block(); pos = dmem_block_next(pos))
-    {
-        if(!dmem_block_is_unused(pos))
-            continue;
-        if(dmem_block_mem_size(pos) < size)
-            continue;
-        
-        /**
-         * 匹配成功，剩余空间是否还可以创建新的空闲内存块，
-         * 如果无法创建新的内存块，则将剩余的空闲内存全部分配，
-         * 避免出现无法被管理的内存碎片
-         */
-        free_size = dmem_block_mem_size(pos) - size;
-        if(free_size < (dmem_min_alloc_size() + dmem_block_size()))
-        {
+/**
+ * @brief 惰性清零：计算分配的内存中需要清零的长度，分配前从未写入的部分在分配后仍为 0
+ * @note 调用者需持有内存堆的线程锁
+ * @param heap 内存堆
+ * @param mark 分配前记录的状态
+ * @param p 分配的内存，可为 NULL
+ * @param total 内存大小
+ * @return size_t 从 p 开始需要清零的长度
+ */
+static size_t _zero_size(dmem_heap_t heap, const struct dmem_zero_mark* mark, void* p, size_t total)
+{
+    dmem_size_t dirty = mark->dirty;
+    size_t offset;
 
-        }
-        else 
-        {
-            /** 创建新的空闲内存块 **/
-            dmem_block_t next = (dmem_block_t)(((char*)pos) + dmem_block_size() + size);
-            dmem_block_t next_next = dmem_block_next(pos);
-            next->magic = dmem_block_magic();
-            next->used = false;
-            next->prev = dmem_block_offset(pos);
-            next->next = dmem_block_offset(next_next);
-            pos->next = dmem_block_offset(next);
-            next_next->prev = dmem_block_offset(next);
+    if(p == NULL)
+        return 0;
+#if ENABLE_DMEM_HUGE
+    if(!dmem_mem_in_pool(heap, p))
+        return 0;           // 新映射的内存由系统清零
+#endif
+#if ENABLE_DMEM_GROW
+    /** 分配时添加了内存区域，其内容未知，此时 heap->dirty 已提高到新内存区域的末尾 **/
+    if(heap->region_count != mark->regions)
+        dirty = heap->dirty;
+#endif
+    offset = (size_t)((char*) p - heap->pool);
+    if(offset + total <= dirty)
+        return total;
+    return offset < dirty ? dirty - offset : 0;
+}
 
-            mgr.free -= dmem_block_size();
-        }
-        pos->used = true;
+#if ENABLE_DMEM_PURGE
+/**
+ * ----------------------------------------------------------------------------
+ * 空闲页归还
+ * 空闲内存块中空闲链表节点与释放时间之后、下一内存块信息头之前的整页可以归还系统，内存堆不会再读写这部分内容。
+ * 归还后为空闲内存块加上 DMEM_BLOCK_PURGED 标记并计入 heap->purged，内存块移出空闲链表（分配、合并、调整大小）时
+ * 清除标记，之后重新归还时系统接口只处理仍驻留的页，已归还的页不会被重新访问。
+ * ----------------------------------------------------------------------------
+ */
+DMEM_STATIC_ASSERT(purge_page_size, (DMEM_PURGE_PAGE_SIZE & (DMEM_PURGE_PAGE_SIZE - 1)) == 0);
 
-        /** 更新 bfree **/
-        dmem_free_block() = _search_free_block_for_alloc(pos);
+#define dmem_purge_stamp(block)             (*(uint32_t*)(dmem_block_mem_addr(block) + sizeof(struct dmem_free_node)))
+#define dmem_purge_delayed(heap)            ((heap)->purge_decay != 0 && (heap)->purge_decay != DMEM_PURGE_OFF)
 
-        /** 更新管理器记录 **/
-        mgr.free -= dmem_block_mem_size(pos);
-        _update_max_usage();
+/**
+ * @brief 计算空闲内存块中可归还的整页
+ * @param heap 内存堆
+ * @param block 空闲内存块
+ * @param start 返回第一页的地址，可为 NULL
+ * @return dmem_size_t 可归还的大小，为 0 表示不足一页
+ */
+static dmem_size_t _purge_range(dmem_heap_t heap, dmem_block_t block, char** start)
+{
+    uintptr_t lo = (uintptr_t) dmem_block_mem_addr(block) + sizeof(struct dmem_free_node) + sizeof(uint32_t);
+    uintptr_t hi = (uintptr_t) dmem_block_next(heap, block) & ~(uintptr_t)(DMEM_PURGE_PAGE_SIZE - 1);
 
-        dmem_trace( DMEM_LEVEL_DEBUG, 
-                    "Allocated %u bytes at %p | Block: %p | Remaining free: %u bytes", 
-                    dmem_block_mem_size(pos), dmem_block_mem_addr(pos), 
-                    pos, mgr.free);
+    lo = (lo + DMEM_PURGE_PAGE_SIZE - 1) & ~(uintptr_t)(DMEM_PURGE_PAGE_SIZE - 1);
+    if(start != NULL)
+        *start = (char*) lo;
+    return hi > lo ? (dmem_size_t)(hi - lo) : 0;
+}
 
-        return dmem_block_mem_addr(pos);
-    }
+/**
+ * @brief 归还空闲内存块中的整页
+ * @param heap 内存堆
+ * @param block 空闲链表中的内存块
+ * @return dmem_size_t 本次归还的大小，已归还或不足一页时为 0
+ */
+static dmem_size_t _purge_block(dmem_heap_t heap, dmem_block_t block)
+{
+    char* start;
+    dmem_size_t size;
 
-_ALLOC_FAILED_:;
-    dmem_trace(DMEM_LEVEL_WARNING, "Allocation failed | Requested: %u bytes | Free: %u bytes", size, mgr.free);
-    return NULL;
+    if((block->used & DMEM_BLOCK_PURGED) || (size = _purge_range(heap, block, &start)) == 0)
+        return 0;
+    dmem_purge_pages(heap, start, size);
+    block->used |= DMEM_BLOCK_PURGED;
+    heap->purged += size;
+    _event(heap, DMEM_EVENT_LEVEL_INFO, DMEM_EVENT_PURGE, dmem_event_offset(heap, start), size);
+    dmem_trace(DMEM_LEVEL_DEBUG, "Purged %lu bytes at %p | Block: %p", (unsigned long)size, start, block);
+    return size;
 }
 
 /**
- * @brief 释放被分配的内存
- * @note 该函数不具备线程安全
- * @param mem 待释放的内存地址
- * @return int  - DMEM_ERR_NONE           : 释放成功
- *              - DMEM_FREE_NULL          : mem 为 NULL
- *              - DMEM_FREE_INVALID_MEM   : 内存块信息无效
- *              - DMEM_FREE_REPEATED      : 该内存块不可重复释放
+ * @brief 遍历内存块链表，归还到期（或全部）的空闲内存块，并重新计算最早到期的时间
+ * @param heap 内存堆
+ * @param force 是否忽略释放时间全部归还
+ * @return dmem_size_t 本次归还的大小
  */
-static int _free(void* mem)
+static dmem_size_t _purge_scan(dmem_heap_t heap, bool force)
 {
-    dmem_block_t block = NULL;
-
-    /** 检查 mem 的合法性 **/
-    if(!mem)
-    {
-        dmem_trace(DMEM_LEVEL_ERROR, "Address is NULL");
-        return DMEM_FREE_NULL;
-    }
-        
-    /** 检查内存块合法性 **/
-    block = dmem_block_entry(mem);
-    if(!dmem_block_is_valid(block))
-    {
-        dmem_trace(DMEM_LEVEL_ERROR, "Block is invalid");
-        return DMEM_FREE_INVALID_MEM;
-    }
+    uint32_t now = force ? 0 : dmem_get_tick();
+    uint32_t next = 0;
+    bool pending = false;
+    dmem_size_t total = 0;
+    dmem_block_t pos;
 
-    /** 检查内存释放被占用 **/
-    if(!block->used)
+    for(pos = dmem_head_block(heap); pos != dmem_tail_block(heap); pos = dmem_block_next(heap, pos))
     {
-        dmem_trace(DMEM_LEVEL_ERROR, "Double free detected | Addr: %p | Block: %p", mem, block);
-        return DMEM_FREE_REPEATED;
-    }
-
-    /** 重置标志位 **/
-    block->used = false;
-
-    /** 更新管理器记录 **/
-    mgr.free += (dmem_block_mem_size(block));
-    dmem_trace(DMEM_LEVEL_DEBUG, "Freed %u bytes at %p | Block: %p | New free: %u bytes", dmem_block_mem_size(block), mem, block, mgr.free);
+        uint32_t due;
 
-    // 检查上一个节点，如果空闲，则进行合并
-    if(dmem_head_block() != block)      // 忽略当前内存块是首节点的情况
-    {
-        dmem_block_t prev = dmem_block_prev(block);
-        if (dmem_block_is_unused(prev)) 
+        if(!dmem_block_is_unused(pos) || (pos->used & DMEM_BLOCK_PURGED) || _purge_range(heap, pos, NULL) == 0)
+            continue;
+        due = dmem_purge_stamp(pos) + heap->purge_decay;
+        if(force || (int32_t)(now - due) >= 0)
+            total += _purge_block(heap, pos);
+        else if(!pending || (int32_t)(due - next) < 0)
         {
-            _merge_free_blocks(prev, block);
-            block = prev;       // 合并后，block 指向合并后的内存块
-        }   
+            next = due;
+            pending = true;
+        }
     }
+    heap->purge_pending = pending;
+    heap->purge_next = next;
+    return total;
+}
 
-    // 检查下一个节点，如果空闲，则进行合并
+/**
+ * @brief 空闲内存块加入空闲链表时记录释放时间
+ * @note 只在延迟归还时记录，释放时间存放在空闲链表节点之后，不足一页的内存块不记录
+ * @param heap 内存堆
+ * @param block 空闲内存块
+ */
+static void _purge_note(dmem_heap_t heap, dmem_block_t block)
+{
+    uint32_t now;
+
+    if(!dmem_purge_delayed(heap) || _purge_range(heap, block, NULL) == 0)
+        return;
+    now = dmem_get_tick();
+    dmem_purge_stamp(block) = now;
+    if(!heap->purge_pending)
     {
-        dmem_block_t next = dmem_block_next(block);
-        if (dmem_block_is_unused(next))
-            _merge_free_blocks(block, next);
+        heap->purge_pending = true;
+        heap->purge_next = now + heap->purge_decay;
     }
+}
 
-    /** 重置 bfree **/
-    if (dmem_free_block() == NULL || 
-        dmem_block_offset(block) < dmem_block_offset(dmem_free_block()))
+/**
+ * @brief 空闲内存块移出空闲链表时清除归还标记
+ * @param heap 内存堆
+ * @param block 空闲内存块
+ */
+static void _purge_forget(dmem_heap_t heap, dmem_block_t block)
+{
+    if(block->used & DMEM_BLOCK_PURGED)
     {
-
-        dmem_free_block() = block;
+        heap->purged -= _purge_range(heap, block, NULL);
+        block->used &= (uint16_t) ~DMEM_BLOCK_PURGED;
     }
+}
 
+/**
+ * @brief 释放内存后调用：立即归还模式下归还合并后的空闲内存块
+ * @param heap 内存堆
+ * @param block 合并后的空闲内存块
+ */
+static void _purge_freed(dmem_heap_t heap, dmem_block_t block)
+{
+    if(heap->purge_decay == 0)
+        _purge_block(heap, block);
+}
+#else
+    #define _purge_note(heap, block)    ((void)0)
+    #define _purge_forget(heap, block)  ((void)0)
+    #define _purge_freed(heap, block)   ((void)0)
+#endif
 
+/**
+ * @brief 在内存块 pos 的用户内存中第 size 字节处创建新的空闲内存块，并将其链接到 pos 之后
+ * @param heap 内存堆
+ * @param pos 被拆分的内存块
+ * @param size pos 拆分后的用户内存大小
+ * @return dmem_block_t 新的空闲内存块
+ */
+static dmem_block_t _insert_block_after(dmem_heap_t heap, dmem_block_t pos, dmem_size_t size)
+{
+    dmem_block_t next = dmem_block_next(heap, pos);
+    dmem_block_t new_block = (dmem_block_t)(dmem_block_mem_addr(pos) + size);
 
-    /** 更新管理器记录 **/
-    _update_max_usage();
+    new_block->magic = dmem_block_magic();
+    new_block->used = 0;
+    new_block->prev = dmem_block_offset(heap, pos);
+    new_block->next = dmem_block_offset(heap, next);
+    pos->next = dmem_block_offset(heap, new_block);
+    next->prev = dmem_block_offset(heap, new_block);
+    _mark_dirty(heap, dmem_block_mem_addr(new_block) + sizeof(struct dmem_free_node));     // 新的内存块随后可能写入空闲链表节点
 
-    return DMEM_ERR_NONE;
+    return new_block;
 }
 
 /**
- * @brief 将已分配的内存块拆分为更小的已用内存卡和空闲内存块(并对相连的内存块进行合并操作),
- *        若无法拆分，则不进行拆分.
- * @param block 
- * @param size 
- * @return int 
+ * @brief 合并相邻的空闲内存块
+ * @note 调用者需确保两个内存块均为空闲内存块，且均已从空闲链表中移除
+ * @param heap 内存堆
+ * @param prev 前一个空闲内存块 
+ * @param next 后一个空闲内存块
  */
-static void _split(dmem_block_t block, unsigned int new_size)
+static void _merge_free_blocks(dmem_heap_t heap, dmem_block_t prev, dmem_block_t next)
 {
-    /** 如果当前的内存块的实际可用内存大小大于新指定的内存大小，若可进行内存块的拆分, 则需要进行内存块的拆分 **/
-    if(dmem_block_mem_size(block) - new_size > (dmem_min_alloc_size() + dmem_block_size()))
-    {   
-        /** 获取当前内存块后一个内存块 **/
-        dmem_block_t next = dmem_block_next(block);
-        uint32_t old_used_mem_size = dmem_block_mem_size(block);
-
-        /** 将剩余部分变为空闲内存块 **/
-        dmem_block_t new_free = (dmem_block_t)(((char*)block) + dmem_block_size() + new_size);
-        new_free->magic = dmem_block_magic();
-        new_free->used = false;
-        new_free->prev = dmem_block_offset(block);
-        new_free->next = dmem_block_offset(next);
+    dmem_trace (DMEM_LEVEL_DEBUG, 
+                "Merging blocks | Prev: %p (%lu bytes) | Next: %p (%lu bytes)", 
+                prev, (unsigned long)(dmem_block_mem_size(heap, prev)),
+                next, (unsigned long)(dmem_block_mem_size(heap, next)));
 
-        /** 调整节点指向 **/
-        block->next = dmem_block_offset(new_free);
-        next->prev = dmem_block_offset(new_free);
+    dmem_block_t next_next = dmem_block_next(heap, next);
+    prev->next = dmem_block_offset(heap, next_next);
+    next_next->prev = dmem_block_offset(heap, prev);
 
-        /** 重新计算内存块大小 **/
-        mgr.free += (old_used_mem_size - (new_size + dmem_block_size()));
+    heap->free += dmem_block_size();
+    _event(heap, DMEM_EVENT_LEVEL_DEBUG, DMEM_EVENT_MERGE, dmem_block_offset(heap, prev), dmem_block_mem_size(heap, prev));
 
-        /** 如果后方内存块是空闲的, 则将新的空闲内存块与其进行合并 **/
-        _merge_free_blocks(new_free, next);
+    dmem_trace (DMEM_LEVEL_DEBUG,
+                "Merged result | Block: %p | Size: %lu bytes | Total free: %lu bytes", 
+                prev, (unsigned long)(dmem_block_mem_size(heap, prev)), (unsigned long)heap->free);
+}
 
-        /** 更新管理器记录 **/
-        _update_max_usage();
+/**
+ * @brief 更新最大内存消耗
+ * @param heap 内存堆
+ */
+static void _update_max_usage(dmem_heap_t heap)
+{
+    dmem_size_t usage = dmem_pool_size(heap) - heap->free;
+    if(usage > heap->max_usage)
+        heap->max_usage = usage;
+}
 
-        dmem_trace( DMEM_LEVEL_DEBUG, 
-                    "Split block: %p | Old: %u -> New: %u + Free: %u", 
-                    block, old_used_mem_size, new_size, 
-                    dmem_block_mem_size(new_free));
-    }
-    else
-        dmem_trace( DMEM_LEVEL_DEBUG, "Block can not be splitted");
+/**
+ * @brief 计算空闲内存块大小所属的直方图分档
+ * @param size 空闲内存块的用户内存大小
+ * @return int 分档序号，第 i 档为 [2^(i+3), 2^(i+4)) 字节，首尾两档包含更小/更大的内存块
+ */
+static int _free_hist_bin(dmem_size_t size)
+{
+    int bin = 0;
+    for(size >>= 4; size != 0 && bin < DMEM_STATS_HIST_BINS - 1; size >>= 1)
+        bin++;
+    return bin;
 }
 
 /**
- * @brief 适用于 dmem_realloc() 函数，在当前内存块的后方尝试就地扩展内存
- * @param block 
- * @param new_size 
- * @return true 
- * @return false 
+ * @brief 空闲内存块加入空闲链表时更新统计
+ * @note 最大空闲内存块 largest_free 为上界：加入更大的内存块时更新为精确值，移除最大的内存块时仅标记为不精确
+ * @param heap 内存堆
+ * @param block 空闲内存块
  */
-static bool _expand_inplace(dmem_block_t block, uint32_t new_size) 
+static void _free_stats_add(dmem_heap_t heap, dmem_block_t block)
 {
-    uint32_t needed = new_size - dmem_block_mem_size(block);        // 需要扩展的内存大小(不包含原已分配内存块的大小)
-    dmem_block_t next = dmem_block_next(block);                     
-    
-    /** 检查后一个内存块是否为空闲块 **/
-    if (dmem_block_is_unused(next)) 
+    dmem_size_t size = dmem_block_mem_size(heap, block);
+    _purge_note(heap, block);
+    heap->free_blocks++;
+    heap->free_hist[_free_hist_bin(size)]++;
+    if(size > heap->largest_free)
     {
-        uint32_t total_avail = dmem_block_mem_size(next) + dmem_block_size();
-        dmem_trace( DMEM_LEVEL_DEBUG, "total_avail: %u bytes, needed: %u bytes", total_avail, needed);
-        
-        /** 如果新加入的空闲内存块大小足够，则就地扩展 **/
-        if (total_avail >= needed) 
-        {
-            dmem_trace( DMEM_LEVEL_DEBUG, 
-                        "In-place expand: %u -> %u bytes", 
-                        dmem_block_mem_size(block), new_size);
-            
-            /** 移除空闲块 **/
-            dmem_block_t next_next = dmem_block_next(next);
-            block->next = dmem_block_offset(next_next);
-            next_next->prev = dmem_block_offset(block);
-            
-            /** 更新空闲统计 **/
-            uint32_t remined = total_avail - needed;
-            mgr.free += dmem_block_size();
-            mgr.free -= needed;
-            dmem_trace( DMEM_LEVEL_DEBUG, "Free: %u bytes, Remined: %u bytes", mgr.free, remined);
-            
-            /** 若有剩余空间，创建新空闲块 **/
-            if (remined >= dmem_min_alloc_size() + dmem_block_size()) 
-            {
-                dmem_block_t new_free = (dmem_block_t)((char*)block + dmem_block_size() + new_size);
-                new_free->magic = dmem_block_magic();
-                new_free->used = false;
-                new_free->prev = dmem_block_offset(block);
-                new_free->next = dmem_block_offset(next_next);
-
-                block->next = dmem_block_offset(new_free);
-                next_next->prev = dmem_block_offset(new_free);
-
-                mgr.free -= dmem_block_size();
-            }
-
-            dmem_trace( DMEM_LEVEL_DEBUG,
-                        "After in-place expand, Free: %u ytes",
-                        mgr.free);
-
-            _update_max_usage();
-
-            return true;
-        }
+        heap->largest_free = size;
+        heap->largest_exact = true;
     }
-    return false;
 }
 
+/**
+ * @brief 空闲内存块移出空闲链表时更新统计
+ * @param heap 内存堆
+ * @param block 空闲内存块
+ */
+static void _free_stats_sub(dmem_heap_t heap, dmem_block_t block)
+{
+    dmem_size_t size = dmem_block_mem_size(heap, block);
+    _purge_forget(heap, block);
+    heap->free_blocks--;
+    heap->free_hist[_free_hist_bin(size)]--;
+    if(size == heap->largest_free)
+        heap->largest_exact = false;
+}
 
+/**
+ * @brief 记录已分配内存块的内部浪费（对齐向上取整及未拆分的剩余部分）
+ * @param heap 内存堆
+ * @param block 已分配的内存块
+ * @param request 用户请求的内存大小
+ */
+static void _block_set_slack(dmem_heap_t heap, dmem_block_t block, size_t request)
+{
+    dmem_size_t mem_size = dmem_block_mem_size(heap, block);
+    dmem_size_t slack = mem_size > request ? mem_size - (dmem_size_t) request : 0;
 
+    if(slack > DMEM_BLOCK_SLACK_MAX)
+        slack = DMEM_BLOCK_SLACK_MAX;
+    heap->waste -= dmem_block_slack(block);
+    heap->waste += slack;
+    block->used = (uint16_t)((block->used & DMEM_BLOCK_META_MASK) | (slack << DMEM_BLOCK_SLACK_SHIFT));
+}
 
+#if ENABLE_DMEM_TAG
+DMEM_STATIC_ASSERT(tag_bits, DMEM_TAG_BITS >= 1 && DMEM_TAG_BITS <= 4);
 
+/**
+ * @brief 为已分配的内存块记录标签，并计入标签的存活统计
+ * @param heap 内存堆
+ * @param block 已分配的内存块
+ * @param tag 标签，不为 0
+ */
+static void _tag_attach(dmem_heap_t heap, dmem_block_t block, uint8_t tag)
+{
+    struct dmem_tag_stats* ts = &heap->tags[tag];
 
-
-
+    block->used = (uint16_t)((block->used & ~DMEM_BLOCK_TAG_MASK) | (tag << DMEM_BLOCK_TAG_SHIFT));
+    ts->live_bytes += dmem_block_mem_size(heap, block);
+    ts->live_count++;
+    if(ts->live_bytes > ts->peak_bytes)
+        ts->peak_bytes = ts->live_bytes;
+    if(heap->tag_budget != NULL)
+        dmem_atomic_fetch_add(&heap->tag_budget->live_bytes[tag], dmem_block_mem_size(heap, block));
+}
 
 /**
- * @brief 初始化动态内存分配管理
- * @param pool 内存池地址
- * @param size 内存池可使用的大小
- * @return int  - DMEM_ERR_NONE           : 分配成功
- *              - DMEM_INIT_POOL_NULL     : 指定的内存池地址为 NULL
- *              - DMEM_INIT_SIZE_SMALL    : 内存池大小过小
- *              - DMEM_INIT_POOL_ALIGN    : 内存池地址未对齐
+ * @brief 清除内存块的标签，并从标签的存活统计中移出
+ * @param heap 内存堆
+ * @param block 已分配的内存块，未标记时不做处理
  */
-int dmem_init(void* pool, unsigned int size)
+static void _tag_detach(dmem_heap_t heap, dmem_block_t block)
 {
-    /** 内存管理器初始化 **/
-    memset(&mgr, 0, sizeof(mgr));
+    uint8_t tag = dmem_block_tag(block);
 
-    /** 内存池不可为 NULL **/
-    if(pool == NULL)
+    if(tag != 0)
     {
-        dmem_trace(DMEM_LEVEL_ERROR, "Pool's address is NULL!");
-        return DMEM_INIT_POOL_NULL;
+        heap->tags[tag].live_bytes -= dmem_block_mem_size(heap, block);
+        heap->tags[tag].live_count--;
+        if(heap->tag_budget != NULL)
+            dmem_atomic_fetch_sub(&heap->tag_budget->live_bytes[tag], dmem_block_mem_size(heap, block));
+        block->used &= (uint16_t) ~DMEM_BLOCK_TAG_MASK;
     }
+}
+#else
+    #define _tag_detach(heap, block)    ((void)0)
+#endif
 
-    /** 内存池地址未对齐 **/
-    if(!IS_DMEM_VAR_ALIGNED(pool, DMEM_DEFINE_ALIGN_SIZE))
-    {
-        dmem_trace(DMEM_LEVEL_WARNING, "Current pool address is not aligned(%p)", pool);
-        return DMEM_INIT_POOL_ALIGN;
-    } 
+/**
+ * @brief 将当前的统计值写入一份内存使用报告快照
+ * @param stats 快照
+ * @param heap 内存堆
+ * @param used_count 已分配的内存数量
+ */
+static void _stats_write(volatile struct dmem_use_report* stats, dmem_heap_t heap, dmem_size_t used_count)
+{
+    dmem_atomic_store(&stats->free, heap->free);
+    dmem_atomic_store(&stats->max_usage, heap->max_usage);
+    dmem_atomic_store(&stats->initf, heap->inited_free);
+    dmem_atomic_store(&stats->used_count, used_count);
+}
 
-    /** 检查内存池大小对齐情况，若未对齐，则尝试对齐 **/
-    if(!IS_DMEM_VAR_ALIGNED(size, DMEM_DEFINE_ALIGN_SIZE))
+/**
+ * @brief 将当前的统计值写入内存使用报告快照
+ * @note 1. 调用者需持有内存堆的线程锁（或处于初始化阶段）
+ *       2. 两份快照轮流更新，序列号为奇数时读者读取 stats[1]，为偶数时读取 stats[0]，总有一份是完整的，
+ *          即使写者在更新途中被读者（如中断）打断，读者也能立即读到上一次发布的快照
+ * @param heap 内存堆
+ */
+static void _stats_publish(dmem_heap_t heap)
+{
+    uint32_t seq = heap->stats_seq;
+    dmem_size_t used_count = heap->used_count;
+
+#if ENABLE_DMEM_SLAB
+    /** 小对象分配器的页及页映射表不计入，改为统计其中的小对象 **/
+    used_count += heap->slab_objects - heap->slab_pages - (heap->slab_map != NULL);
+#endif
+    dmem_atomic_store(&heap->stats_seq, seq + 1);
+    dmem_fence_release();
+    _stats_write(&heap->stats[0], heap, used_count);
+    dmem_atomic_store_release(&heap->stats_seq, seq + 2);
+    _stats_write(&heap->stats[1], heap, used_count);
+}
+
+/**
+ * @brief 发布统计快照并释放内存堆的线程锁，所有修改内存堆的操作均以此结束
+ * @param heap 内存堆
+ */
+static void _heap_unlock(dmem_heap_t heap)
+{
+#if ENABLE_DMEM_PURGE
+    /** 延迟归还：有空闲内存块到期时遍历归还 **/
+    if(heap->purge_pending && (int32_t)(dmem_get_tick() - heap->purge_next) >= 0)
+        _purge_scan(heap, false);
+#endif
+    _stats_publish(heap);
+    dmem_rel_lock(heap);
+}
+
+#if ENABLE_DMEM_RECORD
+/**
+ * ----------------------------------------------------------------------------
+ * 分配记录
+ * 记录在持有内存堆线程锁时写入，因此与内存堆实际执行的顺序一致。
+ * 设置了回调函数时，缓冲区写满后整体交给回调函数并清空；未设置时覆盖最早的记录。
+ * ----------------------------------------------------------------------------
+ */
+#define dmem_recording(heap)        ((heap)->record_buf != NULL)
+
+/**
+ * @brief 将内存地址换算为记录中的句柄
+ * @param heap 内存堆
+ * @param mem 内存地址
+ * @return uint32_t 句柄，mem 为 NULL 时返回 DMEM_RECORD_NULL
+ */
+static uint32_t _record_id(dmem_heap_t heap, const void* mem)
+{
+    if(mem == NULL)
+        return DMEM_RECORD_NULL;
+    return (uint32_t)((size_t)((const char*) mem - heap->pool) / DMEM_DEFINE_ALIGN_SIZE + 1);
+}
+
+/**
+ * @brief 按时间顺序将缓冲区中的记录交给回调函数，并清空缓冲区
+ * @param heap 内存堆
+ */
+static void _record_drain(dmem_heap_t heap)
+{
+    size_t first = heap->record_cap - heap->record_head;
+
+    if(heap->record_len == 0 || heap->record_drain == NULL)
+        return;
+    if(first > heap->record_len)
+        first = heap->record_len;
+    heap->record_drain(heap->record_buf + heap->record_head, first, heap->record_arg);
+    if(heap->record_len > first)
+        heap->record_drain(heap->record_buf, heap->record_len - first, heap->record_arg);
+    heap->record_head = 0;
+    heap->record_len = 0;
+}
+
+/**
+ * @brief 写入一条分配记录
+ * @note 调用者需持有内存堆的线程锁
+ * @param heap 内存堆
+ * @param op 操作类型 DMEM_RECORD_xxx
+ * @param size 请求的大小
+ * @param align 对齐大小，仅 DMEM_RECORD_ALIGNED 使用
+ * @param mem 返回（或被释放）的内存
+ * @param old DMEM_RECORD_REALLOC 的原内存
+ */
+static void _record(dmem_heap_t heap, uint8_t op, size_t size, size_t align, const void* mem, const void* old)
+{
+    struct dmem_record* r;
+    uint8_t align_log2 = 0;
+
+    if(!dmem_recording(heap))
+        return;
+    if(heap->record_len == heap->record_cap)
     {
-        dmem_trace(DMEM_LEVEL_WARNING, "Current pool size is not aligned(%d bytes), dmem will adjust other size...", size);
-        size = MAKE_POOL_SIZE_ALIGN(size);
-        dmem_trace(DMEM_LEVEL_INFO, "New pool size: %d bytes", size);
+        if(heap->record_drain != NULL)
+            _record_drain(heap);
+        else
+        {
+            heap->record_head = (heap->record_head + 1) % heap->record_cap;
+            heap->record_len--;
+            heap->record_lost++;
+        }
     }
+    while(((size_t) 1 << align_log2) < align)
+        align_log2++;
 
-    /** 内存池大小过小 **/
-    if(size < dmem_min_alloc_size() + dmem_block_size() * 2)
+    r = &heap->record_buf[(heap->record_head + heap->record_len) % heap->record_cap];
+    heap->record_len++;
+    r->op = op;
+    r->align_log2 = align_log2;
+    r->reserved = 0;
+    r->tick = dmem_get_tick();
+    r->size = size > UINT32_MAX ? UINT32_MAX : (uint32_t) size;
+    r->id = _record_id(heap, mem);
+    r->old = _record_id(heap, old);
+}
+#else
+    #define dmem_recording(heap)    false
+    #define _record(...)            ((void)0)
+#endif
+
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+/**
+ * ----------------------------------------------------------------------------
+ * 首次适配引擎
+ * 所有空闲内存块按地址顺序链接成双向空闲链表（链表节点存放在空闲内存块的用户内存中），
+ * bfree 为链表头，即地址最低的空闲内存块。分配时只需遍历空闲内存块，无需经过已使用的内存块。
+ * 移除空闲内存块时会记录其在链表中的前驱 (bhint)，随后在同一位置插入的空闲内存块（拆分的剩余部分、合并后的内存块）
+ * 可直接链接到该前驱之后，无需再次查找插入位置。
+ * 放置策略 (policy) 决定查找与插入的方式：
+ *  - DMEM_POLICY_FIRST_FIT: 从链表头查找第一个足够大的空闲内存块；
+ *  - DMEM_POLICY_NEXT_FIT:  从上一次分配的位置 (brover) 开始查找，到达链表尾后回到链表头；
+ *  - DMEM_POLICY_BEST_FIT:  遍历整个链表，选取足够大的空闲内存块中最小的一个；
+ *  - DMEM_POLICY_LIFO:      空闲内存块插入到链表头，优先复用最近释放的内存块，此时链表不再按地址排序。
+ * ----------------------------------------------------------------------------
+ */
+#define dmem_free_next(heap, block)         (dmem_free_node(block)->next_free == dmem_off_null() ? NULL : \
+                                             (dmem_block_t) dmem_pool_at(heap, dmem_free_node(block)->next_free))
+#define dmem_free_prev(heap, block)         (dmem_free_node(block)->prev_free == dmem_off_null() ? NULL : \
+                                             (dmem_block_t) dmem_pool_at(heap, dmem_free_node(block)->prev_free))
+
+/**
+ * @brief 初始化空闲链表
+ * @param heap 内存堆
+ */
+static void _free_list_init(dmem_heap_t heap)
+{
+    dmem_free_block(heap) = NULL;
+    heap->bhint = NULL;
+    heap->hint_valid = false;
+    heap->brover = NULL;
+}
+
+/**
+ * @brief 将空闲内存块链接到 prev 之后
+ * @param heap 内存堆
+ * @param prev 前驱空闲内存块，若为 NULL 则插入到链表头
+ * @param block 空闲内存块
+ */
+static void _free_list_link(dmem_heap_t heap, dmem_block_t prev, dmem_block_t block)
+{
+    dmem_block_t next = prev ? dmem_free_next(heap, prev) : dmem_free_block(heap);
+
+    dmem_free_node(block)->prev_free = prev ? dmem_block_offset(heap, prev) : dmem_off_null();
+    dmem_free_node(block)->next_free = next ? dmem_block_offset(heap, next) : dmem_off_null();
+    if(prev)
+        dmem_free_node(prev)->next_free = dmem_block_offset(heap, block);
+    else
+        dmem_free_block(heap) = block;
+    if(next)
+        dmem_free_node(next)->prev_free = dmem_block_offset(heap, block);
+}
+
+/**
+ * @brief 将空闲内存块按地址顺序加入空闲链表
+ * @param heap 内存堆
+ * @param block 空闲内存块
+ */
+static void _free_list_insert(dmem_heap_t heap, dmem_block_t block)
+{
+    dmem_block_t prev = NULL;
+    dmem_block_t next = NULL;
+    dmem_off_t offset = dmem_block_offset(heap, block);
+
+    _free_stats_add(heap, block);
+
+    /** LIFO 策略直接插入到链表头 **/
+    if(heap->policy == DMEM_POLICY_LIFO)
     {
-        dmem_trace(DMEM_LEVEL_ERROR, "Pool size is too small!");
-        return DMEM_INIT_SIZE_SMALL;
+        _free_list_link(heap, NULL, block);
+        return;
     }
 
-    /** 保存内存池 **/
-    mgr.pool = (char*) pool;
-    mgr.size = size;
+    /** 优先使用上一次移除操作记录的前驱 **/
+    if(heap->hint_valid)
+    {
+        prev = heap->bhint;
+        heap->hint_valid = false;
+        if(prev != NULL && dmem_block_offset(heap, prev) > offset)
+            prev = NULL;
+    }
+
+    /** 前驱不满足要求时，沿空闲链表向后查找插入位置 **/
+    next = prev ? dmem_free_next(heap, prev) : dmem_free_block(heap);
+    while(next != NULL && dmem_block_offset(heap, next) < offset)
+    {
+        prev = next;
+        next = dmem_free_next(heap, next);
+    }
 
-    dmem_head_block() = (dmem_block_t) dmem_pool_at(0);
-    dmem_head_block()->magic = dmem_block_magic();
-    dmem_head_block()->prev = dmem_block_offset(dmem_head_block());
-    dmem_head_block()->used = false;
+    _free_list_link(heap, prev, block);
 
-    dmem_tail_block() = (dmem_block_t) dmem_pool_at(dmem_pool_size() - dmem_block_size());
-    dmem_tail_block()->magic = dmem_block_magic();
-    dmem_tail_block()->prev = dmem_block_offset(dmem_head_block());
-    dmem_tail_block()->used = true;
+    /** 新插入的内存块可作为下一次插入的起点 **/
+    heap->bhint = block;
+    heap->hint_valid = true;
+}
 
-    dmem_head_block()->next = dmem_block_offset(dmem_tail_block());
-    dmem_tail_block()->next = dmem_block_offset(dmem_tail_block());
+/**
+ * @brief 将空闲内存块移出空闲链表（即将被分配、合并或调整大小）
+ * @param heap 内存堆
+ * @param block 空闲内存块
+ */
+static void _free_list_remove(dmem_heap_t heap, dmem_block_t block)
+{
+    dmem_block_t prev = dmem_free_prev(heap, block);
+    dmem_block_t next = dmem_free_next(heap, block);
 
-    dmem_free_block() = dmem_head_block();
+    _free_stats_sub(heap, block);
 
-    mgr.free = dmem_block_mem_size(dmem_head_block());
-    mgr.max_usage = dmem_pool_size() - mgr.free;
-    mgr.inited_free = mgr.free;
-    
-    dmem_trace(DMEM_LEVEL_INFO, "Initialized memory pool | Addr: %p | Size: %u bytes", pool, size);
-    dmem_trace(DMEM_LEVEL_DEBUG, "Head block: %p | Tail block: %p | Free: %u bytes", dmem_head_block(), dmem_tail_block(), mgr.free);
+    if(prev)
+        dmem_free_node(prev)->next_free = dmem_free_node(block)->next_free;
+    else
+        dmem_free_block(heap) = next;
+    if(next)
+        dmem_free_node(next)->prev_free = dmem_free_node(block)->prev_free;
 
-    return DMEM_ERR_NONE;
+    heap->bhint = prev;
+    heap->hint_valid = true;
+    if(heap->brover == block)
+        heap->brover = next;
 }
 
 /**
- * @brief 依据指定的大小安全地分配连续的空间
- * @param size 需要分配的内存的大小
- * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ * @brief 查找可容纳 size 字节的空闲内存块
+ * @param heap 内存堆
+ * @param size 已对齐的内存大小
+ * @return dmem_block_t 若查找失败则返回 NULL
  */
-void* dmem_alloc(unsigned int size)
+static dmem_block_t _free_list_search(dmem_heap_t heap, dmem_size_t size)
 {
-    void* p = NULL;
-    dmem_get_lock();
-    p = _alloc(size);
-    dmem_rel_lock();
-    return p;
+    dmem_block_t pos = NULL;
+    dmem_block_t start = NULL;
+    dmem_block_t best = NULL;
+
+    switch(heap->policy)
+    {
+    case DMEM_POLICY_NEXT_FIT:
+        /** 从上一次分配的位置查找到链表尾，再从链表头查找到该位置 **/
+        start = heap->brover ? heap->brover : dmem_free_block(heap);
+        for(pos = start; pos != NULL; pos = dmem_free_next(heap, pos))
+            if(dmem_block_mem_size(heap, pos) >= size)
+                return heap->brover = pos;
+        for(pos = dmem_free_block(heap); pos != start; pos = dmem_free_next(heap, pos))
+            if(dmem_block_mem_size(heap, pos) >= size)
+                return heap->brover = pos;
+        return NULL;
+
+    case DMEM_POLICY_BEST_FIT:
+        for(pos = dmem_free_block(heap); pos != NULL; pos = dmem_free_next(heap, pos))
+        {
+            dmem_size_t mem_size = dmem_block_mem_size(heap, pos);
+            if(mem_size == size)
+                return pos;
+            if(mem_size > size && (best == NULL || mem_size < dmem_block_mem_size(heap, best)))
+                best = pos;
+        }
+        return best;
+
+    default:
+        /** 遍历空闲链表，搜寻可用的内存块 **/
+        for(pos = dmem_free_block(heap); pos != NULL; pos = dmem_free_next(heap, pos))
+        {
+            if(dmem_block_mem_size(heap, pos) >= size)
+                return pos;
+        }
+        return NULL;
+    }
 }
 
 /**
- * @brief 依据指定的大小重新分配新的连续的空间，并释放旧的已分配内存
- * @param old_mem 旧的被分配的内存
- * @param new_size 新的被指定的内存大小
- * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ * @brief 遍历空闲链表，获取最大空闲内存块的大小
+ * @param heap 内存堆
+ * @return dmem_size_t 
  */
-void* dmem_realloc(void* old_mem, unsigned int new_size)
+static dmem_size_t _free_list_largest(dmem_heap_t heap)
 {
-    /** [1] 处理 NULL 和 size=0 的特殊情况 **/
-    // 如果输入为 NULL, 则相当于执行新内存分配
-    if(old_mem == NULL)
+    dmem_block_t pos = NULL;
+    dmem_size_t largest = 0;
+
+    for(pos = dmem_free_block(heap); pos != NULL; pos = dmem_free_next(heap, pos))
+        if(dmem_block_mem_size(heap, pos) > largest)
+            largest = dmem_block_mem_size(heap, pos);
+    return largest;
+}
+
+/**
+ * @brief 按当前的放置策略重建空闲链表
+ * @param heap 内存堆
+ */
+static void _free_list_rebuild(dmem_heap_t heap)
+{
+    dmem_block_t pos = NULL;
+    dmem_block_t last = NULL;
+
+    _free_list_init(heap);
+    for(pos = dmem_head_block(heap); pos != dmem_tail_block(heap); pos = dmem_block_next(heap, pos))
     {
-        dmem_trace(DMEM_LEVEL_INFO, "Realloc NULL -> new allocation | Size: %u bytes", new_size);
-        return dmem_alloc(new_size);
+        if(dmem_block_is_unused(pos))
+        {
+            /** 按地址顺序追加到链表尾，LIFO 策略下的顺序无关紧要 **/
+            _free_list_link(heap, last, pos);
+            last = pos;
+        }
     }
+}
 
-    // 如果新分配内存为 0, 则执行内存释放功能
-    if(new_size == 0)
+#elif DMEM_ALLOC_ENGINE == DMEM_ENGINE_TLSF
+/**
+ * ----------------------------------------------------------------------------
+ * TLSF (Two-Level Segregated Fit) 引擎
+ * 空闲内存块按大小分为两级：一级按 2 的幂划分，二级将每个一级区间再等分为 DMEM_TLSF_SL_COUNT 份，
+ * 每个区间维护一个双向空闲链表（链表节点存放在空闲内存块的用户内存中），并通过位图记录非空链表，
+ * 查找与插入/移除均为 O(1)。
+ * ----------------------------------------------------------------------------
+ */
+#define dmem_tlsf_small_size()              ((dmem_size_t) DMEM_TLSF_SL_COUNT * DMEM_DEFINE_ALIGN_SIZE)
+#define dmem_tlsf_head(heap, fl, sl)        ((heap)->free_heads[fl][sl])
+
+DMEM_STATIC_ASSERT(tlsf_sl_log2, DMEM_TLSF_SL_LOG2 >= 1 && DMEM_TLSF_SL_LOG2 <= 5);
+
+/**
+ * @brief 查找最高有效位
+ * @param x 非 0 值
+ * @return int 最高有效位的位序
+ */
+static int _tlsf_fls(dmem_size_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (int)(sizeof(unsigned long long) * 8 - 1) - __builtin_clzll((unsigned long long) x);
+#else
+    int bit = 0;
+    while(x >>= 1)
+        bit++;
+    return bit;
+#endif
+}
+
+/**
+ * @brief 查找最低有效位
+ * @param x 非 0 值
+ * @return int 最低有效位的位序
+ */
+static int _tlsf_ffs(dmem_tlsf_map_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll((unsigned long long) x);
+#else
+    int bit = 0;
+    while(!(x & 1))
     {
-        dmem_trace(DMEM_LEVEL_DEBUG, "New size is 0, free old memory");
-        dmem_free(old_mem);
-        return NULL;
+        x >>= 1;
+        bit++;
     }
+    return bit;
+#endif
+}
 
-    /** [2] 对齐处理（统一使用向上对齐） **/
-    if(!IS_DMEM_VAR_ALIGNED(new_size, DMEM_DEFINE_ALIGN_SIZE))
+/**
+ * @brief 计算内存大小所属的一级、二级索引
+ * @param size 内存大小
+ * @param fl 一级索引
+ * @param sl 二级索引
+ */
+static void _tlsf_mapping(dmem_size_t size, int* fl, int* sl)
+{
+    if(size < dmem_tlsf_small_size())
     {
-        dmem_trace(DMEM_LEVEL_WARNING, "Current pool size is not aligned(%d bytes), dmem will adjust other size...", new_size);
-        new_size = MAKE_ALLOC_SIZE_ALIGN(new_size);
-        dmem_trace(DMEM_LEVEL_INFO, "New pool size: %d bytes", new_size);
+        /** 小内存块按对齐大小线性划分 **/
+        *fl = 0;
+        *sl = (int)(size / DMEM_DEFINE_ALIGN_SIZE);
     }
+    else
+    {
+        int t = _tlsf_fls(size);
+        *fl = t - _tlsf_fls(dmem_tlsf_small_size()) + 1;
+        *sl = (int)(size >> (t - DMEM_TLSF_SL_LOG2)) - DMEM_TLSF_SL_COUNT;
+    }
+}
 
-    dmem_block_t block = dmem_block_entry(old_mem);
-    void* new_mem = old_mem;  // 默认返回原地址
-    
-    dmem_get_lock();
-
-    /** [3] 验证内存块有效性 **/
-    if(!dmem_block_is_valid(block))
+/**
+ * @brief 初始化空闲链表
+ * @param heap 内存堆
+ */
+static void _free_list_init(dmem_heap_t heap)
+{
+    int fl, sl;
+    heap->fl_bitmap = 0;
+    for(fl = 0; fl < DMEM_TLSF_FL_COUNT; fl++)
     {
-        dmem_trace(DMEM_LEVEL_ERROR, "Old memory is invalid!");
-        dmem_rel_lock();
-        return NULL;
+        heap->sl_bitmap[fl] = 0;
+        for(sl = 0; sl < DMEM_TLSF_SL_COUNT; sl++)
+            dmem_tlsf_head(heap, fl, sl) = dmem_off_null();
     }
+}
 
-    uint32_t old_size = dmem_block_mem_size(block);
+/**
+ * @brief 将空闲内存块加入空闲链表
+ * @param heap 内存堆
+ * @param block 空闲内存块
+ */
+static void _free_list_insert(dmem_heap_t heap, dmem_block_t block)
+{
+    int fl, sl;
+    dmem_off_t head;
 
-    // [4] 大小不变
-    if (new_size == old_size) 
+    _free_stats_add(heap, block);
+    _tlsf_mapping(dmem_block_mem_size(heap, block), &fl, &sl);
+    head = dmem_tlsf_head(heap, fl, sl);
+
+    dmem_free_node(block)->prev_free = dmem_off_null();
+    dmem_free_node(block)->next_free = head;
+    if(head != dmem_off_null())
+        dmem_free_node((dmem_block_t) dmem_pool_at(heap, head))->prev_free = dmem_block_offset(heap, block);
+
+    dmem_tlsf_head(heap, fl, sl) = dmem_block_offset(heap, block);
+    heap->fl_bitmap |= (dmem_tlsf_map_t) 1 << fl;
+    heap->sl_bitmap[fl] |= (uint32_t) 1 << sl;
+}
+
+/**
+ * @brief 将空闲内存块移出空闲链表（即将被分配、合并或调整大小）
+ * @param heap 内存堆
+ * @param block 空闲内存块
+ */
+static void _free_list_remove(dmem_heap_t heap, dmem_block_t block)
+{
+    int fl, sl;
+    dmem_off_t prev = dmem_free_node(block)->prev_free;
+    dmem_off_t next = dmem_free_node(block)->next_free;
+
+    _free_stats_sub(heap, block);
+    if(next != dmem_off_null())
+        dmem_free_node((dmem_block_t) dmem_pool_at(heap, next))->prev_free = prev;
+    if(prev != dmem_off_null())
     {
-        dmem_trace(DMEM_LEVEL_DEBUG, "Realloc same size: %u bytes @ %p", new_size, old_mem);
-        dmem_rel_lock();
-        return old_mem;
+        dmem_free_node((dmem_block_t) dmem_pool_at(heap, prev))->next_free = next;
+        return;
     }
 
-    // [5] 扩展内存
-    if (new_size > old_size) 
+    /** 该内存块为链表头，更新链表头及位图 **/
+    _tlsf_mapping(dmem_block_mem_size(heap, block), &fl, &sl);
+    dmem_tlsf_head(heap, fl, sl) = next;
+    if(next == dmem_off_null())
     {
-        // 优先尝试就地扩展
-        if (_expand_inplace(block, new_size)) 
-        {
-            dmem_rel_lock();
-            return old_mem;
-        }
-        
-        // 无法就地扩展则分配新内存
-        dmem_trace(DMEM_LEVEL_DEBUG, "Allocating new block for realloc: %u -> %u bytes", old_size, new_size);
-        
-        if ((new_mem = _alloc(new_size))) 
-        {
-            memmove(new_mem, old_mem, old_size);
-            _free(old_mem);
-        } 
-        else 
+        heap->sl_bitmap[fl] &= ~((uint32_t) 1 << sl);
+        if(heap->sl_bitmap[fl] == 0)
+            heap->fl_bitmap &= ~((dmem_tlsf_map_t) 1 << fl);
+    }
+}
+
+/**
+ * @brief 查找可容纳 size 字节的空闲内存块
+ * @param heap 内存堆
+ * @param size 已对齐的内存大小
+ * @return dmem_block_t 若查找失败则返回 NULL
+ */
+static dmem_block_t _free_list_search(dmem_heap_t heap, dmem_size_t size)
+{
+    int fl, sl;
+    dmem_size_t rounded = size;
+    dmem_off_t off;
+
+    /** 将 size 向上取整到下一个二级区间的起点，使该区间及更大区间内的任意内存块都足够大 **/
+    if(size >= dmem_tlsf_small_size())
+        rounded += ((dmem_size_t) 1 << (_tlsf_fls(size) - DMEM_TLSF_SL_LOG2)) - 1;
+
+    _tlsf_mapping(rounded, &fl, &sl);
+    if(rounded >= size && fl < DMEM_TLSF_FL_COUNT)
+    {
+        uint32_t sl_map = heap->sl_bitmap[fl] & (~(uint32_t) 0 << sl);
+        if(sl_map == 0)
         {
-            // 分配失败：保留原内存块
-            dmem_trace(DMEM_LEVEL_WARNING, "Realloc failed, keeping original block");
-            new_mem = old_mem;  // 必须返回原指针
+            dmem_tlsf_map_t fl_map = (fl + 1 < DMEM_TLSF_FL_COUNT) ? heap->fl_bitmap & (~(dmem_tlsf_map_t) 0 << (fl + 1)) : 0;
+            if(fl_map != 0)
+            {
+                fl = _tlsf_ffs(fl_map);
+                sl_map = heap->sl_bitmap[fl];
+            }
         }
-    } 
-    // [6] 收缩内存
-    else 
+        if(sl_map != 0)
+            return (dmem_block_t) dmem_pool_at(heap, dmem_tlsf_head(heap, fl, _tlsf_ffs(sl_map)));
+    }
+
+    /** 更大的区间均为空时，size 所在的区间内仍可能存在足够大的内存块 **/
+    _tlsf_mapping(size, &fl, &sl);
+    for(off = dmem_tlsf_head(heap, fl, sl); off != dmem_off_null(); off = dmem_free_node((dmem_block_t) dmem_pool_at(heap, off))->next_free)
     {
-        dmem_trace(DMEM_LEVEL_DEBUG, "Shrinking block: %u -> %u bytes @ %p",  old_size, new_size, old_mem);
-        _split(block, new_size);
+        if(dmem_block_mem_size(heap, (dmem_block_t) dmem_pool_at(heap, off)) >= size)
+            return (dmem_block_t) dmem_pool_at(heap, off);
     }
-    
-    dmem_rel_lock();
-    return new_mem;
+    return NULL;
 }
 
 /**
- * @brief 分配指定大小和数量的连续空间，并自动将已分配的内存初始化为 0
- * @param count 对象的数量
- * @param size 对象的大小
- * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ * @brief 获取最大空闲内存块的大小，最大的内存块必然位于最高的非空区间，只需遍历该区间的链表
+ * @param heap 内存堆
+ * @return dmem_size_t 
  */
-void* dmem_calloc(unsigned int count, unsigned int size)
+static dmem_size_t _free_list_largest(dmem_heap_t heap)
 {
-    unsigned int total = count * size;
-    void* p = NULL;
-
-    dmem_get_lock();
-    p = _alloc(total);
-    if(p)
-        memset(p, 0, total);
-    dmem_rel_lock();
+    int fl, sl;
+    dmem_off_t off;
+    dmem_size_t largest = 0;
 
-    return p;
+    if(heap->fl_bitmap == 0)
+        return 0;
+    for(fl = DMEM_TLSF_FL_COUNT - 1; !(heap->fl_bitmap & ((dmem_tlsf_map_t) 1 << fl)); fl--)
+        ;
+    for(sl = DMEM_TLSF_SL_COUNT - 1; !(heap->sl_bitmap[fl] & ((uint32_t) 1 << sl)); sl--)
+        ;
+    for(off = dmem_tlsf_head(heap, fl, sl); off != dmem_off_null(); off = dmem_free_node((dmem_block_t) dmem_pool_at(heap, off))->next_free)
+    {
+        dmem_size_t mem_size = dmem_block_mem_size(heap, (dmem_block_t) dmem_pool_at(heap, off));
+        if(mem_size > largest)
+            largest = mem_size;
+    }
+    return largest;
 }
+#endif
 
 /**
- * @brief 安全地释放被分配的内存
- * @param mem 待释放的内存
- * @return int  0:  释放成功
- *              -1: mem 为 NULL
- *              -2: 内存块信息无效
- *              -3: 该内存块不可重复释放
+ * @brief 获取最大空闲内存块的精确大小，不精确时由引擎重新计算
+ * @param heap 内存堆
+ * @return dmem_size_t 
  */
-int dmem_free(void* mem)
+static dmem_size_t _largest_free(dmem_heap_t heap)
 {
-    int res = 0;
-    dmem_get_lock();
-    res = _free(mem);
-    dmem_rel_lock();
-    return res;
+    if(!heap->largest_exact)
+    {
+        heap->largest_free = _free_list_largest(heap);
+        heap->largest_exact = true;
+    }
+    return heap->largest_free;
 }
 
 /**
- * @brief 读取内存使用报告
- * @note 支持可重入获取内存使用报告
- * @param result 用户填入的内存使用报告结构体，由函数内部填充
+ * @brief 查找可容纳 size 字节的空闲内存块，超过最大空闲内存块上界的请求立即失败
+ * @param heap 内存堆
+ * @param size 已对齐的内存大小
+ * @return dmem_block_t 若查找失败则返回 NULL
  */
-void dmem_read_use_report(struct dmem_use_report* result)
+static dmem_block_t _search(dmem_heap_t heap, dmem_size_t size)
 {
     dmem_block_t pos = NULL;
-    dmem_get_lock();
-    result->free = mgr.free;
-    result->max_usage = mgr.max_usage;
-    result->initf = mgr.inited_free;
-    result->used_count = 0;
-    for(pos = dmem_head_block(); pos != dmem_tail_block(); pos = dmem_block_next(pos))
-        if(!dmem_block_is_unused(pos))
-            result->used_count++;
-    dmem_rel_lock();
+
+    if(size > heap->largest_free)
+        return NULL;
+    if((pos = _free_list_search(heap, size)) == NULL)
+    {
+        /** 各引擎查找失败即说明不存在足够大的空闲内存块，收紧上界使后续同样大的请求立即失败 **/
+        heap->largest_free = size - 1;
+        heap->largest_exact = false;
+    }
+    return pos;
+}
+
+/**
+ * @brief 将已移出空闲链表的内存块分配出去，剩余空间足够时拆分为新的空闲内存块
+ * @note 调用者需确保内存块已移出空闲链表，且其大小已从空闲内存中扣除
+ * @param heap 内存堆
+ * @param pos 内存块
+ * @param size 已对齐的内存大小
+ * @param request 用户请求的内存大小，用于统计内部浪费
+ * @return void* 内存块的用户内存地址
+ */
+static void* _alloc_block(dmem_heap_t heap, dmem_block_t pos, dmem_size_t size, size_t request)
+{
+    /**
+     * 匹配成功，剩余空间是否还可以创建新的空闲内存块，
+     * 如果无法创建新的内存块，则将剩余的空闲内存全部分配，
+     * 避免出现无法被管理的内存碎片
+     */
+    if(dmem_block_mem_size(heap, pos) - size >= dmem_min_alloc_size() + dmem_block_size())
+    {
+        /** 创建新的空闲内存块 **/
+        dmem_block_t next = _insert_block_after(heap, pos, size);
+        heap->free += dmem_block_mem_size(heap, next);
+        _free_list_insert(heap, next);
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+        /** 循环首次适配：下一次查找从剩余的空闲内存块开始 **/
+        if(heap->policy == DMEM_POLICY_NEXT_FIT)
+            heap->brover = next;
+#endif
+    }
+    pos->used = DMEM_BLOCK_USED;
+    heap->used_count++;
+    _block_set_slack(heap, pos, request);
+    _mark_dirty(heap, dmem_block_next(heap, pos));
+
+    /** 更新管理器记录 **/
+    _update_max_usage(heap);
+    _event(heap, DMEM_EVENT_LEVEL_INFO, DMEM_EVENT_ALLOC, dmem_block_offset(heap, pos), dmem_block_mem_size(heap, pos));
+
+    dmem_trace( DMEM_LEVEL_DEBUG, 
+                "Allocated %lu bytes at %p | Block: %p | Remaining free: %lu bytes", 
+                (unsigned long)(dmem_block_mem_size(heap, pos)), dmem_block_mem_addr(pos), 
+                pos, (unsigned long)heap->free);
+
+    return dmem_block_mem_addr(pos);
 }
 
+/**
+ * @brief 依据指定的大小分配连续的内存空间
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param size 待分配的内存的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+static void* _alloc(dmem_heap_t heap, size_t size)
+{
+    dmem_block_t pos = NULL;
+    size_t request = size;
+
+    if(size == 0)
+        return NULL;
+    if(size > dmem_pool_size(heap))                          // 超出内存池大小的请求必然失败，同时避免对齐计算时溢出
+        goto _ALLOC_FAILED_;
+    if(!IS_DMEM_VAR_ALIGNED(size, DMEM_DEFINE_ALIGN_SIZE))   // 如果分配的内存大小不符合对齐要求, 则数值向上分配内存对齐的待大小（如127->128）
+        size = MAKE_ALLOC_SIZE_ALIGN(size);
+    if(size < dmem_min_alloc_size())
+        size = dmem_min_alloc_size();
+    if((pos = _search(heap, size)) == NULL)
+        goto _ALLOC_FAILED_;
+
+    _free_list_remove(heap, pos);
+    heap->free -= dmem_block_mem_size(heap, pos);
+
+    return _alloc_block(heap, pos, size, request);
+
+_ALLOC_FAILED_:;
+    _event(heap, DMEM_EVENT_LEVEL_WARNING, DMEM_EVENT_ALLOC_FAIL, request > UINT32_MAX ? UINT32_MAX : request, heap->free);
+    dmem_trace(DMEM_LEVEL_WARNING, "Allocation failed | Requested: %lu bytes | Free: %lu bytes", (unsigned long)size, (unsigned long)heap->free);
+    return NULL;
+}
+
+/**
+ * @brief 按指定的地址对齐分配连续的内存空间，对齐产生的填充部分将作为独立的空闲内存块
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param align 地址对齐大小，必须为 2 的幂
+ * @param size 待分配的内存的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+static void* _alloc_aligned(dmem_heap_t heap, size_t align, size_t size)
+{
+    dmem_block_t pos = NULL;
+    size_t request = size;
+    uintptr_t mem, aligned;
+    size_t need;
+
+    if(align <= DMEM_DEFINE_ALIGN_SIZE)
+        return _alloc(heap, size);
+    if(size == 0)
+        return NULL;
+    if(size > dmem_pool_size(heap) || align > dmem_pool_size(heap))
+        goto _ALLOC_FAILED_;
+    if(!IS_DMEM_VAR_ALIGNED(size, DMEM_DEFINE_ALIGN_SIZE))
+        size = MAKE_ALLOC_SIZE_ALIGN(size);
+    if(size < dmem_min_alloc_size())
+        size = dmem_min_alloc_size();
+
+    /** 预留最坏情况下的填充空间：填充部分需容纳一个最小的空闲内存块 **/
+    need = size + align + dmem_block_size() + dmem_min_alloc_size();
+    if(need > dmem_pool_size(heap))                          // 先在 size_t 下比较，避免窄偏移量下截断
+        goto _ALLOC_FAILED_;
+    if((pos = _search(heap, (dmem_size_t) need)) == NULL)
+        goto _ALLOC_FAILED_;
+
+    _free_list_remove(heap, pos);
+    heap->free -= dmem_block_mem_size(heap, pos);
+
+    mem = (uintptr_t) dmem_block_mem_addr(pos);
+    if(mem & (align - 1))
+    {
+        /** 在对齐地址前创建新的内存块，原内存块缩小为填充部分并放回空闲链表 **/
+        dmem_block_t block;
+        aligned = (mem + dmem_block_size() + dmem_min_alloc_size() + align - 1) & ~(uintptr_t)(align - 1);
+        block = _insert_block_after(heap, pos, (dmem_size_t)(aligned - mem - dmem_block_size()));
+        heap->free += dmem_block_mem_size(heap, pos);
+        _free_list_insert(heap, pos);
+        pos = block;
+    }
+
+    return _alloc_block(heap, pos, size, request);
+
+_ALLOC_FAILED_:;
+    _event(heap, DMEM_EVENT_LEVEL_WARNING, DMEM_EVENT_ALLOC_FAIL, request > UINT32_MAX ? UINT32_MAX : request, heap->free);
+    dmem_trace(DMEM_LEVEL_WARNING, "Aligned allocation failed | Requested: %lu bytes | Align: %lu | Free: %lu bytes", (unsigned long)size, (unsigned long)align, (unsigned long)heap->free);
+    return NULL;
+}
+
+/**
+ * @brief 释放被分配的内存
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param mem 待释放的内存地址
+ * @return int  - DMEM_ERR_NONE           : 释放成功
+ *              - DMEM_FREE_NULL          : mem 为 NULL
+ *              - DMEM_FREE_INVALID_MEM   : 内存块信息无效
+ *              - DMEM_FREE_REPEATED      : 该内存块不可重复释放
+ */
+static int _free(dmem_heap_t heap, void* mem)
+{
+    dmem_block_t block = NULL;
+
+    /** 检查 mem 的合法性 **/
+    if(!mem)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Address is NULL");
+        _event(heap, DMEM_EVENT_LEVEL_ERROR, DMEM_EVENT_FREE_ERROR, 0, -DMEM_FREE_NULL);
+        return DMEM_FREE_NULL;
+    }
+        
+    /** 检查内存块合法性 **/
+    block = dmem_block_entry(mem);
+    if(!dmem_mem_in_pool(heap, mem) || !dmem_block_is_valid(block))
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Block is invalid");
+        _event(heap, DMEM_EVENT_LEVEL_ERROR, DMEM_EVENT_FREE_ERROR, dmem_event_offset(heap, mem), -DMEM_FREE_INVALID_MEM);
+        return DMEM_FREE_INVALID_MEM;
+    }
+
+    /** 检查内存释放被占用 **/
+    if(!(block->used & DMEM_BLOCK_USED))
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Double free detected | Addr: %p | Block: %p", mem, block);
+        _event(heap, DMEM_EVENT_LEVEL_ERROR, DMEM_EVENT_FREE_ERROR, dmem_event_offset(heap, mem), -DMEM_FREE_REPEATED);
+        return DMEM_FREE_REPEATED;
+    }
+
+    /** 小对象分配器的页只能由小对象分配器释放，句柄分配的内存块只能通过句柄释放 **/
+    if(block->used & (DMEM_BLOCK_SLAB | DMEM_BLOCK_MOVABLE))
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Block is a slab page or movable | Addr: %p", mem);
+        _event(heap, DMEM_EVENT_LEVEL_ERROR, DMEM_EVENT_FREE_ERROR, dmem_event_offset(heap, mem), -DMEM_FREE_INVALID_MEM);
+        return DMEM_FREE_INVALID_MEM;
+    }
+
+    /** 重置标志位 **/
+    _tag_detach(heap, block);
+    heap->waste -= dmem_block_slack(block);
+    block->used = 0;
+    heap->used_count--;
+
+    /** 更新管理器记录 **/
+    heap->free += (dmem_block_mem_size(heap, block));
+    _event(heap, DMEM_EVENT_LEVEL_INFO, DMEM_EVENT_FREE, dmem_block_offset(heap, block), dmem_block_mem_size(heap, block));
+    dmem_trace(DMEM_LEVEL_DEBUG, "Freed %lu bytes at %p | Block: %p | New free: %lu bytes", (unsigned long)(dmem_block_mem_size(heap, block)), mem, block, (unsigned long)heap->free);
+
+    // 检查下一个节点，如果空闲，则进行合并
+    {
+        dmem_block_t next = dmem_block_next(heap, block);
+        if (dmem_block_is_unused(next))
+        {
+            _free_list_remove(heap, next);
+            _merge_free_blocks(heap, block, next);
+        }
+    }
+
+    // 检查上一个节点，如果空闲，则进行合并
+    // @note 先移除后方的空闲块再移除前方的空闲块，空闲链表记录的前驱即为合并后内存块的插入位置
+    if(dmem_head_block(heap) != block)      // 忽略当前内存块是首节点的情况
+    {
+        dmem_block_t prev = dmem_block_prev(heap, block);
+        if (dmem_block_is_unused(prev)) 
+        {
+            _free_list_remove(heap, prev);
+            _merge_free_blocks(heap, prev, block);
+            block = prev;       // 合并后，block 指向合并后的内存块
+        }   
+    }
+
+    /** 加入空闲链表 **/
+    _free_list_insert(heap, block);
+    _purge_freed(heap, block);
+
+    /** 更新管理器记录 **/
+    _update_max_usage(heap);
+
+    return DMEM_ERR_NONE;
+}
+
+/**
+ * @brief 将已分配的内存块拆分为更小的已用内存卡和空闲内存块(并对相连的内存块进行合并操作),
+ *        若无法拆分，则不进行拆分.
+ * @param heap 
+ * @param block 
+ * @param size 
+ * @return int 
+ */
+static void _split(dmem_heap_t heap, dmem_block_t block, size_t new_size)
+{
+    /** 如果当前的内存块的实际可用内存大小大于新指定的内存大小，若可进行内存块的拆分, 则需要进行内存块的拆分 **/
+    if(dmem_block_mem_size(heap, block) - new_size > (dmem_min_alloc_size() + dmem_block_size()))
+    {   
+        /** 获取当前内存块后一个内存块 **/
+        dmem_block_t next = dmem_block_next(heap, block);
+#if ENABLE_DMEM_TRACE
+        dmem_size_t old_used_mem_size = dmem_block_mem_size(heap, block);
+#endif
+
+        /** 将剩余部分变为空闲内存块 **/
+        dmem_block_t new_free = _insert_block_after(heap, block, new_size);
+
+        /** 重新计算内存块大小 **/
+        heap->free += dmem_block_mem_size(heap, new_free);
+
+        /** 如果后方内存块是空闲的, 则将新的空闲内存块与其进行合并 **/
+        if(dmem_block_is_unused(next))
+        {
+            _free_list_remove(heap, next);
+            _merge_free_blocks(heap, new_free, next);
+        }
+        _free_list_insert(heap, new_free);
+
+        /** 更新管理器记录 **/
+        _update_max_usage(heap);
+        _event(heap, DMEM_EVENT_LEVEL_DEBUG, DMEM_EVENT_SPLIT, dmem_block_offset(heap, new_free), dmem_block_mem_size(heap, new_free));
+
+        dmem_trace( DMEM_LEVEL_DEBUG, 
+                    "Split block: %p | Old: %lu -> New: %lu + Free: %lu", 
+                    block, (unsigned long)old_used_mem_size, (unsigned long)new_size, 
+                    (unsigned long)(dmem_block_mem_size(heap, new_free)));
+    }
+    else
+        dmem_trace( DMEM_LEVEL_DEBUG, "Block can not be splitted");
+}
+
+/**
+ * @brief 适用于 dmem_realloc() 函数，在当前内存块的后方尝试就地扩展内存
+ * @param heap 
+ * @param block 
+ * @param new_size 
+ * @return true 
+ * @return false 
+ */
+static bool _expand_inplace(dmem_heap_t heap, dmem_block_t block, dmem_size_t new_size) 
+{
+    dmem_size_t needed = new_size - dmem_block_mem_size(heap, block);        // 需要扩展的内存大小(不包含原已分配内存块的大小)
+    dmem_block_t next = dmem_block_next(heap, block);                     
+    
+    /** 检查后一个内存块是否为空闲块 **/
+    if (dmem_block_is_unused(next)) 
+    {
+        dmem_size_t total_avail = dmem_block_mem_size(heap, next) + dmem_block_size();
+        dmem_trace( DMEM_LEVEL_DEBUG, "total_avail: %lu bytes, needed: %lu bytes", (unsigned long)total_avail, (unsigned long)needed);
+        
+        /** 如果新加入的空闲内存块大小足够，则就地扩展 **/
+        if (total_avail >= needed) 
+        {
+            dmem_trace( DMEM_LEVEL_DEBUG, 
+                        "In-place expand: %lu -> %lu bytes", 
+                        (unsigned long)(dmem_block_mem_size(heap, block)), (unsigned long)new_size);
+            
+            /** 移除空闲块 **/
+            dmem_block_t next_next = dmem_block_next(heap, next);
+            _free_list_remove(heap, next);
+            heap->free -= dmem_block_mem_size(heap, next);
+            block->next = dmem_block_offset(heap, next_next);
+            next_next->prev = dmem_block_offset(heap, block);
+            
+            /** 若有剩余空间，创建新空闲块 **/
+            dmem_size_t remined = total_avail - needed;
+            dmem_trace( DMEM_LEVEL_DEBUG, "Free: %lu bytes, Remined: %lu bytes", (unsigned long)heap->free, (unsigned long)remined);
+            if (remined >= dmem_min_alloc_size() + dmem_block_size()) 
+            {
+                dmem_block_t new_free = _insert_block_after(heap, block, new_size);
+                heap->free += dmem_block_mem_size(heap, new_free);
+                _free_list_insert(heap, new_free);
+            }
+
+            dmem_trace( DMEM_LEVEL_DEBUG,
+                        "After in-place expand, Free: %lu ytes",
+                        (unsigned long)heap->free);
+
+            _mark_dirty(heap, dmem_block_next(heap, block));
+            _update_max_usage(heap);
+            _event(heap, DMEM_EVENT_LEVEL_DEBUG, DMEM_EVENT_EXPAND, dmem_block_offset(heap, block), dmem_block_mem_size(heap, block));
+
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 适用于 dmem_realloc() 函数，后方空间不足时向空闲的前一个内存块扩展
+ * @note 前一个内存块、当前内存块以及空闲的后一个内存块合并为一个内存块，用户数据通过一次 memmove() 前移，
+ *       无需查找空闲链表；剩余部分足够大时拆分为新的空闲内存块。
+ *       内存块信息头移动到前一个内存块处，调用者需使用返回的内存块
+ * @param heap 内存堆
+ * @param block 已分配的内存块
+ * @param new_size 已对齐的新的内存大小
+ * @return dmem_block_t 扩展后的内存块，空间不足时返回 NULL
+ */
+static dmem_block_t _expand_backward(dmem_heap_t heap, dmem_block_t block, dmem_size_t new_size)
+{
+    dmem_block_t prev, next, after;
+    dmem_size_t old_size = dmem_block_mem_size(heap, block);
+    dmem_size_t total;
+    uint16_t used = block->used;
+
+    if(block == dmem_head_block(heap) || !dmem_block_is_unused(prev = dmem_block_prev(heap, block)))
+        return NULL;
+
+    /** 合并后的可用大小：前一个内存块 + 当前内存块（含信息头）+ 空闲的后一个内存块（含信息头） **/
+    next = dmem_block_next(heap, block);
+    total = dmem_block_mem_size(heap, prev) + dmem_block_size() + old_size;
+    if(dmem_block_is_unused(next))
+        total += dmem_block_size() + dmem_block_mem_size(heap, next);
+    if(total < new_size)
+        return NULL;
+
+    dmem_trace(DMEM_LEVEL_DEBUG, "Backward expand: %lu -> %lu bytes | Block: %p -> %p", (unsigned long)old_size, (unsigned long)new_size, block, prev);
+
+    /** 移出空闲链表（空闲链表节点位于空闲内存块的用户内存中，需在移动数据之前移除） **/
+    _free_list_remove(heap, prev);
+    heap->free -= dmem_block_mem_size(heap, prev);
+    after = next;
+    if(dmem_block_is_unused(next))
+    {
+        _free_list_remove(heap, next);
+        heap->free -= dmem_block_mem_size(heap, next);
+        after = dmem_block_next(heap, next);
+    }
+
+    /** 重新链接，前一个内存块继承当前内存块的标志位 **/
+    prev->next = dmem_block_offset(heap, after);
+    after->prev = dmem_block_offset(heap, prev);
+    prev->used = used;
+
+    /** 前移用户数据，源与目标可能重叠 **/
+    memmove(dmem_block_mem_addr(prev), dmem_block_mem_addr(block), old_size);
+
+    /** 数据移动完成后再拆分剩余部分，避免新的信息头覆盖尚未移动的数据 **/
+    if(total - new_size >= dmem_min_alloc_size() + dmem_block_size())
+    {
+        dmem_block_t new_free = _insert_block_after(heap, prev, new_size);
+        heap->free += dmem_block_mem_size(heap, new_free);
+        _free_list_insert(heap, new_free);
+    }
+
+    _mark_dirty(heap, dmem_block_next(heap, prev));
+    _update_max_usage(heap);
+    _event(heap, DMEM_EVENT_LEVEL_DEBUG, DMEM_EVENT_EXPAND_BACKWARD, dmem_block_offset(heap, prev), dmem_block_mem_size(heap, prev));
+    return prev;
+}
+
+#if ENABLE_DMEM_GROW
+/**
+ * @brief 将新的内存区域链接到内存块链表末尾
+ * @note 原尾内存块保持已使用状态，成为指向新内存区域首内存块的哨兵内存块，
+ *       其两侧的内存块不会跨越内存区域合并；新内存区域的末尾创建新的尾内存块
+ * @param heap 内存堆
+ * @param region 内存区域地址
+ * @param size 内存区域大小
+ * @return int  - DMEM_ERR_NONE           : 添加成功
+ *              - DMEM_REGION_INVALID     : 内存区域为空、过小、不在已有内存区域之后或超出偏移量范围
+ *              - DMEM_REGION_FULL        : 内存区域数量已达 DMEM_REGION_MAX
+ */
+static int _add_region(dmem_heap_t heap, void* region, size_t size)
+{
+    uintptr_t start = ((uintptr_t) region + DMEM_DEFINE_ALIGN_SIZE - 1) & ~(uintptr_t)(DMEM_DEFINE_ALIGN_SIZE - 1);
+    uintptr_t end = ((uintptr_t) region + size) & ~(uintptr_t)(DMEM_DEFINE_ALIGN_SIZE - 1);
+    uintptr_t last = (uintptr_t) dmem_block_mem_addr(dmem_tail_block(heap));        // 最后一个内存区域的结束地址
+    dmem_block_t sentinel = dmem_tail_block(heap);
+    dmem_block_t head, tail;
+    uint32_t count = heap->region_count;
+
+    if(count >= DMEM_REGION_MAX)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Too many regions: %d", DMEM_REGION_MAX);
+        return DMEM_REGION_FULL;
+    }
+    if(region == NULL || (uintptr_t) region + size < (uintptr_t) region || start < last || end <= start ||
+       end - start < dmem_min_alloc_size() + 2 * dmem_block_size() ||
+       (uintmax_t)(end - (uintptr_t) heap->pool) > (uintmax_t) dmem_offset_max())      // 尾内存块的偏移量不能与空偏移量相同
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Invalid region | Addr: %p | Size: %lu bytes", region, (unsigned long)size);
+        return DMEM_REGION_INVALID;
+    }
+
+    head = (dmem_block_t) start;
+    tail = (dmem_block_t)(end - dmem_block_size());
+    head->magic = dmem_block_magic();
+    head->used = 0;
+    head->prev = dmem_block_offset(heap, sentinel);
+    head->next = dmem_block_offset(heap, tail);
+    tail->magic = dmem_block_magic();
+    tail->used = DMEM_BLOCK_USED;
+    tail->prev = dmem_block_offset(heap, head);
+    tail->next = dmem_block_offset(heap, tail);
+    sentinel->next = dmem_block_offset(heap, head);
+    dmem_tail_block(heap) = tail;
+
+    heap->size += (dmem_size_t)(end - start);
+    heap->free += dmem_block_mem_size(heap, head);
+    heap->inited_free += dmem_block_mem_size(heap, head);
+    heap->region_start[count] = (dmem_size_t)(start - (uintptr_t) heap->pool);
+    heap->region_end[count] = (dmem_size_t)(end - (uintptr_t) heap->pool);
+    dmem_atomic_store_release(&heap->region_count, count + 1);
+
+    _mark_dirty(heap, (void*) end);                 // 内存区域的内容未知
+    _free_list_insert(heap, head);
+    _update_max_usage(heap);
+    _event(heap, DMEM_EVENT_LEVEL_INFO, DMEM_EVENT_REGION_ADD, heap->region_start[count], end - start);
+    dmem_trace(DMEM_LEVEL_INFO, "Added region | Addr: %p | Size: %lu bytes | Free: %lu bytes", (void*) start, (unsigned long)(end - start), (unsigned long)heap->free);
+    return DMEM_ERR_NONE;
+}
+
+/**
+ * @brief 分配失败时通过移植层获取新的内存区域
+ * @note 该函数不具备线程安全，移植层 dmem_get_region() 在持有线程锁时调用
+ * @param heap 内存堆
+ * @param size 需要容纳的用户内存大小（对齐分配需包含对齐产生的填充）
+ * @return true 已添加新的内存区域，调用者可重试分配
+ */
+static bool _grow(dmem_heap_t heap, size_t size)
+{
+    size_t min, got = 0;
+    void* region;
+
+    /** 内存区域还需容纳首尾内存块的信息头与对齐的余量，其大小同样不能超出偏移量的范围 **/
+    if(!heap->grow_enabled || heap->region_count >= DMEM_REGION_MAX ||
+       size > (size_t) dmem_offset_max() - 2 * dmem_block_size() - 2 * DMEM_DEFINE_ALIGN_SIZE)
+        return false;
+
+    /** 首内存块与尾内存块的信息头，以及起始地址对齐的余量 **/
+    min = MAKE_ALLOC_SIZE_ALIGN(size) + 2 * dmem_block_size() + DMEM_DEFINE_ALIGN_SIZE;
+    if(min < DMEM_GROW_SIZE)
+        min = DMEM_GROW_SIZE;
+    if((region = dmem_get_region(heap, min, &got)) == NULL)
+        return false;
+    if(got < min || _add_region(heap, region, got) != DMEM_ERR_NONE)
+    {
+        dmem_put_region(heap, region, got);
+        return false;
+    }
+    return true;
+}
+#else
+    #define _grow(heap, size)       false
+#endif
+
+#if ENABLE_DMEM_HUGE
+/**
+ * ----------------------------------------------------------------------------
+ * 大内存直接映射
+ * 不小于 heap->huge_threshold 的分配请求通过移植层单独映射，映射起始处存放 struct dmem_huge，用户内存位于其后。
+ * 所有映射链接在内存堆的 huge_list 中，释放与调整大小时先确认地址不在内存池中，再沿链表查找，不会访问未知的地址。
+ * ----------------------------------------------------------------------------
+ */
+DMEM_STATIC_ASSERT(huge_page_size, (DMEM_HUGE_PAGE_SIZE & (DMEM_HUGE_PAGE_SIZE - 1)) == 0);
+
+/**
+ * @brief 直接映射的大内存信息头
+ */
+struct dmem_huge
+{
+    struct dmem_huge* prev;     /** 前一个映射 **/
+    struct dmem_huge* next;     /** 后一个映射 **/
+    size_t map_size;            /** 映射大小 **/
+    size_t offset;              /** 用户内存相对映射起始地址的偏移量 **/
+};
+
+#define dmem_huge_fits(heap, size)          ((heap)->huge_threshold != 0 && (size) >= (heap)->huge_threshold)
+#define dmem_huge_mem(huge)                 ((char*)(huge) + (huge)->offset)
+#define dmem_huge_map_size(offset, size)    (((offset) + (size) + DMEM_HUGE_PAGE_SIZE - 1) & ~(size_t)(DMEM_HUGE_PAGE_SIZE - 1))
+
+/**
+ * @brief 查找用户内存对应的映射
+ * @param heap 内存堆
+ * @param mem 用户内存地址（不在内存池中）
+ * @return struct dmem_huge* 若不是该内存堆直接映射的内存则返回 NULL
+ */
+static struct dmem_huge* _huge_find(dmem_heap_t heap, const void* mem)
+{
+    struct dmem_huge* huge;
+    for(huge = heap->huge_list; huge != NULL; huge = huge->next)
+    {
+        if(dmem_huge_mem(huge) == (const char*) mem)
+            return huge;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 为 size 字节的用户内存单独映射
+ * @param heap 内存堆
+ * @param align 用户内存的对齐大小，不超过 DMEM_HUGE_PAGE_SIZE
+ * @param size 用户内存大小
+ * @return void* 若映射失败则返回 NULL
+ */
+static void* _huge_alloc(dmem_heap_t heap, size_t align, size_t size)
+{
+    size_t offset = MAKE_ALLOC_SIZE_ALIGN(sizeof(struct dmem_huge));
+    size_t map_size;
+    struct dmem_huge* huge;
+
+    offset = (offset + align - 1) & ~(align - 1);
+    if(size > SIZE_MAX - offset - DMEM_HUGE_PAGE_SIZE)
+        return NULL;
+    map_size = dmem_huge_map_size(offset, size);
+    if((huge = (struct dmem_huge*) dmem_map_huge(heap, map_size)) == NULL)
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "Huge map failed | Size: %lu bytes", (unsigned long)map_size);
+        return NULL;
+    }
+
+    huge->prev = NULL;
+    huge->next = heap->huge_list;
+    huge->map_size = map_size;
+    huge->offset = offset;
+    if(heap->huge_list != NULL)
+        heap->huge_list->prev = huge;
+    heap->huge_list = huge;
+    heap->huge_size += map_size;
+    heap->huge_count++;
+    heap->used_count++;
+    _event(heap, DMEM_EVENT_LEVEL_INFO, DMEM_EVENT_HUGE_MAP, size, map_size);
+    dmem_trace(DMEM_LEVEL_DEBUG, "Huge mapped %lu bytes at %p | Request: %lu bytes", (unsigned long)map_size, (void*) huge, (unsigned long)size);
+    return dmem_huge_mem(huge);
+}
+
+/**
+ * @brief 解除映射
+ * @param heap 内存堆
+ * @param huge 映射
+ */
+static void _huge_free(dmem_heap_t heap, struct dmem_huge* huge)
+{
+    size_t map_size = huge->map_size;
+
+    if(huge->prev != NULL)
+        huge->prev->next = huge->next;
+    else
+        heap->huge_list = huge->next;
+    if(huge->next != NULL)
+        huge->next->prev = huge->prev;
+    heap->huge_size -= map_size;
+    heap->huge_count--;
+    heap->used_count--;
+    _event(heap, DMEM_EVENT_LEVEL_INFO, DMEM_EVENT_HUGE_UNMAP, heap->huge_count, map_size);
+    dmem_unmap_huge(heap, huge, map_size);
+}
+
+/**
+ * @brief 调整映射大小，优先由移植层原地扩展或移动映射，否则重新映射并复制数据
+ * @param heap 内存堆
+ * @param huge 映射
+ * @param size 新的用户内存大小
+ * @return void* 新的用户内存地址，失败时返回 NULL 且原映射保持不变
+ */
+static void* _huge_resize(dmem_heap_t heap, struct dmem_huge* huge, size_t size)
+{
+    size_t old_size = huge->map_size;
+    size_t map_size;
+    struct dmem_huge* moved;
+
+    if(size > SIZE_MAX - huge->offset - DMEM_HUGE_PAGE_SIZE)
+        return NULL;
+    map_size = dmem_huge_map_size(huge->offset, size);
+    if(map_size == old_size)
+        return dmem_huge_mem(huge);
+
+    if((moved = (struct dmem_huge*) dmem_remap_huge(heap, huge, old_size, map_size)) == NULL)
+    {
+        /** 按原偏移量的最低位对齐，新地址的对齐不低于原地址 **/
+        size_t keep = old_size - huge->offset;
+        char* mem = (char*) _huge_alloc(heap, huge->offset & (~huge->offset + 1), size);
+        if(mem == NULL)
+            return NULL;
+        memcpy(mem, dmem_huge_mem(huge), keep < size ? keep : size);
+        _huge_free(heap, huge);
+        return mem;
+    }
+
+    /** 映射可能已移动，链表中的前后节点需指向新的地址 **/
+    moved->map_size = map_size;
+    if(moved->prev != NULL)
+        moved->prev->next = moved;
+    else
+        heap->huge_list = moved;
+    if(moved->next != NULL)
+        moved->next->prev = moved;
+    heap->huge_size = heap->huge_size - old_size + map_size;
+    _event(heap, DMEM_EVENT_LEVEL_INFO, DMEM_EVENT_HUGE_REMAP, old_size, map_size);
+    return dmem_huge_mem(moved);
+}
+
+#if ENABLE_DMEM_ARENA
+/**
+ * @brief 检查内存是否为该内存堆直接映射的大内存，自行获取线程锁
+ * @param heap 内存堆
+ * @param mem 内存地址
+ * @return true 是该内存堆直接映射的大内存
+ */
+static bool _huge_owned(dmem_heap_t heap, const void* mem)
+{
+    bool owned;
+    dmem_get_lock(heap);
+    owned = _huge_find(heap, mem) != NULL;
+    dmem_rel_lock(heap);
+    return owned;
+}
+#endif
+#else
+    #define dmem_huge_fits(heap, size)      false
+#endif
+
+#if ENABLE_DMEM_SLAB || ENABLE_DMEM_TCACHE
+/**
+ * @brief 小对象尺寸类别，供小对象分配器与线程缓存共用
+ */
+#define DMEM_SIZE_CLASS_MIN                 8
+#define dmem_size_class(size)               (size_class_index[((size) + DMEM_SIZE_CLASS_MIN - 1) / DMEM_SIZE_CLASS_MIN])
+
+/**
+ * @brief 各尺寸类别的大小
+ */
+static const uint16_t size_class_bytes[DMEM_SIZE_CLASS_COUNT] = {8, 16, 24, 32, 48, 64, 96, 128, 192, 256};
+
+/**
+ * @brief 以 (size + 7) / 8 为下标查找尺寸类别
+ */
+static const uint8_t size_class_index[DMEM_SIZE_CLASS_MAX / DMEM_SIZE_CLASS_MIN + 1] = 
+{
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+    8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9,
+};
+#endif
+
+#if ENABLE_DMEM_SLAB
+/**
+ * ----------------------------------------------------------------------------
+ * 小对象分配器 (slab)
+ * 不超过 DMEM_SIZE_CLASS_MAX 字节的分配请求按尺寸类别划分，每个尺寸类别从若干页中分配固定大小的槽位。
+ * 页是从内存池中分配的按 DMEM_SLAB_PAGE_SIZE 对齐的内存块（带 DMEM_BLOCK_SLAB 标志），页首为页信息头，
+ * 其后为连续的槽位，空闲槽位记录在页信息头的位图中，因此小对象不需要内存块信息头。
+ * 内存堆另有一张页映射表（从内存池中分配，每页 1 字节）记录各页大小对齐的地址是否为页，
+ * 释放时将地址按页大小向下对齐并查表即可确定其是否为小对象，查表不依赖内存中的数据，因此无需持有线程锁也能安全判断。
+ * 尚有空闲槽位的页链接在对应尺寸类别的链表中，已满的页移出链表；
+ * 页内对象全部释放后，若该尺寸类别仍有其他可用页，则将该页归还内存池，否则保留以避免反复申请。
+ * ----------------------------------------------------------------------------
+ */
+#define DMEM_SLAB_BITMAP_WORDS              (DMEM_SLAB_PAGE_SIZE / DMEM_SIZE_CLASS_MIN / 32)
+
+/**
+ * @brief 页信息头，位于页的起始位置
+ */
+struct dmem_slab_page
+{
+    struct dmem_slab_page* prev;                /** 同一尺寸类别中前一个尚有空闲槽位的页 **/
+    struct dmem_slab_page* next;                /** 同一尺寸类别中后一个尚有空闲槽位的页 **/
+    uint16_t size;                              /** 槽位大小 **/
+    uint16_t cls;                               /** 尺寸类别 **/
+    uint16_t used;                              /** 已分配的槽位数量 **/
+    uint16_t count;                             /** 槽位总数 **/
+    uint32_t bitmap[DMEM_SLAB_BITMAP_WORDS];    /** 空闲槽位位图，置 1 表示空闲 **/
+};
+
+DMEM_STATIC_ASSERT(slab_page_size, DMEM_SLAB_PAGE_SIZE >= 512 && DMEM_SLAB_PAGE_SIZE <= 65536 && 
+                                   (DMEM_SLAB_PAGE_SIZE & (DMEM_SLAB_PAGE_SIZE - 1)) == 0);
+DMEM_STATIC_ASSERT(slab_align, DMEM_DEFINE_ALIGN_SIZE <= DMEM_SIZE_CLASS_MIN);     // 尺寸类别均为 8 的倍数
+
+#define dmem_slab_header_size()             MAKE_ALLOC_SIZE_ALIGN(sizeof(struct dmem_slab_page))
+#define dmem_slab_fits(heap, size)          ((heap)->slab_enabled && (size) != 0 && (size) <= DMEM_SIZE_CLASS_MAX)
+#define dmem_slab_map_index(heap, addr)     ((dmem_size_t)(((char*)(addr) - (heap)->slab_map_base) / DMEM_SLAB_PAGE_SIZE))
+
+/**
+ * @brief 查找最低有效位
+ * @param x 非 0 值
+ * @return int 最低有效位的位序
+ */
+static int _slab_ffs(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(x);
+#else
+    int bit = 0;
+    while(!(x & 1))
+    {
+        x >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * @brief 将页加入尺寸类别的链表头
+ * @param heap 内存堆
+ * @param page 页
+ */
+static void _slab_link(dmem_heap_t heap, struct dmem_slab_page* page)
+{
+    page->prev = NULL;
+    page->next = heap->slab_partial[page->cls];
+    if(page->next)
+        page->next->prev = page;
+    heap->slab_partial[page->cls] = page;
+}
+
+/**
+ * @brief 将页移出尺寸类别的链表
+ * @param heap 内存堆
+ * @param page 页
+ */
+static void _slab_unlink(dmem_heap_t heap, struct dmem_slab_page* page)
+{
+    if(page->prev)
+        page->prev->next = page->next;
+    else
+        heap->slab_partial[page->cls] = page->next;
+    if(page->next)
+        page->next->prev = page->prev;
+    page->prev = page->next = NULL;
+}
+
+/**
+ * @brief 从内存池中分配页映射表，覆盖内存池中所有按页大小对齐的地址
+ * @param heap 内存堆
+ * @return true 分配成功
+ * @return false 内存池空间不足
+ */
+static bool _slab_map_create(dmem_heap_t heap)
+{
+    uintptr_t base = ((uintptr_t) dmem_pool_at(heap, dmem_block_size()) + DMEM_SLAB_PAGE_SIZE - 1) & ~(uintptr_t)(DMEM_SLAB_PAGE_SIZE - 1);
+#if ENABLE_DMEM_GROW
+    uintptr_t end = (uintptr_t) dmem_pool_at(heap, heap->region_end[0]);      // 页映射表只覆盖初始化时的内存池
+#else
+    uintptr_t end = (uintptr_t) dmem_pool_at(heap, dmem_pool_size(heap));
+#endif
+    dmem_size_t len = base < end ? (dmem_size_t)((end - base) / DMEM_SLAB_PAGE_SIZE) : 0;
+    uint8_t* map;
+
+    if(len == 0 || (map = (uint8_t*) _alloc(heap, len)) == NULL)
+        return false;
+    memset(map, 0, len);
+    heap->slab_map_base = (char*) base;
+    heap->slab_map_len = len;
+    /** 线程缓存无锁读取页映射表，须在表的内容与范围写入后再发布 **/
+    dmem_atomic_store_release(&heap->slab_map, map);
+    return true;
+}
+
+/**
+ * @brief 从内存池中申请新的页
+ * @param heap 内存堆
+ * @param cls 尺寸类别
+ * @return struct dmem_slab_page* 若内存池空间不足则返回 NULL
+ */
+static struct dmem_slab_page* _slab_page_new(dmem_heap_t heap, int cls)
+{
+    struct dmem_slab_page* page = (struct dmem_slab_page*) _alloc_aligned(heap, DMEM_SLAB_PAGE_SIZE, DMEM_SLAB_PAGE_SIZE);
+    uint32_t i;
+
+    if(page == NULL)
+        return NULL;
+#if ENABLE_DMEM_GROW
+    /** 之后添加的内存区域不在页映射表的范围内，其中的页无法被识别 **/
+    if((char*) page < heap->slab_map_base || dmem_slab_map_index(heap, page) >= heap->slab_map_len)
+    {
+        _free(heap, page);
+        return NULL;
+    }
+#endif
+    dmem_block_entry(page)->used |= DMEM_BLOCK_SLAB;
+
+    page->size = size_class_bytes[cls];
+    page->cls = (uint16_t) cls;
+    page->used = 0;
+    page->count = (uint16_t)((DMEM_SLAB_PAGE_SIZE - dmem_slab_header_size()) / page->size);
+    for(i = 0; i < DMEM_SLAB_BITMAP_WORDS; i++)
+    {
+        if((i + 1) * 32 <= page->count)
+            page->bitmap[i] = ~(uint32_t) 0;
+        else if(i * 32 < page->count)
+            page->bitmap[i] = ((uint32_t) 1 << (page->count - i * 32)) - 1;
+        else
+            page->bitmap[i] = 0;
+    }
+    _slab_link(heap, page);
+    heap->slab_map[dmem_slab_map_index(heap, page)] = 1;
+    heap->slab_pages++;
+
+    _event(heap, DMEM_EVENT_LEVEL_DEBUG, DMEM_EVENT_SLAB_NEW, dmem_event_offset(heap, page), page->size);
+    dmem_trace(DMEM_LEVEL_DEBUG, "New slab page %p | Class: %u bytes | Slots: %u", page, page->size, page->count);
+    return page;
+}
+
+/**
+ * @brief 将页归还内存池
+ * @param heap 内存堆
+ * @param page 已移出链表且没有已分配槽位的页
+ */
+static void _slab_page_release(dmem_heap_t heap, struct dmem_slab_page* page)
+{
+    _event(heap, DMEM_EVENT_LEVEL_DEBUG, DMEM_EVENT_SLAB_RELEASE, dmem_event_offset(heap, page), page->size);
+    dmem_trace(DMEM_LEVEL_DEBUG, "Release slab page %p | Class: %u bytes", page, page->size);
+    dmem_block_entry(page)->used &= ~DMEM_BLOCK_SLAB;
+    heap->slab_map[dmem_slab_map_index(heap, page)] = 0;
+    heap->slab_pages--;
+    _free(heap, page);
+}
+
+/**
+ * @brief 小对象分配器关闭且所有的页都已归还时，将页映射表归还内存池
+ * @note 线程缓存开启过的内存堆保留页映射表，因其他线程可能正在无锁读取
+ * @param heap 内存堆
+ */
+static void _slab_map_release(dmem_heap_t heap)
+{
+#if ENABLE_DMEM_TCACHE
+    if(heap->tcache_used)
+        return;
+#endif
+    if(heap->slab_pages == 0 && heap->slab_map != NULL)
+    {
+        _free(heap, heap->slab_map);
+        heap->slab_map = NULL;
+    }
+}
+
+/**
+ * @brief 查找内存地址所属的页
+ * @param heap 内存堆
+ * @param mem 内存地址
+ * @return struct dmem_slab_page* 若 mem 不属于任何页则返回 NULL
+ */
+static struct dmem_slab_page* _slab_page_of(dmem_heap_t heap, void* mem)
+{
+    uint8_t* map = dmem_atomic_load_acquire(&heap->slab_map);
+    dmem_size_t index;
+
+    if(map == NULL || (char*) mem <= heap->slab_map_base)
+        return NULL;
+    index = dmem_slab_map_index(heap, mem);
+    if(index >= heap->slab_map_len || !map[index])
+        return NULL;
+
+    /** 页的起始地址为页信息头，不是小对象 **/
+    if((char*) mem == heap->slab_map_base + (size_t) index * DMEM_SLAB_PAGE_SIZE)
+        return NULL;
+    return (struct dmem_slab_page*)(heap->slab_map_base + (size_t) index * DMEM_SLAB_PAGE_SIZE);
+}
+
+/**
+ * @brief 从尺寸类别中分配小对象
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param size 内存大小，不超过 DMEM_SIZE_CLASS_MAX
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+static void* _slab_alloc(dmem_heap_t heap, size_t size)
+{
+    int cls = dmem_size_class(size);
+    struct dmem_slab_page* page = heap->slab_partial[cls];
+    uint32_t i = 0;
+    uint32_t bit;
+
+    if(page == NULL && (page = _slab_page_new(heap, cls)) == NULL)
+        return NULL;
+
+    while(page->bitmap[i] == 0)
+        i++;
+    bit = (uint32_t) _slab_ffs(page->bitmap[i]);
+    page->bitmap[i] &= ~((uint32_t) 1 << bit);
+
+    /** 页已满，移出链表 **/
+    if(++page->used == page->count)
+        _slab_unlink(heap, page);
+    heap->slab_objects++;
+
+    return (char*) page + dmem_slab_header_size() + (i * 32 + bit) * page->size;
+}
+
+/**
+ * @brief 释放小对象
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param page 小对象所属的页
+ * @param mem 待释放的内存地址
+ * @return int  - DMEM_ERR_NONE           : 释放成功
+ *              - DMEM_FREE_INVALID_MEM   : mem 不是槽位的起始地址
+ *              - DMEM_FREE_REPEATED      : 该槽位不可重复释放
+ */
+static int _slab_free(dmem_heap_t heap, struct dmem_slab_page* page, void* mem)
+{
+    size_t offset = (size_t)((char*) mem - (char*) page);
+    size_t index;
+
+    if(offset < dmem_slab_header_size() || (offset - dmem_slab_header_size()) % page->size != 0 ||
+       (index = (offset - dmem_slab_header_size()) / page->size) >= page->count)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Invalid slab object | Addr: %p | Page: %p", mem, page);
+        _event(heap, DMEM_EVENT_LEVEL_ERROR, DMEM_EVENT_FREE_ERROR, dmem_event_offset(heap, mem), -DMEM_FREE_INVALID_MEM);
+        return DMEM_FREE_INVALID_MEM;
+    }
+    if(page->bitmap[index / 32] & ((uint32_t) 1 << (index % 32)))
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Double free detected | Addr: %p | Page: %p", mem, page);
+        _event(heap, DMEM_EVENT_LEVEL_ERROR, DMEM_EVENT_FREE_ERROR, dmem_event_offset(heap, mem), -DMEM_FREE_REPEATED);
+        return DMEM_FREE_REPEATED;
+    }
+
+    page->bitmap[index / 32] |= (uint32_t) 1 << (index % 32);
+    if(page->used-- == page->count)
+        _slab_link(heap, page);
+    heap->slab_objects--;
+
+    /** 页已空且尺寸类别中还有其他可用页（或小对象分配器已关闭），则将该页归还内存池 **/
+    if(page->used == 0 && (!heap->slab_enabled || page->prev != NULL || page->next != NULL))
+    {
+        _slab_unlink(heap, page);
+        _slab_page_release(heap, page);
+        if(!heap->slab_enabled)
+            _slab_map_release(heap);
+    }
+    return DMEM_ERR_NONE;
+}
+#endif
+
+#if ENABLE_DMEM_TCACHE || ENABLE_DMEM_ARENA
+/**
+ * @brief 获取已分配内存的实际可用大小
+ * @note 该函数不具备线程安全；带标签的内存块也返回 0，使其不进入线程缓存、不在分区之间迁移，始终在所属内存堆中释放并更新标签统计
+ * @param heap 内存堆
+ * @param mem 已分配的内存地址
+ * @return dmem_size_t 若 mem 不是有效的已分配内存则返回 0
+ */
+static dmem_size_t _usable_size(dmem_heap_t heap, void* mem)
+{
+    dmem_block_t block = dmem_block_entry(mem);
+#if ENABLE_DMEM_SLAB
+    struct dmem_slab_page* page = _slab_page_of(heap, mem);
+    if(page != NULL)
+        return page->size;
+#endif
+    if(!dmem_mem_in_pool(heap, mem) || !dmem_block_is_valid(block) || 
+       (block->used & (DMEM_BLOCK_USED | DMEM_BLOCK_SLAB | DMEM_BLOCK_MOVABLE)) != DMEM_BLOCK_USED || dmem_block_tag(block) != 0)
+        return 0;
+    return dmem_block_mem_size(heap, block);
+}
+#endif
+
+/**
+ * @brief 分配内存，小对象优先由小对象分配器分配
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param size 待分配的内存的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+static void* _heap_alloc(dmem_heap_t heap, size_t size)
+{
+    void* p = NULL;
+#if ENABLE_DMEM_SLAB
+    if(dmem_slab_fits(heap, size))
+        p = _slab_alloc(heap, size);
+#endif
+#if ENABLE_DMEM_HUGE
+    if(dmem_huge_fits(heap, size))
+        p = _huge_alloc(heap, DMEM_DEFINE_ALIGN_SIZE, size);
+#endif
+    if(p == NULL)
+        p = _alloc(heap, size);
+    if(p == NULL && size != 0 && _grow(heap, size))
+        p = _alloc(heap, size);
+
+    /** 累计计数，线程缓存命中的请求不经过内存堆，不计入 **/
+    if(p != NULL)
+        heap->alloc_count++;
+    else if(size != 0)
+        heap->fail_count++;
+    return p;
+}
+
+/**
+ * @brief 释放内存，小对象交由小对象分配器释放
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param mem 待释放的内存地址
+ * @return int 参考 _free()
+ */
+static int _heap_free(dmem_heap_t heap, void* mem)
+{
+    int res;
+#if ENABLE_DMEM_HUGE
+    struct dmem_huge* huge = (mem && !dmem_mem_in_pool(heap, mem)) ? _huge_find(heap, mem) : NULL;
+#endif
+#if ENABLE_DMEM_SLAB
+    struct dmem_slab_page* page = mem ? _slab_page_of(heap, mem) : NULL;
+#endif
+#if ENABLE_DMEM_HUGE
+    if(huge != NULL)
+    {
+        _huge_free(heap, huge);
+        res = DMEM_ERR_NONE;
+    }
+    else
+#endif
+#if ENABLE_DMEM_SLAB
+    if(page != NULL)
+        res = _slab_free(heap, page, mem);
+    else
+#endif
+    res = _free(heap, mem);
+
+    if(res == DMEM_ERR_NONE)
+        heap->free_count++;
+    return res;
+}
+
+#if ENABLE_DMEM_TAG
+/**
+ * ----------------------------------------------------------------------------
+ * 带标签的分配 (tag)
+ * 标签记录在内存块使用标志位与内部浪费之间的 DMEM_TAG_BITS 位中，不占用额外的空间，
+ * 内存堆为每个标签维护存活字节数、存活数量、峰值与累计分配次数，分配、调整大小与释放时随之更新。
+ * 带标签的内存块只从内存池分配，不经过小对象分配器、大内存直接映射与线程缓存，调整大小时也留在内存池中，
+ * 因此任何释放路径都会经过 _free() 并移出标签统计。
+ * ----------------------------------------------------------------------------
+ */
+#define dmem_tag_is_valid(tag)              ((tag) != 0 && (tag) < DMEM_TAG_COUNT)
+#define dmem_tag_over_limit(live, limit, size) \
+        ((limit) != 0 && ((live) > (limit) || (size) > (limit) - (live)))
+
+/**
+ * @brief 为即将分配的带标签内存预留预算
+ * @note 属于多分区内存堆的分区先在共享预算中原子地预留 size，其他分区同时分配时不会共同超出预算；
+ *       预算充足时，内存块计入统计后需调用 _tag_unreserve() 撤销预留
+ * @param heap 内存堆
+ * @param tag 标签
+ * @param size 需要分配的内存的大小
+ * @return true 预算充足
+ * @return false 超出预算
+ */
+static bool _tag_reserve(dmem_heap_t heap, uint8_t tag, size_t size)
+{
+    struct dmem_tag_budget* tb = heap->tag_budget;
+    dmem_size_t amount = size > dmem_offset_max() ? dmem_offset_max() : (dmem_size_t) size;
+    dmem_size_t limit, live;
+
+    if(tb == NULL)
+        return !dmem_tag_over_limit(heap->tags[tag].live_bytes, heap->tags[tag].limit, amount);
+    limit = dmem_atomic_load(&tb->limit[tag]);
+    live = dmem_atomic_fetch_add(&tb->live_bytes[tag], amount);
+    if(dmem_tag_over_limit(live, limit, amount))
+    {
+        dmem_atomic_fetch_sub(&tb->live_bytes[tag], amount);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 撤销 _tag_reserve() 在共享预算中的预留
+ * @param heap 内存堆
+ * @param tag 标签
+ * @param size 预留时的大小
+ */
+static void _tag_unreserve(dmem_heap_t heap, uint8_t tag, size_t size)
+{
+    if(heap->tag_budget != NULL)
+        dmem_atomic_fetch_sub(&heap->tag_budget->live_bytes[tag], size > dmem_offset_max() ? dmem_offset_max() : (dmem_size_t) size);
+}
+
+/**
+ * @brief 从内存池中分配带标签的内存，超出标签的预算时失败
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param size 需要分配的内存的大小
+ * @param tag 标签，不为 0
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+static void* _tag_alloc(dmem_heap_t heap, size_t size, uint8_t tag)
+{
+    struct dmem_tag_stats* ts = &heap->tags[tag];
+    void* p = NULL;
+
+    if(size == 0)
+        return NULL;
+    if(_tag_reserve(heap, tag, size))
+    {
+        p = _alloc(heap, size);
+        if(p == NULL && _grow(heap, size))
+            p = _alloc(heap, size);
+        if(p != NULL)
+            _tag_attach(heap, dmem_block_entry(p), tag);
+        _tag_unreserve(heap, tag, size);
+    }
+    else
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "Tag %u over budget | Requested: %lu bytes | Live: %lu bytes", (unsigned) tag, (unsigned long)size, (unsigned long)ts->live_bytes);
+    }
+
+    if(p != NULL)
+    {
+        ts->alloc_count++;
+        ts->alloc_bytes += size;
+        heap->alloc_count++;
+    }
+    else
+    {
+        ts->fail_count++;
+        heap->fail_count++;
+    }
+    return p;
+}
+
+/**
+ * @brief 调整内存池中已分配内存块的大小，结果以 tag 重新计入标签统计
+ * @note 该函数不具备线程安全，流程与 _heap_realloc() 相同，但迁移时只从内存池中分配。
+ *       扩展超出标签的预算或分配失败时保留原内存块
+ * @param heap 内存堆
+ * @param old_mem 旧的被分配的内存，必须是内存池中有效的已分配内存块
+ * @param new_size 对齐后的新内存大小
+ * @param request 用户请求的内存大小
+ * @param tag 标签，不为 0
+ * @return void* 新的内存地址，扩展失败时返回 old_mem
+ */
+static void* _tag_realloc(dmem_heap_t heap, void* old_mem, size_t new_size, size_t request, uint8_t tag)
+{
+    struct dmem_tag_stats* ts = &heap->tags[tag];
+    dmem_block_t block = dmem_block_entry(old_mem);
+    dmem_size_t old_size = dmem_block_mem_size(heap, block);
+    dmem_block_t moved;
+    void* new_mem = old_mem;
+    bool reserved = false;
+
+    _tag_detach(heap, block);
+    if(new_size <= old_size)
+    {
+        if(new_size < old_size)
+            _split(heap, block, new_size);
+        _block_set_slack(heap, block, request);
+    }
+    else if(!(reserved = _tag_reserve(heap, tag, new_size)))
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "Tag %u over budget, keeping original block", (unsigned) tag);
+        ts->fail_count++;
+    }
+    else if(_expand_inplace(heap, block, new_size))
+        _block_set_slack(heap, block, request);
+    else if((moved = _expand_backward(heap, block, new_size)) != NULL)
+    {
+        _block_set_slack(heap, moved, request);
+        new_mem = dmem_block_mem_addr(moved);
+    }
+    else if((new_mem = _alloc(heap, request)) != NULL || (_grow(heap, request) && (new_mem = _alloc(heap, request)) != NULL))
+    {
+        memmove(new_mem, old_mem, old_size);
+        _free(heap, old_mem);
+        heap->alloc_count++;
+        heap->free_count++;
+    }
+    else
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "Realloc failed, keeping original block");
+        new_mem = old_mem;
+        ts->fail_count++;
+        heap->fail_count++;
+    }
+    _tag_attach(heap, dmem_block_entry(new_mem), tag);
+    if(reserved)
+        _tag_unreserve(heap, tag, new_size);
+    return new_mem;
+}
+
+/**
+ * @brief 获取不在内存池内存块中的已分配内存（小对象或直接映射的大内存）的可用大小
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param mem 已分配的内存地址
+ * @return size_t 可用大小，mem 位于内存池的内存块中时返回 0
+ */
+static size_t _tag_foreign_size(dmem_heap_t heap, void* mem)
+{
+#if ENABLE_DMEM_HUGE
+    struct dmem_huge* huge = dmem_mem_in_pool(heap, mem) ? NULL : _huge_find(heap, mem);
+    if(huge != NULL)
+        return huge->map_size - huge->offset;
+#endif
+#if ENABLE_DMEM_SLAB
+    struct dmem_slab_page* page = _slab_page_of(heap, mem);
+    if(page != NULL)
+        return page->size;
+#endif
+    (void) heap;
+    (void) mem;
+    return 0;
+}
+
+/**
+ * @brief 从内存堆中分配带标签的内存，分配的内存计入标签的使用统计
+ * @note 与 dmem_heap_alloc() 分配的内存一样使用 dmem_heap_free()/dmem_heap_realloc() 释放与调整大小，
+ *       dmem_heap_realloc() 保留原标签。标签超出预算（按请求大小检查）时分配失败
+ * @param heap 内存堆
+ * @param size 需要分配的内存的大小
+ * @param tag 标签，1 ~ DMEM_TAG_COUNT - 1，为 0 时等同于 dmem_heap_alloc()
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_heap_alloc_tagged(dmem_heap_t heap, size_t size, uint8_t tag)
+{
+    void* p;
+
+    if(tag == 0)
+        return dmem_heap_alloc(heap, size);
+    if(tag >= DMEM_TAG_COUNT)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Tag is invalid: %u", (unsigned) tag);
+        return NULL;
+    }
+    dmem_get_lock(heap);
+    p = _tag_alloc(heap, size, tag);
+    _record(heap, DMEM_RECORD_ALLOC, size, 0, p, NULL);
+    _heap_unlock(heap);
+    return p;
+}
+
+/**
+ * @brief 从内存堆中分配指定大小和数量的带标签的连续空间，并自动将已分配的内存初始化为 0
+ * @param heap 内存堆
+ * @param count 对象的数量
+ * @param size 对象的大小
+ * @param tag 标签，参考 dmem_heap_alloc_tagged()
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_heap_calloc_tagged(dmem_heap_t heap, size_t count, size_t size, uint8_t tag)
+{
+    size_t total = count * size;
+    size_t zero;
+    struct dmem_zero_mark mark;
+    void* p;
+
+    if(tag == 0)
+        return dmem_heap_calloc(heap, count, size);
+    if(tag >= DMEM_TAG_COUNT)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Tag is invalid: %u", (unsigned) tag);
+        return NULL;
+    }
+    if(size != 0 && count > SIZE_MAX / size)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Calloc size overflow | Count: %lu | Size: %lu", (unsigned long)count, (unsigned long)size);
+        return NULL;
+    }
+    dmem_get_lock(heap);
+    _zero_mark(heap, &mark);
+    p = _tag_alloc(heap, total, tag);
+    zero = _zero_size(heap, &mark, p, total);
+    _record(heap, DMEM_RECORD_ALLOC, total, 0, p, NULL);
+    _heap_unlock(heap);
+
+    /** 与 dmem_heap_calloc() 相同，只清零可能被写入过的部分 **/
+    if(zero)
+        memset(p, 0, zero);
+    return p;
+}
+
+/**
+ * @brief 重新分配内存，并将结果以 tag 计入标签的使用统计
+ * @note old_mem 原有的标签（如有）被 tag 替换；old_mem 为小对象或直接映射的大内存时迁移到内存池中新的带标签内存块
+ * @param heap 内存堆
+ * @param old_mem 旧的被分配的内存，为 NULL 时等同于 dmem_heap_alloc_tagged()
+ * @param new_size 新的被指定的内存大小，为 0 时释放 old_mem
+ * @param tag 标签，1 ~ DMEM_TAG_COUNT - 1，为 0 时等同于 dmem_heap_realloc()
+ * @return void* 新的内存地址，扩展失败时返回 old_mem，old_mem 无效时返回 NULL
+ */
+void* dmem_heap_realloc_tagged(dmem_heap_t heap, void* old_mem, size_t new_size, uint8_t tag)
+{
+    size_t request = new_size;
+    dmem_block_t block = dmem_block_entry(old_mem);
+    size_t foreign;
+    void* new_mem;
+
+    if(tag == 0)
+        return dmem_heap_realloc(heap, old_mem, new_size);
+    if(old_mem == NULL)
+        return dmem_heap_alloc_tagged(heap, new_size, tag);
+    if(new_size == 0)
+    {
+        dmem_heap_free(heap, old_mem);
+        return NULL;
+    }
+    if(tag >= DMEM_TAG_COUNT)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Tag is invalid: %u", (unsigned) tag);
+        return NULL;
+    }
+    if(new_size > dmem_offset_max() - DMEM_DEFINE_ALIGN_SIZE)
+        return old_mem;
+    new_size = MAKE_ALLOC_SIZE_ALIGN(new_size);
+    if(new_size < dmem_min_alloc_size())
+        new_size = dmem_min_alloc_size();
+
+    dmem_get_lock(heap);
+    if((foreign = _tag_foreign_size(heap, old_mem)) != 0)
+    {
+        /** 小对象与直接映射的大内存没有可记录标签的内存块信息，迁移到内存池中 **/
+        if((new_mem = _tag_alloc(heap, request, tag)) != NULL)
+        {
+            memcpy(new_mem, old_mem, foreign < request ? foreign : request);
+            _heap_free(heap, old_mem);
+        }
+        else
+            new_mem = old_mem;
+    }
+    else if(dmem_mem_in_pool(heap, old_mem) && dmem_block_is_valid(block) &&
+            (block->used & (DMEM_BLOCK_USED | DMEM_BLOCK_SLAB | DMEM_BLOCK_MOVABLE)) == DMEM_BLOCK_USED)
+        new_mem = _tag_realloc(heap, old_mem, new_size, request, tag);
+    else
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Old memory is invalid!");
+        new_mem = NULL;
+    }
+    _record(heap, DMEM_RECORD_REALLOC, request, 0, new_mem, old_mem);
+    _heap_unlock(heap);
+    return new_mem;
+}
+
+/**
+ * @brief 获取已分配内存的标签
+ * @param heap 内存堆
+ * @param mem 已分配的内存地址
+ * @return int 标签，未标记或不是内存池中有效的已分配内存时返回 0
+ */
+int dmem_heap_tag_of(dmem_heap_t heap, const void* mem)
+{
+    dmem_block_t block = dmem_block_entry(mem);
+    int tag = 0;
+
+    if(mem == NULL)
+        return 0;
+    dmem_get_lock(heap);
+    if(dmem_mem_in_pool(heap, mem) && _tag_foreign_size(heap, (void*) mem) == 0 &&
+       dmem_block_is_valid(block) && (block->used & DMEM_BLOCK_USED))
+        tag = dmem_block_tag(block);
+    dmem_rel_lock(heap);
+    return tag;
+}
+
+/**
+ * @brief 设置标签的预算
+ * @note 1. 预算只限制之后的分配与扩展，已超出预算的存活内存不受影响
+ *       2. 多分区内存堆的分区共享同一预算，设置任一分区即设置整个多分区内存堆的预算，参考 dmem_arenas_tag_set_limit()
+ * @param heap 内存堆
+ * @param tag 标签
+ * @param limit 预算，单位：字节，为 0 时不限制
+ * @return int  - DMEM_ERR_NONE           : 设置成功
+ *              - DMEM_TAG_INVALID        : 标签无效
+ */
+int dmem_heap_tag_set_limit(dmem_heap_t heap, uint8_t tag, size_t limit)
+{
+    dmem_size_t value = limit > dmem_offset_max() ? dmem_offset_max() : (dmem_size_t) limit;
+
+    if(!dmem_tag_is_valid(tag))
+        return DMEM_TAG_INVALID;
+    if(heap->tag_budget != NULL)
+    {
+        dmem_atomic_store(&heap->tag_budget->limit[tag], value);
+        return DMEM_ERR_NONE;
+    }
+    dmem_get_lock(heap);
+    heap->tags[tag].limit = value;
+    dmem_rel_lock(heap);
+    return DMEM_ERR_NONE;
+}
+
+/**
+ * @brief 读取标签的使用统计
+ * @param heap 内存堆
+ * @param tag 标签
+ * @param result 用于返回统计结果
+ * @return int  - DMEM_ERR_NONE           : 读取成功
+ *              - DMEM_TAG_INVALID        : 标签无效
+ */
+int dmem_heap_tag_stats(dmem_heap_t heap, uint8_t tag, struct dmem_tag_stats* result)
+{
+    if(!dmem_tag_is_valid(tag))
+        return DMEM_TAG_INVALID;
+    dmem_get_lock(heap);
+    *result = heap->tags[tag];
+    if(heap->tag_budget != NULL)
+        result->limit = dmem_atomic_load(&heap->tag_budget->limit[tag]);
+    dmem_rel_lock(heap);
+    return DMEM_ERR_NONE;
+}
+#endif
+
+#if ENABLE_DMEM_GROW
+/**
+ * @brief 批量分配时扩展内存堆，按剩余数量申请，失败时退回只容纳一个内存
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param size 每个内存对齐后的大小
+ * @param step 每个内存占用的空间，即 size 加上内存块信息头
+ * @param left 剩余需要分配的数量
+ * @return true 已添加新的内存区域
+ */
+static bool _batch_grow(dmem_heap_t heap, size_t size, size_t step, size_t left)
+{
+    /** 数量过多时以偏移量可表示的最大值为上限，避免乘积溢出 **/
+    size_t want = left > dmem_offset_max() / step ? dmem_offset_max() / step * step : left * step;
+
+    return _grow(heap, want) || (want > size && _grow(heap, size));
+}
+#else
+    #define _batch_grow(heap, size, step, left)     false
+#endif
+
+/**
+ * @brief 批量分配 n 个相同大小的内存，每找到一个空闲内存块就从中连续切分尽可能多的内存
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param size 每个内存的大小
+ * @param n 需要分配的数量
+ * @param ptrs 用于返回内存地址的数组
+ * @return size_t 实际分配的数量，空间不足时小于 n
+ */
+static size_t _alloc_batch(dmem_heap_t heap, size_t size, size_t n, void* ptrs[])
+{
+    size_t count = 0;
+    size_t request = size;
+    size_t step;
+    dmem_block_t pos;
+
+#if ENABLE_DMEM_HUGE
+    if(dmem_huge_fits(heap, size))
+    {
+        /** 大内存各自单独映射，逐个分配 **/
+        while(count < n && (ptrs[count] = _heap_alloc(heap, size)) != NULL)
+            count++;
+        return count;
+    }
+#endif
+#if ENABLE_DMEM_SLAB
+    if(dmem_slab_fits(heap, size))
+    {
+        /** 小对象分配本身即为常数时间，逐个分配即可 **/
+        while(count < n && (ptrs[count] = _heap_alloc(heap, size)) != NULL)
+            count++;
+        return count;
+    }
+#endif
+    if(size == 0 || size > dmem_pool_size(heap))
+    {
+        heap->fail_count += (n != 0 && size != 0);
+        return 0;
+    }
+    if(!IS_DMEM_VAR_ALIGNED(size, DMEM_DEFINE_ALIGN_SIZE))
+        size = MAKE_ALLOC_SIZE_ALIGN(size);
+    if(size < dmem_min_alloc_size())
+        size = dmem_min_alloc_size();
+    step = size + dmem_block_size();
+
+    while(count < n && ((pos = _search(heap, (dmem_size_t) size)) != NULL ||
+                        (_batch_grow(heap, size, step, n - count) && (pos = _search(heap, (dmem_size_t) size)) != NULL)))
+    {
+        _free_list_remove(heap, pos);
+        heap->free -= dmem_block_mem_size(heap, pos);
+
+        /** 剩余空间还能容纳一个内存时，直接在其后切分，无需放回空闲链表再查找 **/
+        while(count + 1 < n && dmem_block_mem_size(heap, pos) >= size + step)
+        {
+            dmem_block_t next = _insert_block_after(heap, pos, (dmem_size_t) size);
+            pos->used = DMEM_BLOCK_USED;
+            heap->used_count++;
+            _block_set_slack(heap, pos, request);
+            _event(heap, DMEM_EVENT_LEVEL_INFO, DMEM_EVENT_ALLOC, dmem_block_offset(heap, pos), dmem_block_mem_size(heap, pos));
+            ptrs[count++] = dmem_block_mem_addr(pos);
+            pos = next;
+        }
+        ptrs[count++] = _alloc_block(heap, pos, (dmem_size_t) size, request);
+    }
+    heap->alloc_count += (uint32_t) count;
+    heap->fail_count += (count < n);
+
+    dmem_trace(DMEM_LEVEL_DEBUG, "Batch allocated %lu/%lu blocks of %lu bytes", (unsigned long)count, (unsigned long)n, (unsigned long)size);
+    return count;
+}
+
+/**
+ * @brief 批量释放内存：先将所有内存块标记为待释放，再逐段合并相邻的空闲内存块，每段只插入一次空闲链表
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param ptrs 待释放的内存地址数组，NULL 将被忽略
+ * @param n 数组长度
+ * @param owned_only 为 true 时忽略不属于该内存堆的地址
+ * @return int  - DMEM_ERR_NONE           : 全部释放成功
+ *              - 其余参考 _free()，为遇到的第一个错误，其余有效的内存仍会被释放
+ */
+static int _free_batch(dmem_heap_t heap, void* const ptrs[], size_t n, bool owned_only)
+{
+    int res = DMEM_ERR_NONE;
+    size_t i;
+
+    /** [1] 校验并标记待释放的内存块，待释放的内存块视为空闲但尚未加入空闲链表 **/
+    for(i = 0; i < n; i++)
+    {
+        void* mem = ptrs[i];
+        dmem_block_t block;
+
+        if(mem == NULL)
+            continue;
+#if ENABLE_DMEM_HUGE
+        {
+            /** 直接映射的大内存与内存块链表无关，立即解除映射 **/
+            struct dmem_huge* huge = dmem_mem_in_pool(heap, mem) ? NULL : _huge_find(heap, mem);
+            if(huge != NULL)
+            {
+                _huge_free(heap, huge);
+                heap->free_count++;
+                _record(heap, DMEM_RECORD_FREE, 0, 0, mem, NULL);
+                continue;
+            }
+        }
+#endif
+        if(owned_only && !dmem_mem_in_pool(heap, mem))
+            continue;
+#if ENABLE_DMEM_SLAB
+        if(_slab_page_of(heap, mem) != NULL)
+            continue;           // 小对象最后释放，归还空页时需要空闲链表处于一致状态
+#endif
+        block = dmem_block_entry(mem);
+        if(!dmem_mem_in_pool(heap, mem) || !dmem_block_is_valid(block) || (block->used & (DMEM_BLOCK_SLAB | DMEM_BLOCK_MOVABLE)))
+        {
+            dmem_trace(DMEM_LEVEL_ERROR, "Block is invalid | Addr: %p", mem);
+            _event(heap, DMEM_EVENT_LEVEL_ERROR, DMEM_EVENT_FREE_ERROR, dmem_event_offset(heap, mem), -DMEM_FREE_INVALID_MEM);
+            if(res == DMEM_ERR_NONE)
+                res = DMEM_FREE_INVALID_MEM;
+            continue;
+        }
+        if(!(block->used & DMEM_BLOCK_USED))
+        {
+            dmem_trace(DMEM_LEVEL_ERROR, "Double free detected | Addr: %p | Block: %p", mem, block);
+            _event(heap, DMEM_EVENT_LEVEL_ERROR, DMEM_EVENT_FREE_ERROR, dmem_event_offset(heap, mem), -DMEM_FREE_REPEATED);
+            if(res == DMEM_ERR_NONE)
+                res = DMEM_FREE_REPEATED;
+            continue;
+        }
+        _tag_detach(heap, block);
+        heap->waste -= dmem_block_slack(block);
+        block->used = DMEM_BLOCK_PENDING;
+        heap->used_count--;
+        heap->free_count++;
+        heap->free += dmem_block_mem_size(heap, block);
+        _event(heap, DMEM_EVENT_LEVEL_INFO, DMEM_EVENT_FREE, dmem_block_offset(heap, block), dmem_block_mem_size(heap, block));
+        _record(heap, DMEM_RECORD_FREE, 0, 0, mem, NULL);
+    }
+
+    /** [2] 从每个仍待处理的内存块回溯到所在空闲段的起点，向后合并整段后插入空闲链表 **/
+    for(i = 0; i < n; i++)
+    {
+        dmem_block_t start, next;
+
+        if(ptrs[i] == NULL || !dmem_mem_in_pool(heap, ptrs[i]))
+            continue;
+#if ENABLE_DMEM_SLAB
+        if(_slab_page_of(heap, ptrs[i]) != NULL)
+            continue;
+#endif
+        start = dmem_block_entry(ptrs[i]);
+        if(!dmem_block_is_valid(start) || start->used != DMEM_BLOCK_PENDING)
+            continue;           // 无效、小对象或已被合并到其他空闲段
+
+        while(start != dmem_head_block(heap) && dmem_block_is_unused(dmem_block_prev(heap, start)))
+            start = dmem_block_prev(heap, start);
+        if(start->used != DMEM_BLOCK_PENDING)
+            _free_list_remove(heap, start);
+        start->used = 0;
+
+        while(dmem_block_is_unused(next = dmem_block_next(heap, start)))
+        {
+            if(next->used != DMEM_BLOCK_PENDING)
+                _free_list_remove(heap, next);
+            next->used = 0;
+            _merge_free_blocks(heap, start, next);
+        }
+        _free_list_insert(heap, start);
+        _purge_freed(heap, start);
+    }
+
+#if ENABLE_DMEM_SLAB
+    /** [3] 释放小对象 **/
+    for(i = 0; i < n; i++)
+    {
+        struct dmem_slab_page* page;
+        int err;
+
+        if(ptrs[i] == NULL || !dmem_mem_in_pool(heap, ptrs[i]) || (page = _slab_page_of(heap, ptrs[i])) == NULL)
+            continue;
+        if((err = _slab_free(heap, page, ptrs[i])) == DMEM_ERR_NONE)
+        {
+            heap->free_count++;
+            _record(heap, DMEM_RECORD_FREE, 0, 0, ptrs[i], NULL);
+        }
+        else if(res == DMEM_ERR_NONE)
+            res = err;
+    }
+#endif
+
+    _update_max_usage(heap);
+    return res;
+}
+
+#if ENABLE_DMEM_TCACHE
+/**
+ * ----------------------------------------------------------------------------
+ * 线程缓存
+ * 每个线程拥有一个线程局部的缓存，按尺寸类别以单链表保存最近释放的小内存（链表指针存放在内存自身中），
+ * 分配与释放优先在缓存中完成，不需要获取内存堆的线程锁。
+ * 缓存为空时获取一次线程锁，从内存堆批量分配 DMEM_TCACHE_BATCH 个内存；
+ * 某个尺寸类别超过 DMEM_TCACHE_BIN_MAX 个时批量归还 DMEM_TCACHE_BATCH 个，缓存总大小超过上限时全部归还。
+ * 线程缓存在首次使用时绑定到一个内存堆，缓存清空后才可绑定到其他内存堆，其他内存堆的请求直接交由内存堆处理。
+ * 缓存中的内存对内存堆而言仍处于已分配状态。
+ * 内存堆重新初始化后初始化代数改变，线程缓存丢弃此前缓存的内存；线程首次使用缓存时通过移植层注册退出回调，
+ * 线程退出时自动调用 dmem_tcache_flush()。
+ * 释放路径在获取线程锁之前只读取以下内容：tcache_enabled、tcache_gen、内存区域表（region_count 以 acquire 读取，只增不减）、
+ * 页映射表 slab_map/slab_map_base/slab_map_len（以 release/acquire 发布，线程缓存开启过后不再归还）、
+ * 待释放内存所在页在映射表中的一项及其内存块信息头（调用者持有该内存，期间不会被其他线程修改）。
+ * ----------------------------------------------------------------------------
+ */
+#define DMEM_TCACHE_MISS                    (1)     // 线程缓存无法处理，需交由内存堆处理
+
+/**
+ * @brief 线程缓存中某一尺寸类别的缓存链表
+ */
+struct dmem_tcache_bin
+{
+    void* head;                 /** 链表头，内存的前 sizeof(void*) 字节保存下一个内存的地址 **/
+    uint32_t count;             /** 链表中的内存数量 **/
+};
+
+/**
+ * @brief 线程缓存
+ */
+struct dmem_tcache
+{
+    dmem_heap_t heap;                                       /** 绑定的内存堆 **/
+    uint32_t gen;                                           /** 绑定时内存堆的初始化代数 **/
+    bool exit_registered;                                   /** 是否已注册线程退出回调 **/
+    size_t bytes;                                           /** 缓存的内存总大小 **/
+    size_t limit;                                           /** 缓存的内存总大小上限 **/
+    struct dmem_tcache_bin bins[DMEM_SIZE_CLASS_COUNT];     /** 各尺寸类别的缓存链表 **/
+};
+
+static DMEM_THREAD_LOCAL struct dmem_tcache tcache = { NULL, 0, false, 0, DMEM_TCACHE_LIMIT, {{NULL, 0}} };
+
+DMEM_STATIC_ASSERT(tcache_ptr_fits, sizeof(void*) <= DMEM_SIZE_CLASS_MIN);
+
+/**
+ * @brief 将内存压入缓存链表
+ * @param tc 线程缓存
+ * @param cls 尺寸类别
+ * @param mem 内存
+ */
+static void _tcache_push(struct dmem_tcache* tc, int cls, void* mem)
+{
+    struct dmem_tcache_bin* bin = &tc->bins[cls];
+    memcpy(mem, &bin->head, sizeof(void*));     // 内存可能只按 DMEM_DEFINE_ALIGN_SIZE 对齐
+    bin->head = mem;
+    bin->count++;
+    tc->bytes += size_class_bytes[cls];
+}
+
+/**
+ * @brief 从缓存链表弹出内存
+ * @param tc 线程缓存
+ * @param cls 尺寸类别，对应的链表不可为空
+ * @return void* 
+ */
+static void* _tcache_pop(struct dmem_tcache* tc, int cls)
+{
+    struct dmem_tcache_bin* bin = &tc->bins[cls];
+    void* mem = bin->head;
+    memcpy(&bin->head, mem, sizeof(void*));
+    bin->count--;
+    tc->bytes -= size_class_bytes[cls];
+    return mem;
+}
+
+/**
+ * @brief 将缓存链表中的 n 个内存归还内存堆
+ * @note 调用者需持有内存堆的线程锁
+ * @param tc 线程缓存
+ * @param cls 尺寸类别
+ * @param n 归还的数量
+ */
+static void _tcache_flush_bin(struct dmem_tcache* tc, int cls, uint32_t n)
+{
+    while(n-- > 0 && tc->bins[cls].count > 0)
+        _heap_free(tc->heap, _tcache_pop(tc, cls));
+}
+
+/**
+ * @brief 绑定的内存堆已被重新初始化时，丢弃缓存的内存并解除绑定
+ * @note 缓存的内存属于重新初始化之前的内存池，不可再归还
+ * @param tc 线程缓存
+ */
+static void _tcache_check_gen(struct dmem_tcache* tc)
+{
+    if(tc->heap != NULL && tc->gen != tc->heap->tcache_gen)
+    {
+        memset(tc->bins, 0, sizeof(tc->bins));
+        tc->bytes = 0;
+        tc->heap = NULL;
+    }
+}
+
+/**
+ * @brief 从线程缓存分配内存
+ * @param heap 内存堆
+ * @param size 待分配的内存的大小
+ * @return void* 若线程缓存无法处理则返回 NULL
+ */
+static void* _tcache_alloc(dmem_heap_t heap, size_t size)
+{
+    struct dmem_tcache* tc = &tcache;
+    int cls;
+
+    if(!heap->tcache_enabled || size == 0 || size > DMEM_SIZE_CLASS_MAX)
+        return NULL;
+    _tcache_check_gen(tc);
+    if(tc->heap != heap)
+    {
+        if(tc->heap != NULL && tc->bytes != 0)
+            return NULL;
+        tc->heap = heap;
+        tc->gen = heap->tcache_gen;
+        if(!tc->exit_registered)
+        {
+            dmem_thread_at_exit(dmem_tcache_flush);
+            tc->exit_registered = true;
+        }
+    }
+
+    cls = dmem_size_class(size);
+    if(tc->bins[cls].count == 0)
+    {
+        /** 缓存为空，从内存堆批量补充 **/
+        int i;
+        dmem_get_lock(heap);
+        for(i = 0; i < DMEM_TCACHE_BATCH; i++)
+        {
+            void* mem = _heap_alloc(heap, size_class_bytes[cls]);
+            if(mem == NULL)
+                break;
+            _tcache_push(tc, cls, mem);
+        }
+        _heap_unlock(heap);
+        if(tc->bins[cls].count == 0)
+            return NULL;
+    }
+    return _tcache_pop(tc, cls);
+}
+
+/**
+ * @brief 将内存释放到线程缓存
+ * @param heap 内存堆
+ * @param mem 待释放的内存地址
+ * @return int  - DMEM_ERR_NONE           : 已放入线程缓存
+ *              - DMEM_FREE_REPEATED      : 该内存刚被放入线程缓存，不可重复释放
+ *              - DMEM_TCACHE_MISS        : 线程缓存无法处理，需交由内存堆释放
+ */
+static int _tcache_free(dmem_heap_t heap, void* mem)
+{
+    struct dmem_tcache* tc = &tcache;
+    dmem_size_t usable;
+    int cls;
+
+    if(!heap->tcache_enabled || mem == NULL)
+        return DMEM_TCACHE_MISS;
+    _tcache_check_gen(tc);
+    if(tc->heap != heap || !dmem_mem_in_pool(heap, mem))
+        return DMEM_TCACHE_MISS;
+
+    /** 无效的内存交由内存堆报告错误 **/
+    usable = _usable_size(heap, mem);
+    if(usable < DMEM_SIZE_CLASS_MIN || usable >= 2 * DMEM_SIZE_CLASS_MAX)
+        return DMEM_TCACHE_MISS;
+
+    /** 按不超过可用大小的尺寸类别缓存 **/
+    cls = usable > DMEM_SIZE_CLASS_MAX ? DMEM_SIZE_CLASS_COUNT - 1 : dmem_size_class(usable);
+    if(size_class_bytes[cls] > usable)
+        cls--;
+    if(tc->bins[cls].head == mem)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Double free detected in thread cache | Addr: %p", mem);
+        return DMEM_FREE_REPEATED;
+    }
+    _tcache_push(tc, cls, mem);
+
+    /** 超出上限，批量归还内存堆 **/
+    if(tc->bins[cls].count > DMEM_TCACHE_BIN_MAX || tc->bytes > tc->limit)
+    {
+        dmem_get_lock(heap);
+        if(tc->bytes > tc->limit)
+        {
+            for(cls = 0; cls < DMEM_SIZE_CLASS_COUNT; cls++)
+                _tcache_flush_bin(tc, cls, tc->bins[cls].count);
+        }
+        else
+            _tcache_flush_bin(tc, cls, DMEM_TCACHE_BATCH);
+        _heap_unlock(heap);
+    }
+    return DMEM_ERR_NONE;
+}
+#endif
+
+/**
+ * @brief 初始化内存堆
+ * @param heap 内存堆
+ * @param pool 内存池地址
+ * @param size 内存池可使用的大小
+ * @return int  - DMEM_ERR_NONE           : 初始化成功
+ *              - DMEM_INIT_POOL_NULL     : 指定的内存池地址为 NULL
+ *              - DMEM_INIT_SIZE_SMALL    : 内存池大小过小
+ *              - DMEM_INIT_POOL_ALIGN    : 内存池地址未对齐
+ *              - DMEM_INIT_HEAP_NULL     : 指定的内存堆为 NULL
+ */
+int dmem_heap_init(dmem_heap_t heap, void* pool, size_t size)
+{
+    void* lock = NULL;
+#if ENABLE_DMEM_TCACHE
+    uint32_t tcache_gen;
+#endif
+
+    if(heap == NULL)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Heap is NULL!");
+        return DMEM_INIT_HEAP_NULL;
+    }
+
+    /** 内存管理器初始化（保留移植层的线程锁对象及线程缓存的初始化代数） **/
+    lock = heap->lock;
+#if ENABLE_DMEM_TCACHE
+    tcache_gen = heap->tcache_gen;
+#endif
+    memset(heap, 0, sizeof(struct dmem_heap));
+    heap->lock = lock;
+#if ENABLE_DMEM_TCACHE
+    heap->tcache_gen = tcache_gen + 1;
+#endif
+
+    /** 内存池不可为 NULL **/
+    if(pool == NULL)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Pool's address is NULL!");
+        return DMEM_INIT_POOL_NULL;
+    }
+
+    /** 内存池地址未对齐 **/
+    if(!IS_DMEM_VAR_ALIGNED(pool, DMEM_DEFINE_ALIGN_SIZE))
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "Current pool address is not aligned(%p)", pool);
+        return DMEM_INIT_POOL_ALIGN;
+    } 
+
+    /** 内存池大小超出偏移量所能表示的范围，则只管理偏移量可表示的部分 **/
+    if(size > 0 && (uintmax_t) size - 1 > (uintmax_t) dmem_offset_max())
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "Pool size exceeds the %d-bit offset range, only the first %lu bytes will be used", DMEM_OFFSET_WIDTH, (unsigned long)((uintmax_t) dmem_offset_max() + 1));
+        size = (size_t)((uintmax_t) dmem_offset_max() + 1);
+    }
+
+    /** 检查内存池大小对齐情况，若未对齐，则尝试对齐 **/
+    if(!IS_DMEM_VAR_ALIGNED(size, DMEM_DEFINE_ALIGN_SIZE))
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "Current pool size is not aligned(%lu bytes), dmem will adjust other size...", (unsigned long)size);
+        size = MAKE_POOL_SIZE_ALIGN(size);
+        dmem_trace(DMEM_LEVEL_INFO, "New pool size: %lu bytes", (unsigned long)size);
+    }
+
+    /** 内存池大小过小 **/
+    if(size < dmem_min_alloc_size() + dmem_block_size() * 2)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Pool size is too small!");
+        return DMEM_INIT_SIZE_SMALL;
+    }
+
+    /** 保存内存池 **/
+    heap->pool = (char*) pool;
+    heap->size = size;
+
+    dmem_head_block(heap) = (dmem_block_t) dmem_pool_at(heap, 0);
+    dmem_head_block(heap)->magic = dmem_block_magic();
+    dmem_head_block(heap)->prev = dmem_block_offset(heap, dmem_head_block(heap));
+    dmem_head_block(heap)->used = 0;
+
+    dmem_tail_block(heap) = (dmem_block_t) dmem_pool_at(heap, dmem_pool_size(heap) - dmem_block_size());
+    dmem_tail_block(heap)->magic = dmem_block_magic();
+    dmem_tail_block(heap)->prev = dmem_block_offset(heap, dmem_head_block(heap));
+    dmem_tail_block(heap)->used = DMEM_BLOCK_USED;
+
+    dmem_head_block(heap)->next = dmem_block_offset(heap, dmem_tail_block(heap));
+    dmem_tail_block(heap)->next = dmem_block_offset(heap, dmem_tail_block(heap));
+
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+    heap->policy = DMEM_DEFAULT_POLICY;
+#endif
+    _free_list_init(heap);
+    _free_list_insert(heap, dmem_head_block(heap));
+
+    heap->free = dmem_block_mem_size(heap, dmem_head_block(heap));
+    heap->max_usage = dmem_pool_size(heap) - heap->free;
+    heap->inited_free = heap->free;
+    heap->dirty = dmem_pool_size(heap);     // 默认内存池的内容未知，dmem_heap_init_zeroed() 会修改该值
+#if ENABLE_DMEM_PURGE
+    heap->purge_decay = DMEM_PURGE_DECAY;
+#endif
+#if ENABLE_DMEM_HUGE
+    heap->huge_threshold = DMEM_HUGE_THRESHOLD;
+#endif
+#if ENABLE_DMEM_GROW
+    heap->region_count = 1;
+    heap->region_start[0] = 0;
+    heap->region_end[0] = dmem_pool_size(heap);
+#endif
+    _stats_publish(heap);
+    
+    dmem_trace(DMEM_LEVEL_INFO, "Initialized memory pool | Addr: %p | Size: %lu bytes", pool, (unsigned long)size);
+    dmem_trace(DMEM_LEVEL_DEBUG, "Head block: %p | Tail block: %p | Free: %lu bytes", dmem_head_block(heap), dmem_tail_block(heap), (unsigned long)heap->free);
+
+    return DMEM_ERR_NONE;
+}
+
+/**
+ * @brief 初始化内存堆，并声明内存池的内容全部为 0
+ * @note 适用于位于 .bss 段的静态数组、新映射的匿名页等内容已知为 0 的内存池，
+ *       dmem_heap_calloc() 将跳过从未写入的部分，不再重复清零；内存池的内容不为 0 时不可使用
+ * @param heap 内存堆
+ * @param pool 内存池地址，内容必须全部为 0
+ * @param size 内存池可使用的大小
+ * @return int 参考 dmem_heap_init()
+ */
+int dmem_heap_init_zeroed(dmem_heap_t heap, void* pool, size_t size)
+{
+    int res = dmem_heap_init(heap, pool, size);
+
+    /** 初始化只写入了首内存块的信息头与空闲链表节点，以及位于末尾的尾内存块 **/
+    if(res == DMEM_ERR_NONE)
+        heap->dirty = dmem_block_size() + sizeof(struct dmem_free_node);
+    return res;
+}
+
+/**
+ * @brief 依据指定的大小从内存堆中安全地分配连续的空间
+ * @param heap 内存堆
+ * @param size 需要分配的内存的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_heap_alloc(dmem_heap_t heap, size_t size)
+{
+    void* p = NULL;
+#if ENABLE_DMEM_TCACHE
+    if(!dmem_recording(heap) && (p = _tcache_alloc(heap, size)) != NULL)
+        return p;
+#endif
+    dmem_get_lock(heap);
+    p = _heap_alloc(heap, size);
+    _record(heap, DMEM_RECORD_ALLOC, size, 0, p, NULL);
+    _heap_unlock(heap);
+    return p;
+}
+
+/**
+ * @brief 重新分配内存，优先原地收缩或扩展，否则迁移到新的内存
+ * @note 该函数不具备线程安全，old_mem 不为 NULL 且 new_size 不为 0
+ * @param heap 内存堆
+ * @param old_mem 旧的被分配的内存
+ * @param new_size 新的被指定的内存大小
+ * @return void* 新的内存地址，扩展失败时返回 old_mem，old_mem 无效时返回 NULL
+ */
+static void* _heap_realloc(dmem_heap_t heap, void* old_mem, size_t new_size)
+{
+    /** [2] 对齐处理（统一使用向上对齐） **/
+    size_t request = new_size;
+    if(!IS_DMEM_VAR_ALIGNED(new_size, DMEM_DEFINE_ALIGN_SIZE))
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "Current pool size is not aligned(%lu bytes), dmem will adjust other size...", (unsigned long)new_size);
+        new_size = MAKE_ALLOC_SIZE_ALIGN(new_size);
+        dmem_trace(DMEM_LEVEL_INFO, "New pool size: %lu bytes", (unsigned long)new_size);
+    }
+    if(new_size < dmem_min_alloc_size())
+        new_size = dmem_min_alloc_size();
+
+    dmem_block_t block = dmem_block_entry(old_mem);
+    void* new_mem = old_mem;  // 默认返回原地址
+
+#if ENABLE_DMEM_HUGE
+    /** 直接映射的大内存：低于阈值时迁回内存池，否则调整映射大小 **/
+    {
+        struct dmem_huge* huge = dmem_mem_in_pool(heap, old_mem) ? NULL : _huge_find(heap, old_mem);
+        if(huge != NULL)
+        {
+            if(!dmem_huge_fits(heap, request) && (new_mem = _heap_alloc(heap, request)) != NULL)
+            {
+                /** 阈值可能已被调高，迁回内存池时也可能是扩展，只复制原有的可用部分 **/
+                size_t usable = huge->map_size - huge->offset;
+                memcpy(new_mem, old_mem, request < usable ? request : usable);
+                _heap_free(heap, old_mem);
+                return new_mem;
+            }
+            if((new_mem = _huge_resize(heap, huge, request)) == NULL)
+            {
+                dmem_trace(DMEM_LEVEL_WARNING, "Realloc failed, keeping original block");
+                new_mem = old_mem;
+            }
+            return new_mem;
+        }
+    }
+#endif
+
+#if ENABLE_DMEM_SLAB
+    /** 小对象：槽位足够则原地返回，否则迁移到新的内存 **/
+    {
+        struct dmem_slab_page* page = _slab_page_of(heap, old_mem);
+        if(page != NULL)
+        {
+            if(new_size > page->size)
+            {
+                if((new_mem = _heap_alloc(heap, new_size)) != NULL)
+                {
+                    memcpy(new_mem, old_mem, page->size);
+                    _heap_free(heap, old_mem);
+                }
+                else
+                {
+                    dmem_trace(DMEM_LEVEL_WARNING, "Realloc failed, keeping original block");
+                    new_mem = old_mem;
+                }
+            }
+            return new_mem;
+        }
+    }
+#endif
+
+    /** [3] 验证内存块有效性 **/
+    if(!dmem_mem_in_pool(heap, old_mem) || !dmem_block_is_valid(block) || (block->used & (DMEM_BLOCK_SLAB | DMEM_BLOCK_MOVABLE)))
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Old memory is invalid!");
+        return NULL;
+    }
+
+#if ENABLE_DMEM_TAG
+    /** 带标签的内存块留在内存池中，并以原标签重新计入标签统计 **/
+    if(dmem_block_tag(block) != 0)
+        return _tag_realloc(heap, old_mem, new_size, request, dmem_block_tag(block));
+#endif
+
+    dmem_size_t old_size = dmem_block_mem_size(heap, block);
+
+    // [4] 大小不变
+    if (new_size == old_size) 
+    {
+        dmem_trace(DMEM_LEVEL_DEBUG, "Realloc same size: %lu bytes @ %p", (unsigned long)new_size, old_mem);
+        _block_set_slack(heap, block, request);
+        return old_mem;
+    }
+
+    // [5] 扩展内存
+    if (new_size > old_size) 
+    {
+        // 优先尝试就地扩展，达到直接映射阈值时迁出内存池
+        if (!dmem_huge_fits(heap, request) && _expand_inplace(heap, block, new_size)) 
+        {
+            _block_set_slack(heap, block, request);
+            return old_mem;
+        }
+        
+        // 其次向空闲的前一个内存块扩展，无需查找空闲链表
+        dmem_block_t moved = dmem_huge_fits(heap, request) ? NULL : _expand_backward(heap, block, new_size);
+        if (moved != NULL)
+        {
+            _block_set_slack(heap, moved, request);
+            return dmem_block_mem_addr(moved);
+        }
+
+        // 无法就地扩展则分配新内存
+        dmem_trace(DMEM_LEVEL_DEBUG, "Allocating new block for realloc: %lu -> %lu bytes", (unsigned long)old_size, (unsigned long)new_size);
+        
+        if ((new_mem = _heap_alloc(heap, new_size))) 
+        {
+            memmove(new_mem, old_mem, old_size);
+            _heap_free(heap, old_mem);
+        } 
+        else 
+        {
+            // 分配失败：保留原内存块
+            dmem_trace(DMEM_LEVEL_WARNING, "Realloc failed, keeping original block");
+            new_mem = old_mem;  // 必须返回原指针
+        }
+    } 
+    // [6] 收缩内存
+    else 
+    {
+        dmem_trace(DMEM_LEVEL_DEBUG, "Shrinking block: %lu -> %lu bytes @ %p",  (unsigned long)old_size, (unsigned long)new_size, old_mem);
+        _split(heap, block, new_size);
+        _block_set_slack(heap, block, request);
+    }
+
+    return new_mem;
+}
+
+/**
+ * @brief 依据指定的大小从内存堆中重新分配新的连续的空间，并释放旧的已分配内存
+ * @param heap 内存堆
+ * @param old_mem 旧的被分配的内存
+ * @param new_size 新的被指定的内存大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_heap_realloc(dmem_heap_t heap, void* old_mem, size_t new_size)
+{
+    void* new_mem;
+
+    /** [1] 处理 NULL 和 size=0 的特殊情况 **/
+    // 如果输入为 NULL, 则相当于执行新内存分配
+    if(old_mem == NULL)
+    {
+        dmem_trace(DMEM_LEVEL_INFO, "Realloc NULL -> new allocation | Size: %lu bytes", (unsigned long)new_size);
+        return dmem_heap_alloc(heap, new_size);
+    }
+
+    // 如果新分配内存为 0, 则执行内存释放功能
+    if(new_size == 0)
+    {
+        dmem_trace(DMEM_LEVEL_DEBUG, "New size is 0, free old memory");
+        dmem_heap_free(heap, old_mem);
+        return NULL;
+    }
+
+    dmem_get_lock(heap);
+    new_mem = _heap_realloc(heap, old_mem, new_size);
+    _record(heap, DMEM_RECORD_REALLOC, new_size, 0, new_mem, old_mem);
+    _heap_unlock(heap);
+    return new_mem;
+}
+
+/**
+ * @brief 从内存堆中分配指定大小和数量的连续空间，并自动将已分配的内存初始化为 0
+ * @param heap 内存堆
+ * @param count 对象的数量
+ * @param size 对象的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_heap_calloc(dmem_heap_t heap, size_t count, size_t size)
+{
+    size_t total = count * size;
+    size_t zero;
+    struct dmem_zero_mark mark;
+    void* p = NULL;
+
+    if(size != 0 && count > SIZE_MAX / size)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Calloc size overflow | Count: %lu | Size: %lu", (unsigned long)count, (unsigned long)size);
+        return NULL;
+    }
+#if ENABLE_DMEM_TCACHE
+    if(!dmem_recording(heap) && (p = _tcache_alloc(heap, total)) != NULL)
+    {
+        memset(p, 0, total);
+        return p;
+    }
+#endif
+    dmem_get_lock(heap);
+    _zero_mark(heap, &mark);
+    p = _heap_alloc(heap, total);
+    zero = _zero_size(heap, &mark, p, total);
+    _record(heap, DMEM_RECORD_CALLOC, total, 0, p, NULL);
+    _heap_unlock(heap);
+
+    /** 内存已归调用者所有，在线程锁之外清零 **/
+    if(zero)
+        memset(p, 0, zero);
+    return p;
+}
+
+/**
+ * @brief 从内存堆中分配起始地址按 align 对齐的连续空间
+ * @note 对齐产生的填充部分会作为独立的空闲内存块放回内存堆，返回的内存可直接使用 dmem_heap_free()/dmem_heap_realloc()，
+ *       但 dmem_heap_realloc() 迁移内存时不保证新地址仍满足该对齐要求
+ * @param heap 内存堆
+ * @param align 地址对齐大小，必须为 2 的幂
+ * @param size 需要分配的内存的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_heap_aligned_alloc(dmem_heap_t heap, size_t align, size_t size)
+{
+    void* p = NULL;
+
+    if(align == 0 || (align & (align - 1)) != 0)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Alignment must be a power of two: %lu", (unsigned long)align);
+        return NULL;
+    }
+    dmem_get_lock(heap);
+#if ENABLE_DMEM_HUGE
+    if(dmem_huge_fits(heap, size) && align <= DMEM_HUGE_PAGE_SIZE)
+        p = _huge_alloc(heap, align, size);
+    if(p == NULL)
+#endif
+    p = _alloc_aligned(heap, align, size);
+    if(p == NULL && size != 0 && size <= SIZE_MAX - align && _grow(heap, size + align + dmem_block_size() + dmem_min_alloc_size()))
+        p = _alloc_aligned(heap, align, size);
+    if(p != NULL)
+        heap->alloc_count++;
+    else if(size != 0)
+        heap->fail_count++;
+    _record(heap, DMEM_RECORD_ALIGNED, size, align, p, NULL);
+    _heap_unlock(heap);
+    return p;
+}
+
+/**
+ * @brief 安全地释放从内存堆中分配的内存
+ * @param heap 内存堆
+ * @param mem 待释放的内存
+ * @return int  0:  释放成功
+ *              -1: mem 为 NULL
+ *              -2: 内存块信息无效（或 mem 不属于该内存堆）
+ *              -3: 该内存块不可重复释放
+ */
+int dmem_heap_free(dmem_heap_t heap, void* mem)
+{
+    int res = 0;
+#if ENABLE_DMEM_TCACHE
+    if(!dmem_recording(heap) && (res = _tcache_free(heap, mem)) != DMEM_TCACHE_MISS)
+        return res;
+#endif
+    dmem_get_lock(heap);
+    res = _heap_free(heap, mem);
+    if(res == DMEM_ERR_NONE)
+        _record(heap, DMEM_RECORD_FREE, 0, 0, mem, NULL);
+    _heap_unlock(heap);
+    return res;
+}
+
+/**
+ * @brief 从内存堆中批量分配 n 个相同大小的内存，只获取一次线程锁
+ * @note 每找到一个空闲内存块就从中连续切分尽可能多的内存，不经过线程缓存
+ * @param heap 内存堆
+ * @param size 每个内存的大小
+ * @param n 需要分配的数量
+ * @param ptrs 用于返回内存地址的数组，长度不小于 n
+ * @return size_t 实际分配的数量，空间不足时小于 n，已分配的内存仍需释放
+ */
+size_t dmem_heap_alloc_batch(dmem_heap_t heap, size_t size, size_t n, void* ptrs[])
+{
+    size_t count;
+    dmem_get_lock(heap);
+    count = _alloc_batch(heap, size, n, ptrs);
+#if ENABLE_DMEM_RECORD
+    for(size_t i = 0; i < count; i++)
+        _record(heap, DMEM_RECORD_ALLOC, size, 0, ptrs[i], NULL);
+#endif
+    _heap_unlock(heap);
+    return count;
+}
+
+/**
+ * @brief 批量释放从内存堆中分配的内存，只获取一次线程锁，相邻的内存合并后只插入一次空闲链表
+ * @param heap 内存堆
+ * @param ptrs 待释放的内存地址数组，NULL 将被忽略
+ * @param n 数组长度
+ * @return int  0:  全部释放成功
+ *              <0: 遇到的第一个错误（参考 dmem_heap_free()），其余有效的内存仍会被释放
+ */
+int dmem_heap_free_batch(dmem_heap_t heap, void* const ptrs[], size_t n)
+{
+    int res;
+    dmem_get_lock(heap);
+    res = _free_batch(heap, ptrs, n, false);
+    _heap_unlock(heap);
+    return res;
+}
+
+/**
+ * @brief 读取内存堆的内存使用报告
+ * @note 读取的是每次修改内存堆后发布的快照，无需获取线程锁，不会阻塞内存分配，可在中断中调用，支持可重入获取内存使用报告
+ * @param heap 内存堆
+ * @param result 用户填入的内存使用报告结构体，由函数内部填充
+ */
+void dmem_heap_report(dmem_heap_t heap, struct dmem_use_report* result)
+{
+    volatile struct dmem_use_report* stats;
+    uint32_t seq;
+
+    /** 读取快照期间序列号未变化即为一致的快照；只有写者在另一核心上发布了新快照才会重试 **/
+    do
+    {
+        seq = dmem_atomic_load_acquire(&heap->stats_seq);
+        stats = &heap->stats[seq & 1];
+        result->free = dmem_atomic_load(&stats->free);
+        result->max_usage = dmem_atomic_load(&stats->max_usage);
+        result->initf = dmem_atomic_load(&stats->initf);
+        result->used_count = dmem_atomic_load(&stats->used_count);
+        dmem_fence_acquire();
+    } while(dmem_atomic_load(&heap->stats_seq) != seq);
+}
+
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+/**
+ * @brief 设置内存堆的放置策略
+ * @note 建议在 dmem_heap_init() 之后立即设置，运行中切换策略时会重建空闲链表
+ * @param heap 内存堆
+ * @param policy 放置策略 DMEM_POLICY_xxx
+ * @return int  - DMEM_ERR_NONE           : 设置成功
+ *              - DMEM_POLICY_INVALID     : 无效的放置策略
+ */
+int dmem_heap_set_policy(dmem_heap_t heap, int policy)
+{
+    if(policy < DMEM_POLICY_FIRST_FIT || policy > DMEM_POLICY_LIFO)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Invalid placement policy: %d", policy);
+        return DMEM_POLICY_INVALID;
+    }
+
+    dmem_get_lock(heap);
+    heap->policy = (uint8_t) policy;
+    if(heap->pool != NULL)
+        _free_list_rebuild(heap);
+    _heap_unlock(heap);
+    return DMEM_ERR_NONE;
+}
+#endif
+
+/**
+ * @brief 读取内存堆的碎片报告
+ * @param heap 内存堆
+ * @param result 用户填入的碎片报告结构体，由函数内部填充
+ */
+void dmem_heap_frag_report(dmem_heap_t heap, struct dmem_frag_report* result)
+{
+    dmem_size_t free_total = 0;
+
+    memset(result, 0, sizeof(struct dmem_frag_report));
+    dmem_get_lock(heap);
+    if(heap->pool != NULL)
+    {
+        free_total = heap->free;
+        result->free_blocks = heap->free_blocks;
+        result->largest_free = _largest_free(heap);
+    }
+    dmem_rel_lock(heap);
+
+    /** 外部碎片率：空闲内存中无法被一次分配利用的比例 **/
+    if(free_total != 0)
+        result->fragmentation = (uint32_t)(1000 - (uint64_t) result->largest_free * 1000 / free_total);
+}
+
+/**
+ * @brief 读取内存堆的扩展统计信息
+ * @note 各项均为增量维护的计数，仅最大空闲内存块在其被分配后首次读取时需要由引擎重新计算
+ * @param heap 内存堆
+ * @param result 用户填入的扩展统计结构体，由函数内部填充
+ */
+void dmem_heap_stats(dmem_heap_t heap, struct dmem_stats* result)
+{
+    memset(result, 0, sizeof(struct dmem_stats));
+    dmem_get_lock(heap);
+    if(heap->pool != NULL)
+    {
+        result->free_blocks = heap->free_blocks;
+        result->largest_free = _largest_free(heap);
+        memcpy(result->free_hist, heap->free_hist, sizeof(result->free_hist));
+        result->waste = heap->waste;
+#if ENABLE_DMEM_PURGE
+        result->purged = heap->purged;
+#endif
+#if ENABLE_DMEM_HUGE
+        result->huge = heap->huge_size;
+        result->huge_count = heap->huge_count;
+#endif
+        result->alloc_count = heap->alloc_count;
+        result->free_count = heap->free_count;
+        result->fail_count = heap->fail_count;
+    }
+    dmem_rel_lock(heap);
+}
+
+/**
+ * @brief 遍历内存块链表，依次将各内存块的信息交给回调函数
+ * @note 首内存块至尾内存块之前的内存块按地址顺序报告，尾内存块与直接映射的大内存不在内存池中，不报告
+ * @param heap 内存堆
+ * @param base 偏移量的基准，报告的偏移量为内存块相对内存池的偏移量加上 base
+ * @param cb 回调函数
+ * @param ctx 回调函数的参数
+ * @param stop 回调函数返回 false 时置为 true，为 true 时不再遍历
+ * @return size_t 报告的内存块数量
+ */
+static size_t _walk(dmem_heap_t heap, dmem_size_t base, dmem_walk_cb_t cb, void* ctx, bool* stop)
+{
+    struct dmem_walk_info info;
+    dmem_block_t pos;
+    dmem_size_t offset;
+    size_t count = 0;
+#if ENABLE_DMEM_GROW
+    uint32_t region = 0;
+#endif
+
+    dmem_get_lock(heap);
+    for(pos = heap->pool ? dmem_head_block(heap) : NULL; pos != NULL && pos != dmem_tail_block(heap) && !*stop; pos = dmem_block_next(heap, pos))
+    {
+        offset = (dmem_size_t) dmem_block_offset(heap, pos);
+        info.offset = base + offset;
+        info.size = dmem_block_mem_size(heap, pos);
+        info.slack = 0;
+        info.purged = false;
+        if(!(pos->used & DMEM_BLOCK_USED))
+        {
+            info.state = DMEM_WALK_FREE;
+            info.purged = (pos->used & DMEM_BLOCK_PURGED) != 0;
+        }
+        else
+        {
+            info.state = (pos->used & DMEM_BLOCK_SLAB) ? DMEM_WALK_SLAB :
+                         (pos->used & DMEM_BLOCK_MOVABLE) ? DMEM_WALK_MOVABLE : DMEM_WALK_USED;
+            info.slack = (uint16_t) dmem_block_slack(pos);
+#if ENABLE_DMEM_GROW
+            /** 内存区域的尾内存块成为哨兵内存块，其信息头结束于内存区域的结束位置 **/
+            while(region + 1 < heap->region_count && offset + dmem_block_size() > heap->region_end[region])
+                region++;
+            if(region + 1 < heap->region_count && offset + dmem_block_size() == heap->region_end[region])
+            {
+                info.state = DMEM_WALK_GAP;
+                info.slack = 0;
+            }
+#endif
+        }
+        count++;
+        if(!cb(&info, ctx))
+            *stop = true;
+    }
+    dmem_rel_lock(heap);
+    return count;
+}
+
+/**
+ * @brief 遍历内存堆的内存块，依次报告各内存块的偏移量、大小与状态
+ * @note 回调函数在持有内存堆线程锁时调用，不能再调用该内存堆的接口；
+ *       相邻的空闲内存块总是被合并，因此每个 DMEM_WALK_FREE 即为一段连续的空闲内存
+ * @param heap 内存堆
+ * @param cb 回调函数，返回 false 时停止遍历
+ * @param ctx 回调函数的参数
+ * @return size_t 报告的内存块数量
+ */
+size_t dmem_heap_walk(dmem_heap_t heap, dmem_walk_cb_t cb, void* ctx)
+{
+    bool stop = false;
+    return _walk(heap, 0, cb, ctx, &stop);
+}
+
+#if ENABLE_DMEM_SLAB
+/**
+ * @brief 开启或关闭内存堆的小对象分配器
+ * @note 1. 开启时会从内存池中分配页映射表，应在多线程使用该内存堆之前开启
+ *       2. 关闭后新的分配请求不再使用小对象分配器，已分配的小对象仍可正常释放，空闲的页将立即归还内存池，
+ *          所有的页都归还后页映射表也将归还内存池（线程缓存开启过的内存堆除外）
+ * @param heap 内存堆
+ * @param enable 是否开启
+ * @return true 小对象分配器已开启
+ * @return false 小对象分配器已关闭（或内存池空间不足以开启）
+ */
+bool dmem_heap_slab_enable(dmem_heap_t heap, bool enable)
+{
+    int cls;
+    dmem_get_lock(heap);
+    if(enable && heap->slab_map == NULL && !_slab_map_create(heap))
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "No memory for slab page map");
+        enable = false;
+    }
+    heap->slab_enabled = enable;
+    if(!enable)
+    {
+        for(cls = 0; cls < DMEM_SIZE_CLASS_COUNT; cls++)
+        {
+            struct dmem_slab_page* page = heap->slab_partial[cls];
+            while(page != NULL)
+            {
+                struct dmem_slab_page* next = page->next;
+                if(page->used == 0)
+                {
+                    _slab_unlink(heap, page);
+                    _slab_page_release(heap, page);
+                }
+                page = next;
+            }
+        }
+        _slab_map_release(heap);
+    }
+    _heap_unlock(heap);
+    return enable;
+}
+#endif
+
+#if ENABLE_DMEM_TCACHE
+/**
+ * @brief 开启或关闭内存堆的线程缓存
+ * @note 关闭时当前线程缓存的内存立即归还内存堆，其他线程缓存的内存在各线程调用 dmem_tcache_flush() 或线程退出时归还
+ * @param heap 内存堆
+ * @param enable 是否开启
+ */
+void dmem_heap_tcache_enable(dmem_heap_t heap, bool enable)
+{
+    dmem_get_lock(heap);
+    heap->tcache_enabled = enable;
+    if(enable)
+        heap->tcache_used = true;
+    _heap_unlock(heap);
+    if(!enable && tcache.heap == heap)
+        dmem_tcache_flush();
+}
+
+/**
+ * @brief 设置当前线程的线程缓存上限
+ * @note 若当前缓存的内存已超过新的上限，则立即全部归还内存堆
+ * @param bytes 缓存的内存总大小上限，单位：字节，为 0 时相当于不缓存
+ */
+void dmem_tcache_set_limit(size_t bytes)
+{
+    tcache.limit = bytes;
+    if(tcache.bytes > bytes)
+        dmem_tcache_flush();
+}
+
+/**
+ * @brief 将当前线程缓存的全部内存归还内存堆，并解除与内存堆的绑定
+ * @note 移植层支持线程退出回调时，线程退出时自动调用该函数；否则线程退出前应调用该函数，以免缓存中的内存无法再被使用
+ */
+void dmem_tcache_flush(void)
+{
+    struct dmem_tcache* tc = &tcache;
+    int cls;
+
+    _tcache_check_gen(tc);
+    if(tc->heap == NULL)
+        return;
+    dmem_get_lock(tc->heap);
+    for(cls = 0; cls < DMEM_SIZE_CLASS_COUNT; cls++)
+        _tcache_flush_bin(tc, cls, tc->bins[cls].count);
+    _heap_unlock(tc->heap);
+    tc->heap = NULL;
+}
+#endif
+
+#if ENABLE_DMEM_RECORD
+/**
+ * @brief 开始记录内存堆的分配与释放
+ * @note 1. 记录期间该内存堆的请求不经过线程缓存，以便每次分配与释放都能被记录
+ *       2. 若已在记录，则先将原缓冲区中的记录交给原回调函数
+ * @param heap 内存堆
+ * @param buf 环形缓冲区
+ * @param count 缓冲区可容纳的记录数量
+ * @param drain 缓冲区写满时调用的回调函数，为 NULL 时覆盖最早的记录
+ * @param arg 回调函数的参数
+ * @return int  0:  成功
+ *              -1: 缓冲区为空
+ */
+int dmem_heap_record_start(dmem_heap_t heap, struct dmem_record* buf, size_t count, dmem_record_drain_t drain, void* arg)
+{
+    if(buf == NULL || count == 0)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Record buffer is NULL!");
+        return DMEM_RECORD_BUF_NULL;
+    }
+    dmem_get_lock(heap);
+    _record_drain(heap);
+    heap->record_buf = buf;
+    heap->record_cap = count;
+    heap->record_head = 0;
+    heap->record_len = 0;
+    heap->record_drain = drain;
+    heap->record_arg = arg;
+    heap->record_lost = 0;
+    dmem_rel_lock(heap);
+    return DMEM_ERR_NONE;
+}
+
+/**
+ * @brief 将缓冲区中尚未取走的记录交给回调函数
+ * @param heap 内存堆
+ */
+void dmem_heap_record_flush(dmem_heap_t heap)
+{
+    dmem_get_lock(heap);
+    _record_drain(heap);
+    dmem_rel_lock(heap);
+}
+
+/**
+ * @brief 停止记录，剩余的记录交给回调函数
+ * @param heap 内存堆
+ * @return uint32_t 未设置回调函数时被覆盖的记录数量
+ */
+uint32_t dmem_heap_record_stop(dmem_heap_t heap)
+{
+    uint32_t lost;
+    dmem_get_lock(heap);
+    _record_drain(heap);
+    lost = heap->record_lost;
+    heap->record_buf = NULL;
+    heap->record_cap = 0;
+    heap->record_drain = NULL;
+    heap->record_arg = NULL;
+    dmem_rel_lock(heap);
+    return lost;
+}
+#endif
+
+#if ENABLE_DMEM_EVENT
+/**
+ * @brief 开始记录内存堆的事件
+ * @note 1. 缓冲区写满时覆盖最早的事件，被覆盖的数量由 dmem_heap_event_read() 返回
+ *       2. 线程缓存命中的分配与释放不经过内存堆，不产生事件
+ * @param heap 内存堆
+ * @param buf 环形缓冲区
+ * @param count 缓冲区可容纳的事件数量，必须为 2 的幂
+ * @param level 事件级别 DMEM_EVENT_LEVEL_xxx
+ * @return int  0:  成功
+ *              -1: 缓冲区为空
+ *              -2: 缓冲区容量不是 2 的幂
+ */
+int dmem_heap_event_start(dmem_heap_t heap, struct dmem_event* buf, size_t count, uint8_t level)
+{
+    if(buf == NULL || count == 0)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Event buffer is NULL!");
+        return DMEM_EVENT_BUF_NULL;
+    }
+    if((count & (count - 1)) != 0 || count > ((uint32_t) 1 << 31))
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Event buffer size must be a power of two: %lu", (unsigned long)count);
+        return DMEM_EVENT_BUF_SIZE;
+    }
+    dmem_get_lock(heap);
+    heap->event_buf = buf;
+    heap->event_mask = (uint32_t)(count - 1);
+    heap->event_head = 0;
+    heap->event_tail = 0;
+    heap->event_level = level;
+    dmem_rel_lock(heap);
+    return DMEM_ERR_NONE;
+}
+
+/**
+ * @brief 调整事件级别，只记录不高于该级别的事件
+ * @note 未设置缓冲区时无效
+ * @param heap 内存堆
+ * @param level 事件级别 DMEM_EVENT_LEVEL_xxx，DMEM_EVENT_LEVEL_OFF 暂停记录
+ */
+void dmem_heap_event_set_level(dmem_heap_t heap, uint8_t level)
+{
+    dmem_get_lock(heap);
+    if(heap->event_buf != NULL)
+        heap->event_level = level;
+    dmem_rel_lock(heap);
+}
+
+/**
+ * @brief 按时间顺序读出尚未读出的事件
+ * @param heap 内存堆
+ * @param out 用户提供的事件数组
+ * @param max out 可容纳的事件数量
+ * @param lost 若不为 NULL，则返回自上次读出以来被覆盖的事件数量
+ * @return size_t 读出的事件数量，小于 max 时表示已全部读出
+ */
+size_t dmem_heap_event_read(dmem_heap_t heap, struct dmem_event* out, size_t max, uint32_t* lost)
+{
+    size_t n = 0;
+    uint32_t dropped = 0;
+
+    dmem_get_lock(heap);
+    if(heap->event_buf != NULL)
+    {
+        /** 未读出的事件超过容量的部分已被覆盖 **/
+        if(heap->event_head - heap->event_tail > heap->event_mask + 1)
+        {
+            dropped = heap->event_head - heap->event_tail - (heap->event_mask + 1);
+            heap->event_tail += dropped;
+        }
+        while(n < max && heap->event_tail != heap->event_head)
+            out[n++] = heap->event_buf[heap->event_tail++ & heap->event_mask];
+    }
+    dmem_rel_lock(heap);
+    if(lost != NULL)
+        *lost = dropped;
+    return n;
+}
+
+/**
+ * @brief 停止记录事件，缓冲区中尚未读出的事件被丢弃
+ * @param heap 内存堆
+ */
+void dmem_heap_event_stop(dmem_heap_t heap)
+{
+    dmem_get_lock(heap);
+    heap->event_level = DMEM_EVENT_LEVEL_OFF;
+    heap->event_buf = NULL;
+    heap->event_mask = 0;
+    heap->event_head = 0;
+    heap->event_tail = 0;
+    dmem_rel_lock(heap);
+}
+#endif
+
+#if ENABLE_DMEM_GROW
+/**
+ * @brief 向内存堆添加新的内存区域
+ * @note 内存区域可与内存池不连续，但必须位于已有内存区域之后，且结束位置相对内存池的偏移量
+ *       不超出 dmem_off_t 的表示范围；内存区域一经添加不可移除，其中的内存块与其他内存块一样分配与释放
+ * @param heap 内存堆
+ * @param region 内存区域地址
+ * @param size 内存区域大小
+ * @return int  - DMEM_ERR_NONE           : 添加成功
+ *              - DMEM_REGION_INVALID     : 内存区域无效
+ *              - DMEM_REGION_FULL        : 内存区域数量已达 DMEM_REGION_MAX
+ */
+int dmem_heap_add_region(dmem_heap_t heap, void* region, size_t size)
+{
+    int ret;
+    dmem_get_lock(heap);
+    ret = _add_region(heap, region, size);
+    _heap_unlock(heap);
+    return ret;
+}
+
+/**
+ * @brief 开启或关闭内存堆的自动增长
+ * @note 开启后分配失败时通过移植层 dmem_get_region() 获取新的内存区域并重试分配
+ * @param heap 内存堆
+ * @param enable 是否开启
+ */
+void dmem_heap_grow_enable(dmem_heap_t heap, bool enable)
+{
+    dmem_get_lock(heap);
+    heap->grow_enabled = enable;
+    dmem_rel_lock(heap);
+}
+#endif
+
+#if ENABLE_DMEM_PURGE
+/**
+ * @brief 设置内存堆归还空闲页的延迟
+ * @note 设置为 0 时立即归还当前所有的空闲页；设置为其他延迟时，尚未归还的空闲内存块从此刻开始计时
+ * @param heap 内存堆
+ * @param decay 延迟（移植层 dmem_get_tick() 的计数），0 为释放时立即归还，DMEM_PURGE_OFF 为只在调用 dmem_heap_purge() 时归还
+ */
+void dmem_heap_set_purge_decay(dmem_heap_t heap, uint32_t decay)
+{
+    dmem_block_t pos;
+
+    dmem_get_lock(heap);
+    heap->purge_decay = decay;
+    heap->purge_pending = false;
+    if(decay == 0)
+        _purge_scan(heap, true);
+    else if(decay != DMEM_PURGE_OFF)
+    {
+        for(pos = dmem_head_block(heap); pos != dmem_tail_block(heap); pos = dmem_block_next(heap, pos))
+        {
+            if(dmem_block_is_unused(pos) && !(pos->used & DMEM_BLOCK_PURGED))
+                _purge_note(heap, pos);
+        }
+    }
+    _heap_unlock(heap);
+}
+
+/**
+ * @brief 立即归还内存堆中所有空闲内存块的整页，不受延迟影响
+ * @param heap 内存堆
+ * @return size_t 本次归还的大小，已归还的页不重复计算
+ */
+size_t dmem_heap_purge(dmem_heap_t heap)
+{
+    size_t size;
+
+    dmem_get_lock(heap);
+    size = _purge_scan(heap, true);
+    _heap_unlock(heap);
+    return size;
+}
+#endif
+
+#if ENABLE_DMEM_HUGE
+/**
+ * @brief 设置内存堆直接映射大内存的阈值
+ * @note 只影响之后的分配请求，已直接映射的大内存仍可正常释放与调整大小
+ * @param heap 内存堆
+ * @param threshold 阈值，单位字节，不小于该值的分配请求单独映射，为 0 时不使用直接映射
+ */
+void dmem_heap_set_huge_threshold(dmem_heap_t heap, size_t threshold)
+{
+    dmem_get_lock(heap);
+    heap->huge_threshold = threshold;
+    dmem_rel_lock(heap);
+}
+#endif
+
+#if ENABLE_DMEM_HANDLE
+/**
+ * ----------------------------------------------------------------------------
+ * 可移动的句柄分配 (handle)
+ * 句柄是句柄表中槽位的序号 + 1，槽位记录用户内存地址与锁定计数，句柄表本身从内存堆中分配，容量不足时加倍。
+ * 句柄分配的内存块带 DMEM_BLOCK_MOVABLE 标志，用户内存前预留一个对齐的前缀保存句柄，
+ * 紧凑整理遍历内存块链表时据此找到槽位并更新地址。
+ * 紧凑整理将未锁定的可移动内存块滑动到其前方的空闲内存块处，空闲部分随之后移并与后方的空闲内存块合并，
+ * 不可移动或已锁定的内存块将内存池分隔为若干段，各段的空闲内存块分别在段尾汇聚。
+ * ----------------------------------------------------------------------------
+ */
+DMEM_STATIC_ASSERT(handle_init_count, DMEM_HANDLE_INIT_COUNT > 0);
+
+/**
+ * @brief 句柄表的槽位
+ */
+struct dmem_handle_slot
+{
+    char* mem;                  /** 用户内存地址，为 NULL 时槽位空闲 **/
+    uint32_t lock;              /** 锁定计数，不为 0 时内存块不可移动 **/
+    uint32_t next_free;         /** 空闲槽位链表中的下一个槽位（句柄值），为 0 时到达链表末尾 **/
+};
+
+/** 句柄表大小的溢出检查按槽位不超过 16 字节在预处理阶段取舍 **/
+DMEM_STATIC_ASSERT(handle_slot_size, sizeof(struct dmem_handle_slot) <= 16);
+
+#define dmem_handle_prefix()            MAKE_ALLOC_SIZE_ALIGN(sizeof(dmem_handle_t))
+#define dmem_handle_slot_of(heap, h)    (&(heap)->handles[(h) - 1])
+#define dmem_handle_of_block(block)     (*(dmem_handle_t*) dmem_block_mem_addr(block))
+
+/**
+ * @brief 获取已分配的句柄对应的槽位
+ * @param heap 内存堆
+ * @param handle 句柄
+ * @return struct dmem_handle_slot* 句柄无效或已释放时返回 NULL
+ */
+static struct dmem_handle_slot* _handle_slot(dmem_heap_t heap, dmem_handle_t handle)
+{
+    struct dmem_handle_slot* slot;
+
+    if(handle == DMEM_HANDLE_NULL || handle > heap->handle_cap)
+        return NULL;
+    slot = dmem_handle_slot_of(heap, handle);
+    return slot->mem != NULL ? slot : NULL;
+}
+
+/**
+ * @brief 从空闲槽位链表中取出一个槽位，没有空闲槽位时加倍句柄表
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @return dmem_handle_t 句柄，句柄表无法扩展时返回 DMEM_HANDLE_NULL
+ */
+static dmem_handle_t _handle_pop(dmem_heap_t heap)
+{
+    struct dmem_handle_slot* table;
+    dmem_handle_t handle;
+    uint32_t cap;
+
+    if(heap->handle_free == 0)
+    {
+        cap = heap->handle_cap ? heap->handle_cap * 2 : DMEM_HANDLE_INIT_COUNT;
+        if(heap->handle_cap > UINT32_MAX / 2)
+            table = NULL;
+#if UINT32_MAX > SIZE_MAX / 16
+        else if((size_t) cap > SIZE_MAX / sizeof(struct dmem_handle_slot))
+            table = NULL;
+#endif
+        else
+            table = (struct dmem_handle_slot*) _heap_alloc(heap, (size_t) cap * sizeof(struct dmem_handle_slot));
+        if(table == NULL)
+        {
+            dmem_trace(DMEM_LEVEL_WARNING, "Handle table grow failed | Capacity: %lu", (unsigned long)heap->handle_cap);
+            return DMEM_HANDLE_NULL;
+        }
+        if(heap->handles != NULL)
+        {
+            memcpy(table, heap->handles, (size_t) heap->handle_cap * sizeof(struct dmem_handle_slot));
+            _heap_free(heap, heap->handles);
+        }
+
+        /** 新的槽位按序号从小到大链接 **/
+        for(handle = cap; handle > heap->handle_cap; handle--)
+        {
+            table[handle - 1].mem = NULL;
+            table[handle - 1].lock = 0;
+            table[handle - 1].next_free = heap->handle_free;
+            heap->handle_free = handle;
+        }
+        heap->handles = table;
+        heap->handle_cap = cap;
+    }
+
+    handle = heap->handle_free;
+    heap->handle_free = dmem_handle_slot_of(heap, handle)->next_free;
+    return handle;
+}
+
+/**
+ * @brief 将槽位放回空闲槽位链表
+ * @param heap 内存堆
+ * @param handle 句柄
+ */
+static void _handle_push(dmem_heap_t heap, dmem_handle_t handle)
+{
+    struct dmem_handle_slot* slot = dmem_handle_slot_of(heap, handle);
+
+    slot->mem = NULL;
+    slot->lock = 0;
+    slot->next_free = heap->handle_free;
+    heap->handle_free = handle;
+}
+
+/**
+ * @brief 判断内存块是否为未锁定的可移动内存块
+ * @param heap 内存堆
+ * @param block 内存块
+ * @return true 可以移动
+ */
+static bool _handle_block_movable(dmem_heap_t heap, dmem_block_t block)
+{
+    if((block->used & (DMEM_BLOCK_USED | DMEM_BLOCK_MOVABLE)) != (DMEM_BLOCK_USED | DMEM_BLOCK_MOVABLE))
+        return false;
+    return dmem_handle_slot_of(heap, dmem_handle_of_block(block))->lock == 0;
+}
+
+/**
+ * @brief 将可移动内存块滑动到其前方的空闲内存块处
+ * @note 该函数不具备线程安全。内存块信息头移动到空闲内存块处，原空闲部分成为移动后内存块之后的新空闲内存块，
+ *       与后方的空闲内存块合并；空闲内存总量不变（合并时增加一个信息头的大小）
+ * @param heap 内存堆
+ * @param free_block 空闲内存块
+ * @param block 紧随其后的未锁定的可移动内存块
+ * @return dmem_block_t 移动后的内存块
+ */
+static dmem_block_t _compact_slide(dmem_heap_t heap, dmem_block_t free_block, dmem_block_t block)
+{
+    dmem_size_t size = dmem_block_mem_size(heap, block);
+    dmem_block_t after = dmem_block_next(heap, block);
+    bool merge = dmem_block_is_unused(after);
+    dmem_block_t new_free;
+
+    /** 移出空闲链表（空闲链表节点位于空闲内存块的用户内存中，需在移动数据之前移除） **/
+    _free_list_remove(heap, free_block);
+    if(merge)
+        _free_list_remove(heap, after);
+
+    /** 重新链接，空闲内存块继承可移动内存块的标志位 **/
+    free_block->next = dmem_block_offset(heap, after);
+    after->prev = dmem_block_offset(heap, free_block);
+    free_block->used = block->used;
+
+    /** 前移用户数据（含句柄前缀），源与目标可能重叠 **/
+    memmove(dmem_block_mem_addr(free_block), dmem_block_mem_addr(block), size);
+
+    /** 数据移动完成后再创建新的空闲内存块，避免新的信息头覆盖尚未移动的数据 **/
+    new_free = _insert_block_after(heap, free_block, size);
+    if(merge)
+        _merge_free_blocks(heap, new_free, after);
+    _free_list_insert(heap, new_free);
+    _purge_freed(heap, new_free);
+
+    dmem_handle_slot_of(heap, dmem_handle_of_block(free_block))->mem = dmem_block_mem_addr(free_block) + dmem_handle_prefix();
+    _event(heap, DMEM_EVENT_LEVEL_DEBUG, DMEM_EVENT_COMPACT, dmem_block_offset(heap, free_block), size);
+    return free_block;
+}
+
+/**
+ * @brief 紧凑整理：从首内存块开始，将未锁定的可移动内存块依次滑动到其前方的空闲内存块处
+ * @note 该函数不具备线程安全
+ * @param heap 内存堆
+ * @param budget 本次最多移动的用户内存字节数，为 0 时不限制；每次调用至少移动一个内存块
+ * @return true 已完成整个内存块链表的整理，false 因达到 budget 而提前结束
+ */
+static bool _compact(dmem_heap_t heap, size_t budget)
+{
+    dmem_block_t pos, next;
+    size_t moved = 0;
+
+    for(pos = dmem_head_block(heap); pos != dmem_tail_block(heap); pos = dmem_block_next(heap, pos))
+    {
+        if(!dmem_block_is_unused(pos))
+            continue;
+        next = dmem_block_next(heap, pos);
+        if(!_handle_block_movable(heap, next))
+            continue;
+        if(budget != 0 && moved >= budget)
+            return false;
+        moved += dmem_block_mem_size(heap, next);
+
+        /** 下一轮检查新的空闲内存块之后是否还有可移动的内存块 **/
+        pos = _compact_slide(heap, pos, next);
+    }
+    return true;
+}
+
+/**
+ * @brief 从内存堆中分配可移动的内存
+ * @note 可移动内存块不经过小对象分配器、大内存直接映射与线程缓存，只能通过 dmem_heap_hfree() 释放
+ * @param heap 内存堆
+ * @param size 需要分配的内存的大小
+ * @return dmem_handle_t 句柄，分配失败时返回 DMEM_HANDLE_NULL
+ */
+dmem_handle_t dmem_heap_halloc(dmem_heap_t heap, size_t size)
+{
+    dmem_handle_t handle;
+    char* mem = NULL;
+
+    if(size == 0 || size > SIZE_MAX - dmem_handle_prefix())
+        return DMEM_HANDLE_NULL;
+    size += dmem_handle_prefix();
+
+    dmem_get_lock(heap);
+    if((handle = _handle_pop(heap)) != DMEM_HANDLE_NULL)
+    {
+        mem = (char*) _alloc(heap, size);
+        if(mem == NULL && _grow(heap, size))
+            mem = (char*) _alloc(heap, size);
+        if(mem == NULL)
+        {
+            _handle_push(heap, handle);
+            handle = DMEM_HANDLE_NULL;
+        }
+    }
+    if(mem != NULL)
+    {
+        dmem_block_entry(mem)->used |= DMEM_BLOCK_MOVABLE;
+        *(dmem_handle_t*) mem = handle;
+        dmem_handle_slot_of(heap, handle)->mem = mem + dmem_handle_prefix();
+        heap->handle_count++;
+        heap->alloc_count++;
+    }
+    else
+        heap->fail_count++;
+    _heap_unlock(heap);
+    return handle;
+}
+
+/**
+ * @brief 锁定句柄并获取内存地址，锁定期间内存块不会被移动
+ * @note 锁定可以嵌套，需调用相同次数的 dmem_heap_hunlock() 解锁
+ * @param heap 内存堆
+ * @param handle 句柄
+ * @return void* 内存地址，句柄无效时返回 NULL
+ */
+void* dmem_heap_hlock(dmem_heap_t heap, dmem_handle_t handle)
+{
+    struct dmem_handle_slot* slot;
+    void* mem = NULL;
+
+    dmem_get_lock(heap);
+    if((slot = _handle_slot(heap, handle)) != NULL)
+    {
+        slot->lock++;
+        mem = slot->mem;
+    }
+    dmem_rel_lock(heap);
+    return mem;
+}
+
+/**
+ * @brief 解锁句柄，完全解锁后之前获取的内存地址可能失效
+ * @param heap 内存堆
+ * @param handle 句柄
+ * @return int  - DMEM_ERR_NONE           : 解锁成功
+ *              - DMEM_HANDLE_INVALID     : 句柄无效或未被锁定
+ */
+int dmem_heap_hunlock(dmem_heap_t heap, dmem_handle_t handle)
+{
+    struct dmem_handle_slot* slot;
+    int ret = DMEM_HANDLE_INVALID;
+
+    dmem_get_lock(heap);
+    if((slot = _handle_slot(heap, handle)) != NULL && slot->lock > 0)
+    {
+        slot->lock--;
+        ret = DMEM_ERR_NONE;
+    }
+    dmem_rel_lock(heap);
+    return ret;
+}
+
+/**
+ * @brief 释放句柄及其内存
+ * @param heap 内存堆
+ * @param handle 句柄
+ * @return int  - DMEM_ERR_NONE           : 释放成功
+ *              - DMEM_HANDLE_INVALID     : 句柄无效或已释放
+ *              - DMEM_HANDLE_LOCKED      : 句柄仍处于锁定状态
+ */
+int dmem_heap_hfree(dmem_heap_t heap, dmem_handle_t handle)
+{
+    struct dmem_handle_slot* slot;
+    char* mem;
+    int ret;
+
+    dmem_get_lock(heap);
+    if((slot = _handle_slot(heap, handle)) == NULL)
+        ret = DMEM_HANDLE_INVALID;
+    else if(slot->lock > 0)
+        ret = DMEM_HANDLE_LOCKED;
+    else
+    {
+        mem = slot->mem - dmem_handle_prefix();
+        dmem_block_entry(mem)->used &= (uint16_t) ~DMEM_BLOCK_MOVABLE;
+        if((ret = _free(heap, mem)) == DMEM_ERR_NONE)
+            heap->free_count++;
+        _handle_push(heap, handle);
+        heap->handle_count--;
+    }
+    _heap_unlock(heap);
+    return ret;
+}
+
+/**
+ * @brief 紧凑整理内存堆，将未锁定的可移动内存块向前滑动，使空闲内存块合并
+ * @note 整理可以分多次进行：budget 限制单次调用移动的字节数，未完成时下一次调用从首内存块重新开始，
+ *       已整理的部分只需遍历而无需移动。调用期间持有内存堆的线程锁
+ * @param heap 内存堆
+ * @param budget 本次最多移动的用户内存字节数，为 0 时不限制；每次调用至少移动一个内存块
+ * @return true 整理已完成，false 因达到 budget 而提前结束
+ */
+bool dmem_heap_compact(dmem_heap_t heap, size_t budget)
+{
+    bool done;
+
+    dmem_get_lock(heap);
+    done = _compact(heap, budget);
+    _heap_unlock(heap);
+    return done;
+}
+#endif
+
+#if ENABLE_DMEM_ARENA
+/**
+ * ----------------------------------------------------------------------------
+ * 多分区内存堆 (arena)
+ * 内存池被等分为 count 个分区，每个分区都是独立的内存堆，拥有各自的内存块链表和线程锁，
+ * 线程按 DMEM_ARENA_POLICY 分配到某个分区，不同线程的分配请求可以并行处理。
+ * 分区连续排列且大小相同，释放时用地址除以分区大小即可找到所属的分区。
+ * 所选分区空间不足时，依次尝试其他分区。
+ * ----------------------------------------------------------------------------
+ */
+DMEM_STATIC_ASSERT(arena_count, DMEM_ARENA_COUNT >= 1 && DMEM_ARENA_COUNT <= DMEM_ARENA_MAX);
+
+#if DMEM_ARENA_POLICY == DMEM_ARENA_CPU_ID
+extern int dmem_get_cpu_id(void);
+#else
+static unsigned int arena_next_slot = 0;                    /** 下一个线程的分区序号 **/
+static DMEM_THREAD_LOCAL int arena_slot = -1;               /** 当前线程的分区序号 **/
+#endif
+
+/**
+ * @brief 获取当前线程使用的分区序号
+ * @param arenas 多分区内存堆
+ * @return int 
+ */
+static int _arena_select(dmem_arenas_t arenas)
+{
+#if DMEM_ARENA_POLICY == DMEM_ARENA_CPU_ID
+    return (int)((unsigned int) dmem_get_cpu_id() % (unsigned int) arenas->count);
+#else
+    if(arena_slot < 0)
+    {
+        /** 线程首次使用时按轮询分配序号，借用第一个分区的线程锁保护计数器 **/
+        dmem_get_lock(&arenas->heaps[0]);
+        arena_slot = (int)(arena_next_slot++ % DMEM_ARENA_MAX);
+        dmem_rel_lock(&arenas->heaps[0]);
+    }
+    return arena_slot % arenas->count;
+#endif
+}
+
+/**
+ * @brief 查找内存地址所属的分区
+ * @param arenas 多分区内存堆
+ * @param mem 内存地址
+ * @return dmem_heap_t 若地址不在内存池中则返回 NULL
+ */
+static dmem_heap_t _arena_of(dmem_arenas_t arenas, void* mem)
+{
+    size_t index;
+#if ENABLE_DMEM_GROW || ENABLE_DMEM_HUGE
+    /** 分区之后添加的内存区域及直接映射的大内存位于内存池之外，逐个分区查找 **/
+    if((char*) mem < arenas->base || (size_t)((char*) mem - arenas->base) >= arenas->stride * (size_t) arenas->count)
+    {
+        for(index = 0; index < (size_t) arenas->count; index++)
+        {
+#if ENABLE_DMEM_GROW
+            if(dmem_mem_in_pool(&arenas->heaps[index], mem))
+                return &arenas->heaps[index];
+#endif
+#if ENABLE_DMEM_HUGE
+            if(_huge_owned(&arenas->heaps[index], mem))
+                return &arenas->heaps[index];
+#endif
+        }
+        if((char*) mem < arenas->base)
+            return NULL;
+    }
+#else
+    if((char*) mem < arenas->base)
+        return NULL;
+#endif
+    index = (size_t)((char*) mem - arenas->base) / arenas->stride;
+    if(index >= (size_t) arenas->count)
+        index = (size_t) arenas->count - 1;     // 最后一个分区包含内存池末尾的剩余部分
+    return &arenas->heaps[index];
+}
+
+/**
+ * @brief 从当前线程的分区分配内存，空间不足时依次尝试其他分区
+ * @param arenas 多分区内存堆
+ * @param size 内存大小
+ * @param zero 是否将内存初始化为 0
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+static void* _arenas_alloc(dmem_arenas_t arenas, size_t size, bool zero)
+{
+    int start = _arena_select(arenas);
+    int i;
+    void* p = NULL;
+
+    for(i = 0; p == NULL && i < arenas->count; i++)
+    {
+        dmem_heap_t heap = &arenas->heaps[(start + i) % arenas->count];
+        p = zero ? dmem_heap_calloc(heap, 1, size) : dmem_heap_alloc(heap, size);
+    }
+    return p;
+}
+
+/**
+ * @brief 初始化多分区内存堆，将内存池等分为 count 个分区
+ * @note 各分区的 heap->lock 不会被修改，移植层可为每个分区使用独立的线程锁
+ * @param arenas 多分区内存堆
+ * @param pool 内存池地址
+ * @param size 内存池可使用的大小
+ * @param count 分区数量，取值 1~DMEM_ARENA_MAX
+ * @return int  - DMEM_ERR_NONE           : 初始化成功
+ *              - DMEM_INIT_ARENA_COUNT   : 分区数量无效
+ *              - 其余参考 dmem_heap_init()
+ */
+int dmem_arenas_init(dmem_arenas_t arenas, void* pool, size_t size, int count)
+{
+    int i, res;
+
+    if(arenas == NULL)
+        return DMEM_INIT_HEAP_NULL;
+    if(count < 1 || count > DMEM_ARENA_MAX)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Invalid arena count: %d", count);
+        return DMEM_INIT_ARENA_COUNT;
+    }
+    if(pool == NULL)
+        return DMEM_INIT_POOL_NULL;
+
+    arenas->count = count;
+    arenas->base = (char*) pool;
+#if ENABLE_DMEM_TAG
+    memset(&arenas->tag_budget, 0, sizeof(arenas->tag_budget));
+#endif
+    arenas->stride = (size / (size_t) count) & ~(size_t)(DMEM_DEFINE_ALIGN_SIZE - 1);
+    for(i = 0; i < count; i++)
+    {
+        size_t arena_size = (i == count - 1) ? size - arenas->stride * (size_t) i : arenas->stride;
+        res = dmem_heap_init(&arenas->heaps[i], arenas->base + arenas->stride * (size_t) i, arena_size);
+        if(res != DMEM_ERR_NONE)
+            return res;
+#if ENABLE_DMEM_TAG
+        arenas->heaps[i].tag_budget = &arenas->tag_budget;
+#endif
+    }
+
+    dmem_trace(DMEM_LEVEL_INFO, "Initialized %d arenas | Arena size: %lu bytes", count, (unsigned long)arenas->stride);
+    return DMEM_ERR_NONE;
+}
+
+/**
+ * @brief 初始化多分区内存堆，并声明内存池的内容全部为 0，参考 dmem_heap_init_zeroed()
+ * @param arenas 多分区内存堆
+ * @param pool 内存池地址，内容必须全部为 0
+ * @param size 内存池可使用的大小
+ * @param count 分区数量，取值 1~DMEM_ARENA_MAX
+ * @return int 参考 dmem_arenas_init()
+ */
+int dmem_arenas_init_zeroed(dmem_arenas_t arenas, void* pool, size_t size, int count)
+{
+    int i, res = dmem_arenas_init(arenas, pool, size, count);
+
+    if(res == DMEM_ERR_NONE)
+    {
+        for(i = 0; i < arenas->count; i++)
+            arenas->heaps[i].dirty = dmem_block_size() + sizeof(struct dmem_free_node);
+    }
+    return res;
+}
+
+/**
+ * @brief 获取当前线程使用的分区
+ * @param arenas 多分区内存堆
+ * @return dmem_heap_t 
+ */
+dmem_heap_t dmem_arenas_heap(dmem_arenas_t arenas)
+{
+    return &arenas->heaps[_arena_select(arenas)];
+}
+
+/**
+ * @brief 从多分区内存堆中分配连续的空间
+ * @param arenas 多分区内存堆
+ * @param size 需要分配的内存的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_arenas_alloc(dmem_arenas_t arenas, size_t size)
+{
+    return _arenas_alloc(arenas, size, false);
+}
+
+/**
+ * @brief 从多分区内存堆中重新分配连续的空间，所属分区无法满足时迁移到其他分区
+ * @param arenas 多分区内存堆
+ * @param old_mem 旧的被分配的内存
+ * @param new_size 新的被指定的内存大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL（或原地址）
+ */
+void* dmem_arenas_realloc(dmem_arenas_t arenas, void* old_mem, size_t new_size)
+{
+    dmem_heap_t heap;
+    dmem_size_t usable;
+    void* new_mem;
+
+    if(old_mem == NULL)
+        return _arenas_alloc(arenas, new_size, false);
+    if((heap = _arena_of(arenas, old_mem)) == NULL)
+        return NULL;
+
+    new_mem = dmem_heap_realloc(heap, old_mem, new_size);
+    if(new_mem != old_mem || new_size == 0)
+        return new_mem;
+
+    /** 原分区无法扩展时返回原地址，此时改为从其他分区分配 **/
+    dmem_get_lock(heap);
+    usable = _usable_size(heap, old_mem);
+    dmem_rel_lock(heap);
+    if(usable == 0 || usable >= new_size)
+        return old_mem;
+    if((new_mem = _arenas_alloc(arenas, new_size, false)) == NULL)
+        return old_mem;
+    memcpy(new_mem, old_mem, usable);
+    dmem_heap_free(heap, old_mem);
+    return new_mem;
+}
+
+/**
+ * @brief 从多分区内存堆中分配指定大小和数量的连续空间，并自动将已分配的内存初始化为 0
+ * @param arenas 多分区内存堆
+ * @param count 对象的数量
+ * @param size 对象的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_arenas_calloc(dmem_arenas_t arenas, size_t count, size_t size)
+{
+    if(size != 0 && count > SIZE_MAX / size)
+        return NULL;
+    return _arenas_alloc(arenas, count * size, true);
+}
+
+/**
+ * @brief 从多分区内存堆中分配起始地址按 align 对齐的连续空间，空间不足时依次尝试其他分区
+ * @param arenas 多分区内存堆
+ * @param align 地址对齐大小，必须为 2 的幂
+ * @param size 需要分配的内存的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_arenas_aligned_alloc(dmem_arenas_t arenas, size_t align, size_t size)
+{
+    int start = _arena_select(arenas);
+    int i;
+    void* p = NULL;
+
+    for(i = 0; p == NULL && i < arenas->count; i++)
+        p = dmem_heap_aligned_alloc(&arenas->heaps[(start + i) % arenas->count], align, size);
+    return p;
+}
+
+/**
+ * @brief 释放从多分区内存堆中分配的内存，内存将归还其所属的分区
+ * @param arenas 多分区内存堆
+ * @param mem 待释放的内存
+ * @return int 参考 dmem_heap_free()
+ */
+int dmem_arenas_free(dmem_arenas_t arenas, void* mem)
+{
+    dmem_heap_t heap;
+    if(mem == NULL)
+        return DMEM_FREE_NULL;
+    if((heap = _arena_of(arenas, mem)) == NULL)
+        return DMEM_FREE_INVALID_MEM;
+    return dmem_heap_free(heap, mem);
+}
+
+/**
+ * @brief 从多分区内存堆中批量分配 n 个相同大小的内存，当前线程的分区不足时依次从其他分区补足
+ * @param arenas 多分区内存堆
+ * @param size 每个内存的大小
+ * @param n 需要分配的数量
+ * @param ptrs 用于返回内存地址的数组，长度不小于 n
+ * @return size_t 实际分配的数量
+ */
+size_t dmem_arenas_alloc_batch(dmem_arenas_t arenas, size_t size, size_t n, void* ptrs[])
+{
+    int start = _arena_select(arenas);
+    size_t count = 0;
+    int i;
+
+    for(i = 0; count < n && i < arenas->count; i++)
+        count += dmem_heap_alloc_batch(&arenas->heaps[(start + i) % arenas->count], size, n - count, ptrs + count);
+    return count;
+}
+
+/**
+ * @brief 批量释放从多分区内存堆中分配的内存，每个分区只获取一次线程锁
+ * @param arenas 多分区内存堆
+ * @param ptrs 待释放的内存地址数组，NULL 将被忽略
+ * @param n 数组长度
+ * @return int 参考 dmem_heap_free_batch()，不属于任何分区的地址返回 DMEM_FREE_INVALID_MEM
+ */
+int dmem_arenas_free_batch(dmem_arenas_t arenas, void* const ptrs[], size_t n)
+{
+    int res = DMEM_ERR_NONE;
+    size_t k;
+    int i;
+
+    for(k = 0; k < n; k++)
+        if(ptrs[k] != NULL && _arena_of(arenas, ptrs[k]) == NULL)
+            res = DMEM_FREE_INVALID_MEM;
+    for(i = 0; i < arenas->count; i++)
+    {
+        dmem_heap_t heap = &arenas->heaps[i];
+        int err;
+        dmem_get_lock(heap);
+        err = _free_batch(heap, ptrs, n, true);
+        _heap_unlock(heap);
+        if(err != DMEM_ERR_NONE && res == DMEM_ERR_NONE)
+            res = err;
+    }
+    return res;
+}
+
+/**
+ * @brief 读取多分区内存堆的扩展统计信息，最大空闲内存块取各分区的最大值，其余各项为所有分区之和
+ * @param arenas 多分区内存堆
+ * @param result 用户填入的扩展统计结构体，由函数内部填充
+ */
+void dmem_arenas_stats(dmem_arenas_t arenas, struct dmem_stats* result)
+{
+    struct dmem_stats part;
+    int i, bin;
+
+    memset(result, 0, sizeof(struct dmem_stats));
+    for(i = 0; i < arenas->count; i++)
+    {
+        dmem_heap_stats(&arenas->heaps[i], &part);
+        result->free_blocks += part.free_blocks;
+        if(part.largest_free > result->largest_free)
+            result->largest_free = part.largest_free;
+        for(bin = 0; bin < DMEM_STATS_HIST_BINS; bin++)
+            result->free_hist[bin] += part.free_hist[bin];
+        result->waste += part.waste;
+        result->purged += part.purged;
+        result->huge += part.huge;
+        result->huge_count += part.huge_count;
+        result->alloc_count += part.alloc_count;
+        result->free_count += part.free_count;
+        result->fail_count += part.fail_count;
+    }
+}
+
+/**
+ * @brief 依次遍历各分区的内存块，参考 dmem_heap_walk()
+ * @note 偏移量相对第一个分区的起始地址，各分区分别加锁，不同分区的内存块不是同一时刻的快照
+ * @param arenas 多分区内存堆
+ * @param cb 回调函数，返回 false 时停止遍历
+ * @param ctx 回调函数的参数
+ * @return size_t 报告的内存块数量
+ */
+size_t dmem_arenas_walk(dmem_arenas_t arenas, dmem_walk_cb_t cb, void* ctx)
+{
+    size_t count = 0;
+    bool stop = false;
+    int i;
+
+    for(i = 0; i < arenas->count && !stop; i++)
+        count += _walk(&arenas->heaps[i], (dmem_size_t)(arenas->heaps[i].pool - arenas->base), cb, ctx, &stop);
+    return count;
+}
+
+#if ENABLE_DMEM_TAG
+/**
+ * @brief 设置标签在整个多分区内存堆中的预算，参考 dmem_heap_tag_set_limit()
+ * @note 各分区共享同一预算，分配时在共享预算中原子地预留，不同分区同时分配也不会共同超出预算
+ * @param arenas 多分区内存堆
+ * @param tag 标签
+ * @param limit 预算，单位：字节，为 0 时不限制
+ * @return int 参考 dmem_heap_tag_set_limit()
+ */
+int dmem_arenas_tag_set_limit(dmem_arenas_t arenas, uint8_t tag, size_t limit)
+{
+    if(!dmem_tag_is_valid(tag))
+        return DMEM_TAG_INVALID;
+    dmem_atomic_store(&arenas->tag_budget.limit[tag], limit > dmem_offset_max() ? dmem_offset_max() : (dmem_size_t) limit);
+    return DMEM_ERR_NONE;
+}
+
+/**
+ * @brief 读取标签在各分区的使用统计之和，参考 dmem_heap_tag_stats()
+ * @note limit 为整个多分区内存堆共享的预算，peak_bytes 为各分区峰值之和（不小于整体的峰值）
+ * @param arenas 多分区内存堆
+ * @param tag 标签
+ * @param result 用于返回统计结果
+ * @return int 参考 dmem_heap_tag_stats()
+ */
+int dmem_arenas_tag_stats(dmem_arenas_t arenas, uint8_t tag, struct dmem_tag_stats* result)
+{
+    struct dmem_tag_stats part;
+    int i;
+
+    if(!dmem_tag_is_valid(tag))
+        return DMEM_TAG_INVALID;
+    memset(result, 0, sizeof(struct dmem_tag_stats));
+    for(i = 0; i < arenas->count; i++)
+    {
+        dmem_heap_tag_stats(&arenas->heaps[i], tag, &part);
+        result->live_bytes += part.live_bytes;
+        result->peak_bytes += part.peak_bytes;
+        result->limit = part.limit;
+        result->live_count += part.live_count;
+        result->alloc_count += part.alloc_count;
+        result->fail_count += part.fail_count;
+        result->alloc_bytes += part.alloc_bytes;
+    }
+    return DMEM_ERR_NONE;
+}
+#endif
+
+/**
+ * @brief 读取多分区内存堆的内存使用报告，各项为所有分区之和
+ * @note max_usage 为各分区最大内存消耗之和，可能大于整体实际出现过的最大内存消耗
+ * @param arenas 多分区内存堆
+ * @param result 用户填入的内存使用报告结构体，由函数内部填充
+ */
+void dmem_arenas_report(dmem_arenas_t arenas, struct dmem_use_report* result)
+{
+    struct dmem_use_report part;
+    int i;
+
+    memset(result, 0, sizeof(struct dmem_use_report));
+    for(i = 0; i < arenas->count; i++)
+    {
+        dmem_heap_report(&arenas->heaps[i], &part);
+        result->free += part.free;
+        result->max_usage += part.max_usage;
+        result->initf += part.initf;
+        result->used_count += part.used_count;
+    }
+}
+#endif
+
+#if ENABLE_DMEM_BUMP
+/**
+ * ----------------------------------------------------------------------------
+ * 指针碰撞分配器 (bump)
+ * 通过 dmem_heap_alloc() 从内存堆中申请块，块首为 struct dmem_bump_chunk，其后的空间按顺序分配，
+ * 分配时只需对齐并移动 ptr，当前块空间不足时申请新块，旧块的剩余部分不再使用。
+ * 块按申请顺序链接成栈，标记记录当前块与分配位置，释放到标记时只需归还标记之后申请的块并恢复分配位置，
+ * 因此标记可以任意嵌套，但须按与标记相反的顺序释放。
+ * ----------------------------------------------------------------------------
+ */
+DMEM_STATIC_ASSERT(bump_chunk_size, DMEM_BUMP_CHUNK_SIZE > 0);
+
+/**
+ * @brief 指针碰撞分配器的块信息头
+ */
+struct dmem_bump_chunk
+{
+    struct dmem_bump_chunk* prev;   /** 前一个（较早申请的）块 **/
+    size_t size;                    /** 块大小（含信息头） **/
+};
+
+#define dmem_bump_chunk_head()          MAKE_ALLOC_SIZE_ALIGN(sizeof(struct dmem_bump_chunk))
+#define dmem_bump_chunk_data(chunk)     ((char*)(chunk) + dmem_bump_chunk_head())
+#define dmem_bump_chunk_end(chunk)      ((char*)(chunk) + (chunk)->size)
+#define dmem_bump_align_up(p, align)    ((char*)(((uintptr_t)(p) + ((align) - 1)) & ~(uintptr_t)((align) - 1)))
+
+/**
+ * @brief 申请新块并从中分配
+ * @param bump 指针碰撞分配器
+ * @param align 对齐大小
+ * @param size 分配大小
+ * @return void* 若内存堆空间不足则返回 NULL
+ */
+static void* _bump_alloc_slow(dmem_bump_t bump, size_t align, size_t size)
+{
+    struct dmem_bump_chunk* chunk;
+    size_t need;
+    char* p;
+
+    /** 内存堆返回的地址按 DMEM_DEFINE_ALIGN_SIZE 对齐，更大的对齐需预留填充 **/
+    if(size > SIZE_MAX - dmem_bump_chunk_head() - align)
+        return NULL;
+    need = dmem_bump_chunk_head() + size + (align > DMEM_DEFINE_ALIGN_SIZE ? align - DMEM_DEFINE_ALIGN_SIZE : 0);
+    if(need < bump->chunk_size)
+        need = bump->chunk_size;
+    if((chunk = (struct dmem_bump_chunk*) dmem_heap_alloc(bump->heap, need)) == NULL)
+    {
+        dmem_trace(DMEM_LEVEL_WARNING, "Bump chunk alloc failed | Size: %lu bytes", (unsigned long)need);
+        return NULL;
+    }
+
+    chunk->prev = bump->chunk;
+    chunk->size = need;
+    if(bump->chunk == NULL)
+        bump->first = chunk;
+    bump->chunk = chunk;
+    bump->end = dmem_bump_chunk_end(chunk);
+    bump->size += need;
+    bump->chunk_count++;
+
+    p = dmem_bump_align_up(dmem_bump_chunk_data(chunk), align);
+    bump->ptr = p + size;
+    return p;
+}
+
+/**
+ * @brief 归还 chunk 之后申请的块
+ * @param bump 指针碰撞分配器
+ * @param chunk 保留的块，为 NULL 时归还全部块
+ */
+static void _bump_pop_to(dmem_bump_t bump, struct dmem_bump_chunk* chunk)
+{
+    while(bump->chunk != chunk && bump->chunk != NULL)
+    {
+        struct dmem_bump_chunk* top = bump->chunk;
+        bump->chunk = top->prev;
+        bump->size -= top->size;
+        bump->chunk_count--;
+        dmem_heap_free(bump->heap, top);
+    }
+    if(bump->chunk == NULL)
+        bump->first = NULL;
+}
+
+/**
+ * @brief 初始化指针碰撞分配器，初始化时不申请块
+ * @param bump 指针碰撞分配器
+ * @param heap 申请块的内存堆
+ * @param chunk_size 块大小（含块信息头），为 0 时使用 DMEM_BUMP_CHUNK_SIZE
+ * @return int 错误码
+ */
+int dmem_bump_init(dmem_bump_t bump, dmem_heap_t heap, size_t chunk_size)
+{
+    if(bump == NULL || heap == NULL)
+        return DMEM_BUMP_INVALID;
+    memset(bump, 0, sizeof(struct dmem_bump));
+    bump->heap = heap;
+    bump->chunk_size = chunk_size ? chunk_size : DMEM_BUMP_CHUNK_SIZE;
+    return DMEM_ERR_NONE;
+}
+
+/**
+ * @brief 分配按 DMEM_DEFINE_ALIGN_SIZE 对齐的内存，只能通过 dmem_bump_release()/dmem_bump_reset() 成批释放
+ * @param bump 指针碰撞分配器
+ * @param size 分配大小
+ * @return void* 若分配失败或 size 为 0 则返回 NULL
+ */
+void* dmem_bump_alloc(dmem_bump_t bump, size_t size)
+{
+    char* p = bump->ptr;
+
+    if(size == 0 || size > SIZE_MAX - DMEM_DEFINE_ALIGN_SIZE)
+        return NULL;
+    size = MAKE_ALLOC_SIZE_ALIGN(size);
+    if(size <= (size_t)(bump->end - p))
+    {
+        bump->ptr = p + size;
+        return p;
+    }
+    return _bump_alloc_slow(bump, DMEM_DEFINE_ALIGN_SIZE, size);
+}
+
+/**
+ * @brief 分配起始地址按 align 对齐的内存
+ * @param bump 指针碰撞分配器
+ * @param align 地址对齐大小，必须为 2 的幂
+ * @param size 分配大小
+ * @return void* 若分配失败、size 为 0 或 align 无效则返回 NULL
+ */
+void* dmem_bump_aligned_alloc(dmem_bump_t bump, size_t align, size_t size)
+{
+    char* p;
+
+    if(align == 0 || (align & (align - 1)) != 0)
+    {
+        dmem_trace(DMEM_LEVEL_ERROR, "Alignment must be a power of two: %lu", (unsigned long)align);
+        return NULL;
+    }
+    if(align < DMEM_DEFINE_ALIGN_SIZE)
+        align = DMEM_DEFINE_ALIGN_SIZE;
+    if(size == 0 || size > SIZE_MAX - DMEM_DEFINE_ALIGN_SIZE)
+        return NULL;
+    size = MAKE_ALLOC_SIZE_ALIGN(size);
+    p = dmem_bump_align_up(bump->ptr, align);
+    if(p <= bump->end && size <= (size_t)(bump->end - p))
+    {
+        bump->ptr = p + size;
+        return p;
+    }
+    return _bump_alloc_slow(bump, align, size);
+}
+
+/**
+ * @brief 标记当前的分配位置
+ * @param bump 指针碰撞分配器
+ * @return struct dmem_bump_marker 标记，传给 dmem_bump_release() 释放此后分配的全部内存
+ */
+struct dmem_bump_marker dmem_bump_mark(dmem_bump_t bump)
+{
+    struct dmem_bump_marker mark;
+    mark.chunk = bump->chunk;
+    mark.ptr = bump->ptr;
+    return mark;
+}
+
+/**
+ * @brief 释放标记之后分配的全部内存，标记之后申请的块归还内存堆
+ * @note 嵌套的标记须按与标记相反的顺序释放，释放到较早的标记后，较晚的标记失效
+ * @param bump 指针碰撞分配器
+ * @param mark dmem_bump_mark() 返回的标记
+ */
+void dmem_bump_release(dmem_bump_t bump, struct dmem_bump_marker mark)
+{
+    _bump_pop_to(bump, mark.chunk);
+    if(bump->chunk == NULL)
+    {
+        bump->ptr = NULL;
+        bump->end = NULL;
+        return;
+    }
+    bump->ptr = mark.ptr;
+    bump->end = dmem_bump_chunk_end(bump->chunk);
+}
+
+/**
+ * @brief 释放全部内存，只保留最早申请的块供之后的分配使用，其余的块归还内存堆
+ * @note 耗时只与归还的块数量有关，只有一个块时为常数，与已分配的对象数量无关
+ * @param bump 指针碰撞分配器
+ */
+void dmem_bump_reset(dmem_bump_t bump)
+{
+    struct dmem_bump_chunk* first = bump->first;
+
+    if(first == NULL)
+        return;
+    _bump_pop_to(bump, first);
+    bump->ptr = dmem_bump_chunk_data(first);
+    bump->end = dmem_bump_chunk_end(first);
+}
+
+/**
+ * @brief 释放全部内存并将所有块归还内存堆，之后仍可继续分配
+ * @param bump 指针碰撞分配器
+ */
+void dmem_bump_destroy(dmem_bump_t bump)
+{
+    _bump_pop_to(bump, NULL);
+    bump->ptr = NULL;
+    bump->end = NULL;
+}
+#endif
+
+/**
+ * @brief 获取默认内存堆
+ * @note dmem_init()/dmem_alloc() 等接口均作用于默认内存堆，使用默认多分区内存堆时返回当前线程使用的分区
+ * @return dmem_heap_t 
+ */
+dmem_heap_t dmem_default_heap(void)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_heap(&default_arenas);
+#else
+    return &default_heap;
+#endif
+}
+
+/**
+ * @brief 初始化默认内存堆
+ * @param pool 内存池地址
+ * @param size 内存池可使用的大小
+ * @return int  参考 dmem_heap_init()
+ */
+int dmem_init(void* pool, size_t size)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_init(&default_arenas, pool, size, DMEM_ARENA_COUNT);
+#else
+    return dmem_heap_init(&default_heap, pool, size);
+#endif
+}
+
+/**
+ * @brief 初始化默认内存堆，并声明内存池的内容全部为 0，参考 dmem_heap_init_zeroed()
+ * @param pool 内存池地址，内容必须全部为 0
+ * @param size 内存池可使用的大小
+ * @return int 参考 dmem_init()
+ */
+int dmem_init_zeroed(void* pool, size_t size)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_init_zeroed(&default_arenas, pool, size, DMEM_ARENA_COUNT);
+#else
+    return dmem_heap_init_zeroed(&default_heap, pool, size);
+#endif
+}
+
+/**
+ * @brief 依据指定的大小安全地分配连续的空间
+ * @param size 需要分配的内存的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_alloc(size_t size)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_alloc(&default_arenas, size);
+#else
+    return dmem_heap_alloc(&default_heap, size);
+#endif
+}
+
+/**
+ * @brief 依据指定的大小重新分配新的连续的空间，并释放旧的已分配内存
+ * @param old_mem 旧的被分配的内存
+ * @param new_size 新的被指定的内存大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_realloc(void* old_mem, size_t new_size)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_realloc(&default_arenas, old_mem, new_size);
+#else
+    return dmem_heap_realloc(&default_heap, old_mem, new_size);
+#endif
+}
+
+/**
+ * @brief 分配指定大小和数量的连续空间，并自动将已分配的内存初始化为 0
+ * @param count 对象的数量
+ * @param size 对象的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_calloc(size_t count, size_t size)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_calloc(&default_arenas, count, size);
+#else
+    return dmem_heap_calloc(&default_heap, count, size);
+#endif
+}
+
+/**
+ * @brief 分配起始地址按 align 对齐的连续空间，可用于 SIMD 数据或按缓存行对齐的缓冲区
+ * @param align 地址对齐大小，必须为 2 的幂
+ * @param size 需要分配的内存的大小
+ * @return void* 若分配成功则返回非 NULL 内存地址，反之则返回 NULL
+ */
+void* dmem_aligned_alloc(size_t align, size_t size)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_aligned_alloc(&default_arenas, align, size);
+#else
+    return dmem_heap_aligned_alloc(&default_heap, align, size);
+#endif
+}
+
+/**
+ * @brief 分配起始地址按 align 对齐的连续空间，接口语义与 POSIX posix_memalign() 相同
+ * @param memptr 用于返回内存地址，失败时不修改
+ * @param align 地址对齐大小，必须为 2 的幂且为 sizeof(void*) 的整数倍
+ * @param size 需要分配的内存的大小，为 0 时 *memptr 置为 NULL
+ * @return int  0:      分配成功
+ *              EINVAL: align 无效
+ *              ENOMEM: 内存不足
+ */
+int dmem_posix_memalign(void** memptr, size_t align, size_t size)
+{
+    void* p;
+
+    if(align == 0 || (align & (align - 1)) != 0 || (align % sizeof(void*)) != 0)
+        return EINVAL;
+    if(size == 0)
+    {
+        *memptr = NULL;
+        return 0;
+    }
+    if((p = dmem_aligned_alloc(align, size)) == NULL)
+        return ENOMEM;
+    *memptr = p;
+    return 0;
+}
+
+/**
+ * @brief 安全地释放被分配的内存
+ * @param mem 待释放的内存
+ * @return int  0:  释放成功
+ *              -1: mem 为 NULL
+ *              -2: 内存块信息无效
+ *              -3: 该内存块不可重复释放
+ */
+int dmem_free(void* mem)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_free(&default_arenas, mem);
+#else
+    return dmem_heap_free(&default_heap, mem);
+#endif
+}
+
+/**
+ * @brief 批量分配 n 个相同大小的内存，只获取一次线程锁，并尽量从同一块空闲内存中连续切分
+ * @param size 每个内存的大小
+ * @param n 需要分配的数量
+ * @param ptrs 用于返回内存地址的数组，长度不小于 n
+ * @return size_t 实际分配的数量，空间不足时小于 n，已分配的内存仍需释放
+ */
+size_t dmem_alloc_batch(size_t size, size_t n, void* ptrs[])
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_alloc_batch(&default_arenas, size, n, ptrs);
+#else
+    return dmem_heap_alloc_batch(&default_heap, size, n, ptrs);
+#endif
+}
+
+/**
+ * @brief 批量释放被分配的内存，只获取一次线程锁，相邻的内存合并后只插入一次空闲链表
+ * @param ptrs 待释放的内存地址数组，NULL 将被忽略
+ * @param n 数组长度
+ * @return int  0:  全部释放成功
+ *              <0: 遇到的第一个错误（参考 dmem_free()），其余有效的内存仍会被释放
+ */
+int dmem_free_batch(void* const ptrs[], size_t n)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_free_batch(&default_arenas, ptrs, n);
+#else
+    return dmem_heap_free_batch(&default_heap, ptrs, n);
+#endif
+}
+
+/**
+ * @brief 读取内存使用报告
+ * @note 支持可重入获取内存使用报告
+ * @param result 用户填入的内存使用报告结构体，由函数内部填充
+ */
+void dmem_read_use_report(struct dmem_use_report* result)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    dmem_arenas_report(&default_arenas, result);
+#else
+    dmem_heap_report(&default_heap, result);
+#endif
+}
+
+/**
+ * @brief 读取扩展统计信息
+ * @param result 用户填入的扩展统计结构体，由函数内部填充
+ */
+void dmem_read_stats(struct dmem_stats* result)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    dmem_arenas_stats(&default_arenas, result);
+#else
+    dmem_heap_stats(&default_heap, result);
+#endif
+}
+
+/**
+ * @brief 遍历默认内存堆的内存块，参考 dmem_heap_walk()
+ */
+size_t dmem_walk(dmem_walk_cb_t cb, void* ctx)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_walk(&default_arenas, cb, ctx);
+#else
+    return dmem_heap_walk(&default_heap, cb, ctx);
+#endif
+}
+
+#if ENABLE_DMEM_RECORD
+/**
+ * @brief 开始记录默认内存堆的分配与释放，参考 dmem_heap_record_start()
+ * @note 使用多分区内存堆时只记录当前线程所在的分区
+ */
+int dmem_record_start(struct dmem_record* buf, size_t count, dmem_record_drain_t drain, void* arg)
+{
+    return dmem_heap_record_start(dmem_default_heap(), buf, count, drain, arg);
+}
+
+/**
+ * @brief 将默认内存堆尚未取走的记录交给回调函数
+ */
+void dmem_record_flush(void)
+{
+    dmem_heap_record_flush(dmem_default_heap());
+}
+
+/**
+ * @brief 停止记录默认内存堆，参考 dmem_heap_record_stop()
+ */
+uint32_t dmem_record_stop(void)
+{
+    return dmem_heap_record_stop(dmem_default_heap());
+}
+#endif
+
+#if ENABLE_DMEM_EVENT
+/**
+ * @brief 开始记录默认内存堆的事件，参考 dmem_heap_event_start()
+ * @note 使用多分区内存堆时只记录当前线程所在的分区
+ */
+int dmem_event_start(struct dmem_event* buf, size_t count, uint8_t level)
+{
+    return dmem_heap_event_start(dmem_default_heap(), buf, count, level);
+}
+
+/**
+ * @brief 调整默认内存堆的事件级别，参考 dmem_heap_event_set_level()
+ */
+void dmem_event_set_level(uint8_t level)
+{
+    dmem_heap_event_set_level(dmem_default_heap(), level);
+}
+
+/**
+ * @brief 读出默认内存堆的事件，参考 dmem_heap_event_read()
+ */
+size_t dmem_event_read(struct dmem_event* out, size_t max, uint32_t* lost)
+{
+    return dmem_heap_event_read(dmem_default_heap(), out, max, lost);
+}
+
+/**
+ * @brief 停止记录默认内存堆的事件
+ */
+void dmem_event_stop(void)
+{
+    dmem_heap_event_stop(dmem_default_heap());
+}
+#endif
+#if ENABLE_DMEM_GROW
+/**
+ * @brief 向默认内存堆添加新的内存区域，参考 dmem_heap_add_region()
+ */
+int dmem_add_region(void* region, size_t size)
+{
+    return dmem_heap_add_region(dmem_default_heap(), region, size);
+}
+#endif
+#if ENABLE_DMEM_PURGE
+/**
+ * @brief 设置默认内存堆归还空闲页的延迟，参考 dmem_heap_set_purge_decay()
+ */
+void dmem_set_purge_decay(uint32_t decay)
+{
+    dmem_heap_set_purge_decay(dmem_default_heap(), decay);
+}
+
+/**
+ * @brief 立即归还默认内存堆的空闲页，参考 dmem_heap_purge()
+ */
+size_t dmem_purge(void)
+{
+    return dmem_heap_purge(dmem_default_heap());
+}
+#endif
+#if ENABLE_DMEM_HUGE
+/**
+ * @brief 设置默认内存堆直接映射大内存的阈值，参考 dmem_heap_set_huge_threshold()
+ */
+void dmem_set_huge_threshold(size_t threshold)
+{
+    dmem_heap_set_huge_threshold(dmem_default_heap(), threshold);
+}
+#endif
+#if ENABLE_DMEM_HANDLE
+/**
+ * @brief 从默认内存堆中分配可移动的内存，参考 dmem_heap_halloc()
+ */
+dmem_handle_t dmem_halloc(size_t size)
+{
+    return dmem_heap_halloc(dmem_default_heap(), size);
+}
+
+/**
+ * @brief 锁定默认内存堆的句柄并获取内存地址，参考 dmem_heap_hlock()
+ */
+void* dmem_hlock(dmem_handle_t handle)
+{
+    return dmem_heap_hlock(dmem_default_heap(), handle);
+}
+
+/**
+ * @brief 解锁默认内存堆的句柄，参考 dmem_heap_hunlock()
+ */
+int dmem_hunlock(dmem_handle_t handle)
+{
+    return dmem_heap_hunlock(dmem_default_heap(), handle);
+}
+
+/**
+ * @brief 释放默认内存堆的句柄及其内存，参考 dmem_heap_hfree()
+ */
+int dmem_hfree(dmem_handle_t handle)
+{
+    return dmem_heap_hfree(dmem_default_heap(), handle);
+}
+
+/**
+ * @brief 紧凑整理默认内存堆，参考 dmem_heap_compact()
+ */
+bool dmem_compact(size_t budget)
+{
+    return dmem_heap_compact(dmem_default_heap(), budget);
+}
+#endif
+#if ENABLE_DMEM_TAG
+/**
+ * @brief 从默认内存堆中分配带标签的内存，参考 dmem_heap_alloc_tagged()
+ */
+void* dmem_alloc_tagged(size_t size, uint8_t tag)
+{
+    return dmem_heap_alloc_tagged(dmem_default_heap(), size, tag);
+}
+
+/**
+ * @brief 从默认内存堆中分配带标签并初始化为 0 的内存，参考 dmem_heap_calloc_tagged()
+ */
+void* dmem_calloc_tagged(size_t count, size_t size, uint8_t tag)
+{
+    return dmem_heap_calloc_tagged(dmem_default_heap(), count, size, tag);
+}
+
+/**
+ * @brief 重新分配默认内存堆中的内存并记录标签，参考 dmem_heap_realloc_tagged()
+ * @note 使用多分区内存堆时在 old_mem 所属的分区中调整大小
+ */
+void* dmem_realloc_tagged(void* old_mem, size_t new_size, uint8_t tag)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    dmem_heap_t heap = old_mem != NULL ? _arena_of(&default_arenas, old_mem) : dmem_default_heap();
+    if(heap == NULL)
+        return NULL;
+    return dmem_heap_realloc_tagged(heap, old_mem, new_size, tag);
+#else
+    return dmem_heap_realloc_tagged(&default_heap, old_mem, new_size, tag);
+#endif
+}
+
+/**
+ * @brief 获取默认内存堆中已分配内存的标签，参考 dmem_heap_tag_of()
+ */
+int dmem_tag_of(const void* mem)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    dmem_heap_t heap = _arena_of(&default_arenas, (void*) mem);
+    return heap != NULL ? dmem_heap_tag_of(heap, mem) : 0;
+#else
+    return dmem_heap_tag_of(&default_heap, mem);
+#endif
+}
+
+/**
+ * @brief 设置默认内存堆中标签的预算，参考 dmem_heap_tag_set_limit()
+ * @note 使用多分区内存堆时为所有分区共享的预算
+ */
+int dmem_tag_set_limit(uint8_t tag, size_t limit)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_tag_set_limit(&default_arenas, tag, limit);
+#else
+    return dmem_heap_tag_set_limit(&default_heap, tag, limit);
+#endif
+}
+
+/**
+ * @brief 读取默认内存堆中标签的使用统计，参考 dmem_heap_tag_stats()
+ */
+int dmem_tag_stats(uint8_t tag, struct dmem_tag_stats* result)
+{
+#if DMEM_USE_DEFAULT_ARENAS
+    return dmem_arenas_tag_stats(&default_arenas, tag, result);
+#else
+    return dmem_heap_tag_stats(&default_heap, tag, result);
+#endif
+}
+#endif
+
 #if ENABLE_DMEM_GET_USER_REPORT_API
 /**
  * @brief 获取内存使用报告指针
- * @warning 该函数不具备可重入性，并且每次调用会触发多次查询
+ * @warning 该函数不具备可重入性
  * @return struct dmem_use_report* 
  */
 const struct dmem_use_report* dmem_get_use_report(void)
@@ -38,6 +38,48 @@
  *                                                  7. 为接口加入了返回值错误宏定义
  *                                                  8. 不再兼容 C89 标准和 8051 单片机，已支持面向 C99 以上标准和32位单片机平台。
  *                                                  9. 其他不影响使用的修改
+ * @date 2026.10.16     @version 3.0        @note   1. 新增多实例内存堆 dmem_heap_t 及 dmem_heap_xxx() 系列接口，原 dmem_xxx() 接口作为默认堆的封装予以保留
+ *                                                  2. 移植层线程锁接口 dmem_get_lock()/dmem_rel_lock() 增加内存堆参数，每个堆可使用独立的线程锁
+ *                                                  3. 新增 DMEM_OFFSET_WIDTH 配置内存块偏移量位宽(16/32/64)，内存池可超过 64 KiB，
+ *                                                     内存大小相关的接口参数改用 size_t，内存使用报告改用 dmem_size_t 计数
+ *                                                  4. 新增 TLSF 内存分配引擎，可在 dmem_conf.h 中通过 DMEM_ALLOC_ENGINE 与首次适配引擎二选一
+ *                                                  5. 首次适配引擎改用按地址排序的显式空闲链表，分配时只遍历空闲内存块
+ *                                                  6. 新增小对象分配器 (slab)，通过 dmem_heap_slab_enable() 开启后，小对象按尺寸类别从页中分配，不再携带内存块信息头
+ *                                                  7. 新增线程缓存 (ENABLE_DMEM_TCACHE)，小内存的分配与释放优先在线程局部缓存中完成，批量补充与归还内存堆
+ *                                                  8. 新增多分区内存堆 dmem_arenas_t (ENABLE_DMEM_ARENA)，内存池等分为多个独立加锁的分区，
+ *                                                     线程按轮询或 CPU 编号分配分区，释放按地址归还所属分区；DMEM_ARENA_COUNT 大于 1 时默认接口使用多分区内存堆
+ *                                                  9. 首次适配引擎新增放置策略（首次/循环首次/最佳适配及 LIFO 复用），新增碎片报告接口 dmem_heap_frag_report()
+ *                                                  10. 新增对齐分配接口 dmem_aligned_alloc()/dmem_posix_memalign()，对齐填充部分作为空闲内存块放回内存堆
+ *                                                  11. 新增批量分配/释放接口 dmem_alloc_batch()/dmem_free_batch()，只获取一次线程锁，
+ *                                                      从同一空闲内存块连续切分，释放时整段合并后只插入一次空闲链表
+ *                                                  12. 内存使用报告改为增量维护的统计值，通过序列锁 (seqlock) 快照读取，
+ *                                                      dmem_read_use_report() 耗时为常数且无需获取线程锁
+ *                                                  13. 新增扩展统计接口 dmem_read_stats()（最大空闲内存块、空闲内存块数量及大小分布、内部浪费、累计计数），
+ *                                                      增量维护最大空闲内存块的上界，超过上界的分配请求立即失败
+ *                                                  14. 新增性能测试 bench/dmem_bench.c（CMake 目标 dmem_bench），与系统 malloc 对比每次操作耗时分位数、峰值占用及碎片率
+ *                                                  15. 新增分配记录接口 dmem_record_start()（ENABLE_DMEM_RECORD），记录写入环形缓冲区并由回调函数取走，
+ *                                                      新增重放工具 bench/dmem_replay.c，可在任意内存池大小与配置下重放记录
+ *                                                  16. dmem_realloc() 后方空间不足时向空闲的前一个内存块扩展，一次 memmove() 前移数据，无需查找空闲链表
+ *                                                  17. 新增事件日志 dmem_event_start()（ENABLE_DMEM_EVENT），事件以二进制格式写入环形缓冲区，级别可在运行时调整，
+ *                                                      新增格式化工具 bench/dmem_events.c；printf 调试追踪 ENABLE_DMEM_TRACE 默认关闭
+ *                                                  18. 新增 dmem_heap_init_zeroed()/dmem_init_zeroed()，记录内存池中从未写入的部分，dmem_calloc() 只清零可能被写过的部分，
+ *                                                      清零移到线程锁之外；dmem_calloc() 检查 count * size 溢出
+ *                                                  19. 新增可增长的内存堆（ENABLE_DMEM_GROW）：dmem_add_region() 添加新的内存区域，内存区域之间通过哨兵内存块链接，
+ *                                                      开启自动增长后分配失败时通过移植层 dmem_get_region() 获取新的内存区域
+ *                                                  20. 新增空闲页归还（ENABLE_DMEM_PURGE）：大空闲内存块中的整页通过移植层 dmem_purge_pages() 归还系统，
+ *                                                      可立即、延迟或手动 dmem_purge() 归还，已归还的空闲内存块不会被重复归还
+ *                                                  21. 新增大内存直接映射（ENABLE_DMEM_HUGE）：不小于阈值的分配请求通过移植层 dmem_map_huge() 单独映射，不再占用内存池，
+ *                                                      dmem_realloc() 通过 dmem_remap_huge() 调整映射大小而无需复制数据
+ *                                                  22. 新增 C++ 适配头文件 dmem.hpp：STL 分配器 dmem::allocator<T> 与 std::pmr::memory_resource 子类 dmem::memory_resource，
+ *                                                      新增 C++ 容器性能测试 bench/dmem_bench_cpp.cpp；DMEM_ALIGNED() 在 C++ 中使用 alignas
+ *                                                  23. 新增指针碰撞分配器 dmem_bump_xxx()（ENABLE_DMEM_BUMP）：从内存堆中按块申请内存，分配只需移动指针，
+ *                                                      支持嵌套的 dmem_bump_mark()/dmem_bump_release() 成批释放及 dmem_bump_reset() 整体释放
+ *                                                  24. 新增可移动的句柄分配（ENABLE_DMEM_HANDLE）：dmem_halloc() 返回句柄，dmem_hlock()/dmem_hunlock() 之间访问内存，
+ *                                                      dmem_compact() 将未锁定的内存块向前滑动以合并空闲内存块，可按移动的字节数分步进行
+ *                                                  25. 新增内存块遍历接口 dmem_walk()，依次报告各内存块的偏移量、大小与状态，
+ *                                                      新增碎片分布图工具 bench/dmem_fragmap.c，以字符条或 JSON 输出空闲内存块的位置与大小
+ *                                                  26. 新增带标签的内存分配（ENABLE_DMEM_TAG）：dmem_alloc_tagged() 等接口在内存块中记录标签，
+ *                                                      按标签统计存活字节数、存活数量、峰值及累计分配次数，并可为标签设置预算
  */
 #ifndef DMEM_H
 #define DMEM_H
@@ -58,9 +100,51 @@ extern "C" {
 /**
  * @brief 版本
  */
-#define DMEM_MAIN_VER       2
+#define DMEM_MAIN_VER       3
 #define DMEM_SUB_VER        0
-#define DMEM_UPDATE_STR     "2025.08.10"
+#define DMEM_UPDATE_STR     "2026.10.16"
+
+/**
+ * @brief 内存块偏移量与内存大小计数类型，由 DMEM_OFFSET_WIDTH 决定
+ */
+#if DMEM_OFFSET_WIDTH == 16
+    typedef uint16_t dmem_off_t;
+    typedef uint32_t dmem_size_t;
+#elif DMEM_OFFSET_WIDTH == 32
+    typedef uint32_t dmem_off_t;
+    typedef uint64_t dmem_size_t;
+#elif DMEM_OFFSET_WIDTH == 64
+    typedef uint64_t dmem_off_t;
+    typedef uint64_t dmem_size_t;
+#else
+    #error "DMEM_OFFSET_WIDTH must be 16, 32 or 64"
+#endif
+
+/**
+ * @brief TLSF 引擎的索引规模及位图类型
+ */
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_TLSF
+    #define DMEM_TLSF_FL_COUNT      DMEM_OFFSET_WIDTH
+    #define DMEM_TLSF_SL_COUNT      (1 << DMEM_TLSF_SL_LOG2)
+    #if DMEM_TLSF_FL_COUNT > 32
+        typedef uint64_t dmem_tlsf_map_t;
+    #else
+        typedef uint32_t dmem_tlsf_map_t;
+    #endif
+#endif
+
+/**
+ * @brief 小对象分配器与线程缓存的尺寸类别数量及可服务的最大对象大小
+ */
+#if ENABLE_DMEM_SLAB || ENABLE_DMEM_TCACHE
+    #define DMEM_SIZE_CLASS_COUNT   10
+    #define DMEM_SIZE_CLASS_MAX     256
+#endif
+
+/**
+ * @brief 默认接口 dmem_xxx() 是否作用于多分区内存堆
+ */
+#define DMEM_USE_DEFAULT_ARENAS     (ENABLE_DMEM_ARENA && DMEM_ARENA_COUNT > 1)
 
 /**
  * @brief 函数错误码
@@ -69,9 +153,22 @@ extern "C" {
 #define DMEM_INIT_POOL_NULL         (-1)      // 内存池指针为空
 #define DMEM_INIT_SIZE_SMALL        (-2)      // 内存池大小过小
 #define DMEM_INIT_POOL_ALIGN        (-3)      // 内存池地址未对齐
+#define DMEM_INIT_HEAP_NULL         (-4)      // 内存堆指针为空
+#define DMEM_INIT_ARENA_COUNT       (-5)      // 分区数量无效
 #define DMEM_FREE_NULL              (-1)      // 内存地址为空
 #define DMEM_FREE_INVALID_MEM       (-2)      // 无效的内存地址
 #define DMEM_FREE_REPEATED          (-3)      // 重复释放内存
+#define DMEM_POLICY_INVALID         (-1)      // 无效的放置策略
+#define DMEM_RECORD_BUF_NULL        (-1)      // 记录缓冲区为空
+#define DMEM_EVENT_BUF_NULL         (-1)      // 事件缓冲区为空
+#define DMEM_EVENT_BUF_SIZE         (-2)      // 事件缓冲区容量不是 2 的幂
+#define DMEM_REGION_INVALID         (-1)      // 内存区域无效（为空、过小、不在已有内存区域之后或超出偏移量范围）
+#define DMEM_REGION_FULL            (-2)      // 内存区域数量已达 DMEM_REGION_MAX
+#define DMEM_PURGE_OFF              (0xFFFFFFFFu)   // 空闲页归还的延迟：只在调用 dmem_heap_purge() 时归还
+#define DMEM_BUMP_INVALID           (-1)      // 指针碰撞分配器或内存堆为空
+#define DMEM_HANDLE_INVALID         (-1)      // 无效的句柄
+#define DMEM_HANDLE_LOCKED          (-2)      // 句柄仍处于锁定状态
+#define DMEM_TAG_INVALID            (-1)      // 无效的标签（为 0 或超出 DMEM_TAG_COUNT）
 
 
 /**
@@ -79,18 +176,477 @@ extern "C" {
  */
 struct dmem_use_report
 {
-    uint32_t free;              /** 当前空闲内存的总大小（即使是不连续的空闲内存块也会纳入统计），单位：字节 **/
-    uint32_t max_usage;         /** 内存的最大消耗量（包含内存块信息头的占用），单位：字节 **/
-    uint32_t initf;             /** 初始化时空闲内存的大小，单位：字节 **/
-    uint32_t used_count;        /** 当前尚未释放的内存块数量 **/
+    dmem_size_t free;           /** 当前空闲内存的总大小（即使是不连续的空闲内存块也会纳入统计），单位：字节 **/
+    dmem_size_t max_usage;      /** 内存的最大消耗量（包含内存块信息头的占用），单位：字节 **/
+    dmem_size_t initf;          /** 初始化时空闲内存的大小，单位：字节 **/
+    dmem_size_t used_count;     /** 当前尚未释放的内存块数量 **/
+};
+
+/**
+ * @brief 碎片报告结构体
+ */
+struct dmem_frag_report
+{
+    dmem_size_t free_blocks;    /** 空闲内存块的数量 **/
+    dmem_size_t largest_free;   /** 最大空闲内存块的大小，即当前单次可分配的最大内存，单位：字节 **/
+    uint32_t fragmentation;     /** 外部碎片率，千分比，即 1000 * (1 - largest_free / free)，0 表示空闲内存全部连续 **/
+};
+
+/**
+ * @brief 扩展统计结构体
+ */
+#define DMEM_STATS_HIST_BINS        16
+struct dmem_stats
+{
+    dmem_size_t free_blocks;                        /** 空闲内存块的数量 **/
+    dmem_size_t largest_free;                       /** 最大空闲内存块的大小，超过该值的分配请求必然失败，单位：字节 **/
+    dmem_size_t free_hist[DMEM_STATS_HIST_BINS];    /** 空闲内存块按大小分档的数量，第 i 档为 [2^(i+3), 2^(i+4)) 字节，首尾两档包含更小/更大的内存块 **/
+    dmem_size_t waste;                              /** 内部浪费：已分配内存块中对齐向上取整及未拆分的剩余部分（不含小对象），单位：字节 **/
+    dmem_size_t purged;                             /** 空闲内存块中已归还系统的页的总大小（ENABLE_DMEM_PURGE），单位：字节 **/
+    size_t huge;                                    /** 直接映射的大内存的映射总大小（ENABLE_DMEM_HUGE），单位：字节 **/
+    size_t huge_count;                              /** 直接映射的大内存数量 **/
+    uint32_t alloc_count;                           /** 累计分配次数（线程缓存命中的请求不计入） **/
+    uint32_t free_count;                            /** 累计释放次数（线程缓存命中的请求不计入） **/
+    uint32_t fail_count;                            /** 累计分配失败次数 **/
+};
+
+/**
+ * @brief 内存块遍历报告的内存块状态
+ */
+#define DMEM_WALK_FREE              0       // 空闲内存块
+#define DMEM_WALK_USED              1       // 已分配的内存块
+#define DMEM_WALK_SLAB              2       // 小对象分配器的页
+#define DMEM_WALK_MOVABLE           3       // 句柄分配的可移动内存块
+#define DMEM_WALK_GAP               4       // 内存区域末尾的哨兵内存块，大小为与下一内存区域之间的间隔（ENABLE_DMEM_GROW）
+
+/**
+ * @brief 内存块遍历信息
+ */
+struct dmem_walk_info
+{
+    dmem_size_t offset;         /** 内存块信息头相对内存池的偏移量，多分区内存堆中相对第一个分区 **/
+    dmem_size_t size;           /** 用户内存大小（不含信息头），单位：字节 **/
+    uint16_t slack;             /** 已分配内存块的内部浪费，单位：字节 **/
+    uint8_t state;              /** 内存块状态 DMEM_WALK_xxx **/
+    bool purged;                /** 空闲内存块内部的整页是否已归还系统（ENABLE_DMEM_PURGE） **/
+};
+
+/**
+ * @brief 内存块遍历的回调函数
+ * @note 回调函数在持有内存堆线程锁时调用，不能再调用该内存堆的接口
+ * @param info 内存块信息
+ * @param ctx dmem_walk() 传入的参数
+ * @return false 停止遍历
+ */
+typedef bool (*dmem_walk_cb_t)(const struct dmem_walk_info* info, void* ctx);
+
+#if ENABLE_DMEM_RECORD
+/**
+ * @brief 分配记录的操作类型
+ */
+#define DMEM_RECORD_ALLOC           1       // dmem_alloc()
+#define DMEM_RECORD_FREE            2       // dmem_free()
+#define DMEM_RECORD_REALLOC         3       // dmem_realloc()
+#define DMEM_RECORD_CALLOC          4       // dmem_calloc()
+#define DMEM_RECORD_ALIGNED         5       // dmem_aligned_alloc()
+#define DMEM_RECORD_NULL            0       // NULL 对应的句柄
+
+/**
+ * @brief 分配记录
+ * @note 句柄由内存地址相对内存池的偏移量换算得到，同一时刻尚未释放的内存句柄互不相同，
+ *       内存释放后句柄可能被之后的分配复用，重放时按记录的先后顺序维护句柄与内存的对应关系即可
+ */
+struct dmem_record
+{
+    uint8_t op;                 /** 操作类型 DMEM_RECORD_xxx **/
+    uint8_t align_log2;         /** DMEM_RECORD_ALIGNED：对齐大小的以 2 为底的对数 **/
+    uint16_t reserved;
+    uint32_t tick;              /** 时间戳，由移植层 dmem_get_tick() 提供 **/
+    uint32_t size;              /** 请求的大小（calloc 为 count * size），单位：字节 **/
+    uint32_t id;                /** 返回的内存的句柄，分配失败时为 DMEM_RECORD_NULL；释放时为被释放的内存的句柄 **/
+    uint32_t old;               /** DMEM_RECORD_REALLOC：原内存的句柄 **/
+};
+
+/**
+ * @brief 取走分配记录的回调函数
+ * @note 在持有内存堆线程锁时调用，不可在回调中使用同一个内存堆
+ */
+typedef void (*dmem_record_drain_t)(const struct dmem_record* records, size_t count, void* arg);
+#endif
+
+#if ENABLE_DMEM_EVENT
+/**
+ * @brief 事件级别，数值越大越详细，只记录不高于当前级别的事件
+ */
+#define DMEM_EVENT_LEVEL_OFF        0
+#define DMEM_EVENT_LEVEL_ERROR      1
+#define DMEM_EVENT_LEVEL_WARNING    2
+#define DMEM_EVENT_LEVEL_INFO       3
+#define DMEM_EVENT_LEVEL_DEBUG      4
+
+/**
+ * @brief 事件类型及其参数 a、b 的含义，偏移量均相对于内存池起始地址
+ */
+#define DMEM_EVENT_ALLOC            1       // 分配内存块：a = 内存块偏移量，b = 用户内存大小
+#define DMEM_EVENT_ALLOC_FAIL       2       // 分配失败：a = 请求的大小，b = 当前空闲内存大小
+#define DMEM_EVENT_FREE             3       // 释放内存块：a = 内存块偏移量，b = 用户内存大小
+#define DMEM_EVENT_FREE_ERROR       4       // 释放失败：a = 内存地址的偏移量，b = 错误码的相反数
+#define DMEM_EVENT_MERGE            5       // 合并空闲内存块：a = 合并后内存块的偏移量，b = 合并后的用户内存大小
+#define DMEM_EVENT_SPLIT            6       // 拆分内存块：a = 拆分出的空闲内存块的偏移量，b = 其用户内存大小
+#define DMEM_EVENT_EXPAND           7       // realloc 就地扩展：a = 内存块偏移量，b = 新的用户内存大小
+#define DMEM_EVENT_EXPAND_BACKWARD  8       // realloc 向前扩展：a = 新的内存块偏移量，b = 新的用户内存大小
+#define DMEM_EVENT_SLAB_NEW         9       // 小对象分配器申请页：a = 页的偏移量，b = 尺寸类别的大小
+#define DMEM_EVENT_SLAB_RELEASE     10      // 小对象分配器归还页：a = 页的偏移量，b = 尺寸类别的大小
+#define DMEM_EVENT_REGION_ADD       11      // 添加内存区域：a = 内存区域的偏移量，b = 内存区域的大小
+#define DMEM_EVENT_PURGE            12      // 归还空闲页：a = 第一页的偏移量，b = 归还的大小
+#define DMEM_EVENT_HUGE_MAP         13      // 直接映射大内存：a = 请求大小，b = 映射大小（超过 32 位时截断，下同）
+#define DMEM_EVENT_HUGE_UNMAP       14      // 解除大内存映射：a = 剩余的映射数量，b = 映射大小
+#define DMEM_EVENT_HUGE_REMAP       15      // 调整大内存映射：a = 原映射大小，b = 新映射大小
+#define DMEM_EVENT_COMPACT          16      // 紧凑整理移动内存块：a = 移动后内存块的偏移量，b = 用户内存大小
+
+/**
+ * @brief 事件
+ */
+struct dmem_event
+{
+    uint8_t id;                 /** 事件类型 DMEM_EVENT_xxx **/
+    uint8_t level;              /** 事件级别 DMEM_EVENT_LEVEL_xxx **/
+    uint16_t reserved;
+    uint32_t tick;              /** 时间戳，由移植层 dmem_get_tick() 提供 **/
+    uint32_t a;                 /** 参数，含义见事件类型 **/
+    uint32_t b;                 /** 参数，含义见事件类型 **/
+};
+#endif
+
+struct dmem_block;
+struct dmem_slab_page;
+struct dmem_huge;
+struct dmem_handle_slot;
+
+#if ENABLE_DMEM_HANDLE
+/**
+ * @brief 可移动内存块的句柄，DMEM_HANDLE_NULL 表示无效的句柄
+ */
+typedef uint32_t dmem_handle_t;
+#define DMEM_HANDLE_NULL            0
+#endif
+
+#if ENABLE_DMEM_TAG
+/**
+ * @brief 标签的使用统计
+ * @note 分配速率可由两次读取的 alloc_count、alloc_bytes 之差除以读取间隔得到，
+ *       realloc 调整大小不计入分配次数，但会更新存活字节数与峰值
+ */
+struct dmem_tag_stats
+{
+    dmem_size_t live_bytes;     /** 尚未释放的内存块的用户内存大小之和，单位：字节 **/
+    dmem_size_t peak_bytes;     /** live_bytes 的最大值，单位：字节 **/
+    dmem_size_t limit;          /** 预算，live_bytes 超出预算的分配失败，为 0 时不限制 **/
+    uint32_t live_count;        /** 尚未释放的内存块数量 **/
+    uint32_t alloc_count;       /** 累计分配次数 **/
+    uint32_t fail_count;        /** 累计分配失败次数（含超出预算） **/
+    uint64_t alloc_bytes;       /** 累计分配的用户内存大小，单位：字节 **/
+};
+
+/**
+ * @brief 多分区内存堆中各分区共享的标签预算
+ * @note 各分区在持有自身线程锁时以原子操作更新 live_bytes，预算对整个多分区内存堆生效
+ */
+struct dmem_tag_budget
+{
+    volatile dmem_size_t live_bytes[DMEM_TAG_COUNT];    /** 各标签在所有分区中尚未释放的内存大小之和（含正在分配的预留） **/
+    volatile dmem_size_t limit[DMEM_TAG_COUNT];         /** 各标签的预算，为 0 时不限制 **/
+};
+#endif
+
+/**
+ * @brief 内存堆管理器
+ * @note 结构体成员仅供库内部使用，用户只需定义该结构体变量并调用 dmem_heap_init() 进行初始化，
+ *       每个内存堆拥有独立的内存池、内存块链表和线程锁，不同内存堆之间的操作互不影响
+ */
+struct dmem_heap
+{
+    char* pool;                 /** 内存池 **/
+    dmem_size_t size;           /** 内存池大小（含之后添加的内存区域） **/
+    dmem_size_t free;           /** 当前空闲的内存大小 **/
+    dmem_size_t max_usage;      /** 记录内存消耗的最大值 @note 记录所有的非空闲内存的占用，包括内存块消息结构体 **/
+    dmem_size_t inited_free;    /** 记录初始化时（及添加内存区域时），空闲内存块的大小 **/
+    dmem_size_t used_count;     /** 当前已分配的内存块数量（含小对象分配器的页） **/
+    volatile uint32_t stats_seq;                /** 内存使用报告快照的序列号，奇数表示正在更新 stats[0]，偶数表示正在更新 stats[1] **/
+    volatile struct dmem_use_report stats[2];   /** 内存使用报告快照（双缓冲），每次修改内存堆后发布，读取时无需获取线程锁 **/
+    dmem_size_t free_blocks;                    /** 空闲内存块的数量 **/
+    dmem_size_t largest_free;                   /** 最大空闲内存块大小的上界，超过该值的请求立即失败 **/
+    bool largest_exact;                         /** largest_free 是否为精确值 **/
+    dmem_size_t free_hist[DMEM_STATS_HIST_BINS];/** 空闲内存块按大小分档的数量 **/
+    dmem_size_t waste;                          /** 已分配内存块的内部浪费 **/
+    uint32_t alloc_count;                       /** 累计分配次数 **/
+    uint32_t free_count;                        /** 累计释放次数 **/
+    uint32_t fail_count;                        /** 累计分配失败次数 **/
+    dmem_size_t dirty;                          /** 惰性清零：内存池中偏移量不小于该值的部分（尾内存块除外）从未被写入且内容为 0 **/
+    struct dmem_block* bhead;   /** 首内存块且始终指向首内存块 **/
+    struct dmem_block* btail;   /** 尾内存块且始终指向尾内存块 **/
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+    struct dmem_block* bfree;   /** 首次适配引擎：空闲链表头，始终指向第一个空闲内存块 **/
+    struct dmem_block* bhint;   /** 首次适配引擎：最近一次移出空闲链表的内存块的前驱，用于加速插入 **/
+    bool hint_valid;            /** 首次适配引擎：bhint 是否有效 **/
+    uint8_t policy;             /** 首次适配引擎：放置策略 DMEM_POLICY_xxx **/
+    struct dmem_block* brover;  /** 首次适配引擎：循环首次适配策略下一次查找的起点 **/
+#endif
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_TLSF
+    dmem_tlsf_map_t fl_bitmap;                                          /** TLSF 一级位图 **/
+    uint32_t sl_bitmap[DMEM_TLSF_FL_COUNT];                             /** TLSF 二级位图 **/
+    dmem_off_t free_heads[DMEM_TLSF_FL_COUNT][DMEM_TLSF_SL_COUNT];      /** TLSF 空闲链表头 **/
+#endif
+#if ENABLE_DMEM_SLAB
+    bool slab_enabled;                                                  /** 是否启用小对象分配器 **/
+    dmem_size_t slab_pages;                                             /** 小对象分配器：当前占用的页数量 **/
+    dmem_size_t slab_objects;                                           /** 小对象分配器：当前尚未释放的小对象数量 **/
+    uint8_t* slab_map;                                                  /** 小对象分配器：页映射表，记录各页大小对齐的地址是否为页 **/
+    char* slab_map_base;                                                /** 小对象分配器：页映射表第一项对应的地址 **/
+    dmem_size_t slab_map_len;                                           /** 小对象分配器：页映射表的项数 **/
+    struct dmem_slab_page* slab_partial[DMEM_SIZE_CLASS_COUNT];         /** 小对象分配器：各尺寸类别中尚有空闲槽位的页链表 **/
+#endif
+#if ENABLE_DMEM_TCACHE
+    bool tcache_enabled;                                                /** 是否启用线程缓存 **/
+    bool tcache_used;                                                   /** 线程缓存曾被开启，此后页映射表在内存堆的生命周期内不再归还 **/
+    uint32_t tcache_gen;                                                /** 初始化代数，每次初始化内存堆时递增，线程缓存据此丢弃重新初始化之前缓存的内存 **/
+#endif
+#if ENABLE_DMEM_RECORD
+    struct dmem_record* record_buf;                                     /** 分配记录：环形缓冲区，为 NULL 时不记录 **/
+    size_t record_cap;                                                  /** 分配记录：缓冲区可容纳的记录数量 **/
+    size_t record_head;                                                 /** 分配记录：最早一条记录的位置 **/
+    size_t record_len;                                                  /** 分配记录：缓冲区中的记录数量 **/
+    dmem_record_drain_t record_drain;                                   /** 分配记录：缓冲区写满时调用的回调函数 **/
+    void* record_arg;                                                   /** 分配记录：回调函数的参数 **/
+    uint32_t record_lost;                                               /** 分配记录：未设置回调函数时被覆盖的记录数量 **/
+#endif
+#if ENABLE_DMEM_EVENT
+    struct dmem_event* event_buf;                                       /** 事件日志：环形缓冲区 **/
+    uint32_t event_mask;                                                /** 事件日志：缓冲区容量 - 1 **/
+    uint32_t event_head;                                                /** 事件日志：累计写入的事件数量 **/
+    uint32_t event_tail;                                                /** 事件日志：累计读出（或被覆盖）的事件数量 **/
+    uint8_t event_level;                                                /** 事件日志：当前级别，为 DMEM_EVENT_LEVEL_OFF 时不记录 **/
+#endif
+#if ENABLE_DMEM_GROW
+    bool grow_enabled;                                                  /** 是否在分配失败时通过 dmem_get_region() 自动增长 **/
+    uint32_t region_count;                                              /** 内存区域数量，第一个内存区域为初始化时的内存池 **/
+    dmem_size_t region_start[DMEM_REGION_MAX];                          /** 各内存区域起始位置相对内存池的偏移量 **/
+    dmem_size_t region_end[DMEM_REGION_MAX];                            /** 各内存区域结束位置相对内存池的偏移量 **/
+#endif
+#if ENABLE_DMEM_PURGE
+    uint32_t purge_decay;                                               /** 空闲页归还：延迟，0 为释放时立即归还，DMEM_PURGE_OFF 为只手动归还 **/
+    uint32_t purge_next;                                                /** 空闲页归还：等待归还的空闲内存块中最早到期的时间 **/
+    bool purge_pending;                                                 /** 空闲页归还：是否有等待归还的空闲内存块 **/
+    dmem_size_t purged;                                                 /** 空闲页归还：已归还的页的总大小 **/
+#endif
+#if ENABLE_DMEM_HUGE
+    size_t huge_threshold;                                              /** 大内存直接映射：阈值，为 0 时不使用直接映射 **/
+    struct dmem_huge* huge_list;                                        /** 大内存直接映射：已映射的大内存链表 **/
+    size_t huge_size;                                                   /** 大内存直接映射：映射总大小 **/
+    size_t huge_count;                                                  /** 大内存直接映射：已映射的数量 **/
+#endif
+#if ENABLE_DMEM_HANDLE
+    struct dmem_handle_slot* handles;                                   /** 句柄分配：句柄表，从内存堆中分配 **/
+    uint32_t handle_cap;                                                /** 句柄分配：句柄表的容量 **/
+    uint32_t handle_free;                                               /** 句柄分配：空闲槽位链表头（句柄值），为 0 时没有空闲槽位 **/
+    uint32_t handle_count;                                              /** 句柄分配：尚未释放的句柄数量 **/
+#endif
+#if ENABLE_DMEM_TAG
+    struct dmem_tag_stats tags[DMEM_TAG_COUNT];                         /** 带标签的分配：各标签的使用统计，标签 0 不使用 **/
+    struct dmem_tag_budget* tag_budget;                                 /** 带标签的分配：所属多分区内存堆共享的预算，为 NULL 时使用 tags[].limit **/
+#endif
+    void* lock;                 /** 线程锁对象，由移植层自行使用，dmem_heap_init() 不会修改该成员 **/
+};
+typedef struct dmem_heap* dmem_heap_t;
+
+int dmem_heap_init(dmem_heap_t heap, void* pool, size_t size);
+int dmem_heap_init_zeroed(dmem_heap_t heap, void* pool, size_t size);
+void* dmem_heap_alloc(dmem_heap_t heap, size_t size);
+void* dmem_heap_realloc(dmem_heap_t heap, void* old_mem, size_t new_size);
+void* dmem_heap_calloc(dmem_heap_t heap, size_t count, size_t size);
+void* dmem_heap_aligned_alloc(dmem_heap_t heap, size_t align, size_t size);
+int dmem_heap_free(dmem_heap_t heap, void* mem);
+size_t dmem_heap_alloc_batch(dmem_heap_t heap, size_t size, size_t n, void* ptrs[]);
+int dmem_heap_free_batch(dmem_heap_t heap, void* const ptrs[], size_t n);
+void dmem_heap_report(dmem_heap_t heap, struct dmem_use_report* result);
+void dmem_heap_frag_report(dmem_heap_t heap, struct dmem_frag_report* result);
+void dmem_heap_stats(dmem_heap_t heap, struct dmem_stats* result);
+size_t dmem_heap_walk(dmem_heap_t heap, dmem_walk_cb_t cb, void* ctx);
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+    int dmem_heap_set_policy(dmem_heap_t heap, int policy);
+#endif
+#if ENABLE_DMEM_SLAB
+    bool dmem_heap_slab_enable(dmem_heap_t heap, bool enable);
+#endif
+#if ENABLE_DMEM_TCACHE
+    void dmem_heap_tcache_enable(dmem_heap_t heap, bool enable);
+    void dmem_tcache_set_limit(size_t bytes);
+    void dmem_tcache_flush(void);
+#endif
+#if ENABLE_DMEM_RECORD
+    int dmem_heap_record_start(dmem_heap_t heap, struct dmem_record* buf, size_t count, dmem_record_drain_t drain, void* arg);
+    void dmem_heap_record_flush(dmem_heap_t heap);
+    uint32_t dmem_heap_record_stop(dmem_heap_t heap);
+#endif
+#if ENABLE_DMEM_EVENT
+    int dmem_heap_event_start(dmem_heap_t heap, struct dmem_event* buf, size_t count, uint8_t level);
+    void dmem_heap_event_set_level(dmem_heap_t heap, uint8_t level);
+    size_t dmem_heap_event_read(dmem_heap_t heap, struct dmem_event* out, size_t max, uint32_t* lost);
+    void dmem_heap_event_stop(dmem_heap_t heap);
+#endif
+#if ENABLE_DMEM_GROW
+    int dmem_heap_add_region(dmem_heap_t heap, void* region, size_t size);
+    void dmem_heap_grow_enable(dmem_heap_t heap, bool enable);
+#endif
+#if ENABLE_DMEM_PURGE
+    void dmem_heap_set_purge_decay(dmem_heap_t heap, uint32_t decay);
+    size_t dmem_heap_purge(dmem_heap_t heap);
+#endif
+#if ENABLE_DMEM_HUGE
+    void dmem_heap_set_huge_threshold(dmem_heap_t heap, size_t threshold);
+#endif
+#if ENABLE_DMEM_HANDLE
+    dmem_handle_t dmem_heap_halloc(dmem_heap_t heap, size_t size);
+    void* dmem_heap_hlock(dmem_heap_t heap, dmem_handle_t handle);
+    int dmem_heap_hunlock(dmem_heap_t heap, dmem_handle_t handle);
+    int dmem_heap_hfree(dmem_heap_t heap, dmem_handle_t handle);
+    bool dmem_heap_compact(dmem_heap_t heap, size_t budget);
+#endif
+#if ENABLE_DMEM_TAG
+    void* dmem_heap_alloc_tagged(dmem_heap_t heap, size_t size, uint8_t tag);
+    void* dmem_heap_calloc_tagged(dmem_heap_t heap, size_t count, size_t size, uint8_t tag);
+    void* dmem_heap_realloc_tagged(dmem_heap_t heap, void* old_mem, size_t new_size, uint8_t tag);
+    int dmem_heap_tag_of(dmem_heap_t heap, const void* mem);
+    int dmem_heap_tag_set_limit(dmem_heap_t heap, uint8_t tag, size_t limit);
+    int dmem_heap_tag_stats(dmem_heap_t heap, uint8_t tag, struct dmem_tag_stats* result);
+#endif
+
+#if ENABLE_DMEM_ARENA
+/**
+ * @brief 多分区内存堆
+ * @note 内存池被等分为多个分区，每个分区是一个独立的内存堆（拥有独立的内存块链表和线程锁），
+ *       线程按 DMEM_ARENA_POLICY 分配到不同的分区，释放时按地址归还所属的分区
+ */
+struct dmem_arenas
+{
+    struct dmem_heap heaps[DMEM_ARENA_MAX];     /** 各分区的内存堆 **/
+    int count;                                  /** 分区数量 **/
+    char* base;                                 /** 第一个分区的起始地址 **/
+    size_t stride;                              /** 分区大小（最后一个分区包含剩余部分） **/
+#if ENABLE_DMEM_TAG
+    struct dmem_tag_budget tag_budget;          /** 各分区共享的标签预算 **/
+#endif
 };
+typedef struct dmem_arenas* dmem_arenas_t;
+
+int dmem_arenas_init(dmem_arenas_t arenas, void* pool, size_t size, int count);
+int dmem_arenas_init_zeroed(dmem_arenas_t arenas, void* pool, size_t size, int count);
+dmem_heap_t dmem_arenas_heap(dmem_arenas_t arenas);
+void* dmem_arenas_alloc(dmem_arenas_t arenas, size_t size);
+void* dmem_arenas_realloc(dmem_arenas_t arenas, void* old_mem, size_t new_size);
+void* dmem_arenas_calloc(dmem_arenas_t arenas, size_t count, size_t size);
+void* dmem_arenas_aligned_alloc(dmem_arenas_t arenas, size_t align, size_t size);
+int dmem_arenas_free(dmem_arenas_t arenas, void* mem);
+size_t dmem_arenas_alloc_batch(dmem_arenas_t arenas, size_t size, size_t n, void* ptrs[]);
+int dmem_arenas_free_batch(dmem_arenas_t arenas, void* const ptrs[], size_t n);
+void dmem_arenas_report(dmem_arenas_t arenas, struct dmem_use_report* result);
+void dmem_arenas_stats(dmem_arenas_t arenas, struct dmem_stats* result);
+size_t dmem_arenas_walk(dmem_arenas_t arenas, dmem_walk_cb_t cb, void* ctx);
+#if ENABLE_DMEM_TAG
+    int dmem_arenas_tag_set_limit(dmem_arenas_t arenas, uint8_t tag, size_t limit);
+    int dmem_arenas_tag_stats(dmem_arenas_t arenas, uint8_t tag, struct dmem_tag_stats* result);
+#endif
+#endif
 
-int dmem_init(void* pool, unsigned int size);
-void* dmem_alloc(unsigned int size);
-void* dmem_realloc(void* old_mem, unsigned int new_size);
-void* dmem_calloc(unsigned int count, unsigned int size);
+#if ENABLE_DMEM_BUMP
+struct dmem_bump_chunk;
+
+/**
+ * @brief 指针碰撞分配器
+ * @note 结构体成员仅供库内部使用。块从内存堆中申请，块内按顺序分配，较早的块链接在当前块之后；
+ *       分配器本身不具备线程安全，通常每个线程或每个请求使用独立的分配器
+ */
+struct dmem_bump
+{
+    dmem_heap_t heap;                   /** 申请块的内存堆 **/
+    struct dmem_bump_chunk* chunk;      /** 当前块 **/
+    struct dmem_bump_chunk* first;      /** 最早申请的块，dmem_bump_reset() 保留该块 **/
+    char* ptr;                          /** 当前块中下一次分配的位置 **/
+    char* end;                          /** 当前块的结束位置 **/
+    size_t chunk_size;                  /** 默认的块大小 **/
+    size_t size;                        /** 已申请的块的总大小 **/
+    size_t chunk_count;                 /** 已申请的块的数量 **/
+};
+typedef struct dmem_bump* dmem_bump_t;
+
+/**
+ * @brief 指针碰撞分配器的标记，记录标记时的分配位置
+ */
+struct dmem_bump_marker
+{
+    struct dmem_bump_chunk* chunk;      /** 标记时的当前块 **/
+    char* ptr;                          /** 标记时的分配位置 **/
+};
+
+int dmem_bump_init(dmem_bump_t bump, dmem_heap_t heap, size_t chunk_size);
+void* dmem_bump_alloc(dmem_bump_t bump, size_t size);
+void* dmem_bump_aligned_alloc(dmem_bump_t bump, size_t align, size_t size);
+struct dmem_bump_marker dmem_bump_mark(dmem_bump_t bump);
+void dmem_bump_release(dmem_bump_t bump, struct dmem_bump_marker mark);
+void dmem_bump_reset(dmem_bump_t bump);
+void dmem_bump_destroy(dmem_bump_t bump);
+#endif
+
+dmem_heap_t dmem_default_heap(void);
+int dmem_init(void* pool, size_t size);
+int dmem_init_zeroed(void* pool, size_t size);
+void* dmem_alloc(size_t size);
+void* dmem_realloc(void* old_mem, size_t new_size);
+void* dmem_calloc(size_t count, size_t size);
+void* dmem_aligned_alloc(size_t align, size_t size);
+int dmem_posix_memalign(void** memptr, size_t align, size_t size);
 int dmem_free(void* mem);
+size_t dmem_alloc_batch(size_t size, size_t n, void* ptrs[]);
+int dmem_free_batch(void* const ptrs[], size_t n);
 void dmem_read_use_report(struct dmem_use_report* result);
+void dmem_read_stats(struct dmem_stats* result);
+size_t dmem_walk(dmem_walk_cb_t cb, void* ctx);
+#if ENABLE_DMEM_RECORD
+    int dmem_record_start(struct dmem_record* buf, size_t count, dmem_record_drain_t drain, void* arg);
+    void dmem_record_flush(void);
+    uint32_t dmem_record_stop(void);
+#endif
+#if ENABLE_DMEM_EVENT
+    int dmem_event_start(struct dmem_event* buf, size_t count, uint8_t level);
+    void dmem_event_set_level(uint8_t level);
+    size_t dmem_event_read(struct dmem_event* out, size_t max, uint32_t* lost);
+    void dmem_event_stop(void);
+#endif
+#if ENABLE_DMEM_GROW
+    int dmem_add_region(void* region, size_t size);
+#endif
+#if ENABLE_DMEM_PURGE
+    void dmem_set_purge_decay(uint32_t decay);
+    size_t dmem_purge(void);
+#endif
+#if ENABLE_DMEM_HUGE
+    void dmem_set_huge_threshold(size_t threshold);
+#endif
+#if ENABLE_DMEM_HANDLE
+    dmem_handle_t dmem_halloc(size_t size);
+    void* dmem_hlock(dmem_handle_t handle);
+    int dmem_hunlock(dmem_handle_t handle);
+    int dmem_hfree(dmem_handle_t handle);
+    bool dmem_compact(size_t budget);
+#endif
+#if ENABLE_DMEM_TAG
+    void* dmem_alloc_tagged(size_t size, uint8_t tag);
+    void* dmem_calloc_tagged(size_t count, size_t size, uint8_t tag);
+    void* dmem_realloc_tagged(void* old_mem, size_t new_size, uint8_t tag);
+    int dmem_tag_of(const void* mem);
+    int dmem_tag_set_limit(uint8_t tag, size_t limit);
+    int dmem_tag_stats(uint8_t tag, struct dmem_tag_stats* result);
+#endif
 
 #if ENABLE_DMEM_GET_USER_REPORT_API
     const struct dmem_use_report* dmem_get_use_report(void);
@@ -0,0 +1,183 @@
+/**
+ * @file dmem.hpp
+ * @author Southern Sandbox
+ * @brief dmem 的 C++ 适配：STL 分配器 dmem::allocator<T> 与 std::pmr::memory_resource 子类 dmem::memory_resource
+ * @note 1. 两者均只保存内存堆指针，默认使用 dmem_default_heap()，使用前需先 dmem_init() 或 dmem_heap_init()；
+ *       2. 对齐要求不超过 DMEM_DEFINE_ALIGN_SIZE 时使用 dmem_heap_alloc()，否则使用 dmem_heap_aligned_alloc()，
+ *          容器元素的对齐普遍为 8 字节，64 位偏移量下默认对齐即为 8 字节，可避免对齐分配的额外开销；
+ *       3. 释放时传入的大小与对齐仅用于与分配时对应，dmem 从内存块信息头中获取实际大小；
+ *       4. 分配失败时抛出 std::bad_alloc，std::pmr 需要 C++17 及 <memory_resource>，否则只提供 dmem::allocator<T>。
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef DMEM_HPP
+#define DMEM_HPP
+
+#include "dmem.h"
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#if defined(_MSVC_LANG)
+    #define DMEM_CPLUSPLUS      _MSVC_LANG
+#else
+    #define DMEM_CPLUSPLUS      __cplusplus
+#endif
+
+#if DMEM_CPLUSPLUS >= 201703L && defined(__has_include)
+    #if __has_include(<memory_resource>)
+        #include <memory_resource>
+        #define DMEM_HPP_PMR    1
+    #endif
+#endif
+#ifndef DMEM_HPP_PMR
+    #define DMEM_HPP_PMR        0
+#endif
+
+namespace dmem
+{
+
+/**
+ * @brief 从内存堆中分配按 align 对齐的内存
+ * @param heap 内存堆
+ * @param bytes 内存大小，为 0 时按 1 字节分配以返回唯一的地址
+ * @param align 对齐大小，必须为 2 的幂
+ * @return void* 非 NULL 内存地址，失败时抛出 std::bad_alloc
+ */
+inline void* heap_allocate(dmem_heap_t heap, std::size_t bytes, std::size_t align)
+{
+    void* p;
+    if(bytes == 0)
+        bytes = 1;
+    if(align <= DMEM_DEFINE_ALIGN_SIZE)
+        p = dmem_heap_alloc(heap, bytes);
+    else
+        p = dmem_heap_aligned_alloc(heap, align, bytes);
+    if(p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+/**
+ * @brief 释放 heap_allocate() 分配的内存
+ * @param heap 内存堆
+ * @param p 内存地址
+ * @param bytes 分配时的大小
+ * @param align 分配时的对齐大小
+ */
+inline void heap_deallocate(dmem_heap_t heap, void* p, std::size_t bytes, std::size_t align) noexcept
+{
+    (void) bytes;
+    (void) align;
+    dmem_heap_free(heap, p);
+}
+
+/**
+ * @brief STL 分配器，容器的内存从指定的内存堆中分配
+ * @note 指向同一内存堆的分配器相等，容器复制、移动与交换时分配器随之传递
+ */
+template <class T>
+class allocator
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <class U>
+    struct rebind
+    {
+        using other = allocator<U>;
+    };
+
+    allocator() noexcept : heap_(dmem_default_heap()) {}
+    explicit allocator(dmem_heap_t heap) noexcept : heap_(heap) {}
+    template <class U>
+    allocator(const allocator<U>& other) noexcept : heap_(other.heap()) {}
+
+    T* allocate(std::size_t n)
+    {
+        if(n > max_size())
+            throw std::bad_array_new_length();
+        return static_cast<T*>(heap_allocate(heap_, n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        heap_deallocate(heap_, p, n * sizeof(T), alignof(T));
+    }
+
+    std::size_t max_size() const noexcept
+    {
+        return std::numeric_limits<std::size_t>::max() / sizeof(T);
+    }
+
+    dmem_heap_t heap() const noexcept
+    {
+        return heap_;
+    }
+
+private:
+    dmem_heap_t heap_;
+};
+
+template <class T, class U>
+inline bool operator==(const allocator<T>& a, const allocator<U>& b) noexcept
+{
+    return a.heap() == b.heap();
+}
+
+template <class T, class U>
+inline bool operator!=(const allocator<T>& a, const allocator<U>& b) noexcept
+{
+    return a.heap() != b.heap();
+}
+
+#if DMEM_HPP_PMR
+/**
+ * @brief std::pmr::memory_resource 子类，供 std::pmr 容器及 std::pmr::polymorphic_allocator 使用
+ * @note 指向同一内存堆的 dmem::memory_resource 相等，可以相互释放对方分配的内存
+ */
+class memory_resource : public std::pmr::memory_resource
+{
+public:
+    memory_resource() noexcept : heap_(dmem_default_heap()) {}
+    explicit memory_resource(dmem_heap_t heap) noexcept : heap_(heap) {}
+
+    dmem_heap_t heap() const noexcept
+    {
+        return heap_;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t align) override
+    {
+        return heap_allocate(heap_, bytes, align);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+    {
+        heap_deallocate(heap_, p, bytes, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        const memory_resource* o = dynamic_cast<const memory_resource*>(&other);
+        return o != NULL && o->heap_ == heap_;
+    }
+
+private:
+    dmem_heap_t heap_;
+};
+#endif
+
+}
+
+#endif
@@ -14,8 +14,12 @@ extern "C" {
 
 /**
  * @brief 启用调试追踪
+ * @note 调试追踪在临界区内同步调用 printf()，仅用于开发调试，默认关闭；
+ *       需要长期开启的追踪请使用事件日志 (ENABLE_DMEM_EVENT)
  */
-#define ENABLE_DMEM_TRACE       1
+#ifndef ENABLE_DMEM_TRACE
+    #define ENABLE_DMEM_TRACE       0
+#endif
 #if ENABLE_DMEM_TRACE == 1
     #define DMEM_LEVEL_ERROR    "\033[31;1m"
     #define DMEM_LEVEL_WARNING  "\033[33;1m"
@@ -25,7 +29,7 @@ extern "C" {
     #include "stdio.h"
     #define dmem_trace(level, fmt, ...)    printf(level "%s:%d :" fmt "\033[0m\r\n", __func__, __LINE__, ## __VA_ARGS__)
 #else
-    #define dmem_trace(...) 
+    #define dmem_trace(...)                 ((void)0)
 #endif
 
 /**
@@ -34,12 +38,272 @@ extern "C" {
  */
 #define ENABLE_DMEM_GET_USER_REPORT_API     1
 
+/**
+ * @brief 内存块偏移量的位宽，可选 16/32/64
+ * @note 内存块信息头中使用偏移量记录前后内存块的位置，位宽决定了内存池的最大大小与内存块信息头的大小：
+ *        - 16: 内存池最大 64 KiB，内存块信息头为 8 字节，适用于内存较小的单片机；
+ *        - 32: 内存池最大 4 GiB，内存块信息头为 12 字节；
+ *        - 64: 内存池大小不受限制，内存块信息头为 24 字节，要求内存对齐大小至少为 8 字节。
+ */
+#ifndef DMEM_OFFSET_WIDTH
+    #define DMEM_OFFSET_WIDTH       16
+#endif
+
+/**
+ * @brief 内存分配引擎
+ * @note 
+ *        - DMEM_ENGINE_FIRST_FIT: 首次适配，按地址顺序查找第一个足够大的空闲内存块，代码与内存堆管理器体积最小；
+ *        - DMEM_ENGINE_TLSF:      两级分离适配 (TLSF)，通过位图索引的分级空闲链表查找空闲内存块，
+ *                                 分配与释放的耗时为常数且有确定上界，适用于内存块数量较多或对实时性有要求的场景，
+ *                                 内存堆管理器需额外占用约 DMEM_OFFSET_WIDTH * 2^DMEM_TLSF_SL_LOG2 个偏移量的空间。
+ */
+#define DMEM_ENGINE_FIRST_FIT       0
+#define DMEM_ENGINE_TLSF            1
+#ifndef DMEM_ALLOC_ENGINE
+    #define DMEM_ALLOC_ENGINE       DMEM_ENGINE_FIRST_FIT
+#endif
+
+/**
+ * @brief 首次适配引擎的放置策略，内存堆初始化时使用该默认值，可通过 dmem_heap_set_policy() 修改
+ * @note 
+ *        - DMEM_POLICY_FIRST_FIT: 首次适配，返回地址最低且足够大的空闲内存块；
+ *        - DMEM_POLICY_NEXT_FIT:  循环首次适配，从上一次分配的位置继续查找，小碎片不会集中在内存池的低地址；
+ *        - DMEM_POLICY_BEST_FIT:  最佳适配，返回足够大的空闲内存块中最小的一个，查找需遍历整个空闲链表；
+ *        - DMEM_POLICY_LIFO:      后进先出，优先复用最近释放的内存块，其内容更可能仍在缓存中。
+ *       TLSF 引擎本身即为近似最佳适配，不使用该配置。
+ */
+#define DMEM_POLICY_FIRST_FIT       0
+#define DMEM_POLICY_NEXT_FIT        1
+#define DMEM_POLICY_BEST_FIT        2
+#define DMEM_POLICY_LIFO            3
+#ifndef DMEM_DEFAULT_POLICY
+    #define DMEM_DEFAULT_POLICY     DMEM_POLICY_FIRST_FIT
+#endif
+
+/**
+ * @brief TLSF 引擎二级索引数量的对数，取值 1~5，即每个一级区间被等分为 2^DMEM_TLSF_SL_LOG2 个二级区间
+ * @note 取值越大，分配越接近最佳适配，但内存堆管理器的体积也越大
+ */
+#ifndef DMEM_TLSF_SL_LOG2
+    #define DMEM_TLSF_SL_LOG2       4
+#endif
+
+/**
+ * @brief 启用小对象分配器 (slab)
+ * @note 启用后可通过 dmem_heap_slab_enable() 为指定内存堆开启小对象分配器：
+ *       不超过 DMEM_SLAB_MAX_SIZE 字节的分配请求按尺寸类别从页中分配，页由内存池中按页大小对齐的内存块切分而来，
+ *       页内使用位图记录空闲槽位，小对象不再携带内存块信息头，也无需拆分与合并内存块。
+ */
+#ifndef ENABLE_DMEM_SLAB
+    #define ENABLE_DMEM_SLAB        1
+#endif
+
+/**
+ * @brief 小对象分配器的页大小，单位字节，必须为 2 的幂且不小于 512
+ * @note 每个尺寸类别至少占用一页，内存池较小时可适当减小页大小
+ */
+#ifndef DMEM_SLAB_PAGE_SIZE
+    #if DMEM_OFFSET_WIDTH == 16
+        #define DMEM_SLAB_PAGE_SIZE     1024
+    #else
+        #define DMEM_SLAB_PAGE_SIZE     4096
+    #endif
+#endif
+
+/**
+ * @brief 启用线程缓存
+ * @note 启用后可通过 dmem_heap_tcache_enable() 为指定内存堆开启线程缓存：
+ *       每个线程按尺寸类别缓存最近释放的小内存，分配与释放优先在线程缓存中完成而无需获取线程锁，
+ *       缓存为空时从内存堆批量补充，超过上限时批量归还内存堆。
+ *       线程缓存依赖编译器的线程局部存储 (C11 _Thread_local 或 GCC __thread)，默认关闭。
+ */
+#ifndef ENABLE_DMEM_TCACHE
+    #define ENABLE_DMEM_TCACHE      0
+#endif
+
+/**
+ * @brief 线程缓存参数
+ * @note 
+ *        - DMEM_TCACHE_BIN_MAX: 每个尺寸类别最多缓存的内存数量，超出后批量归还；
+ *        - DMEM_TCACHE_BATCH:   每次批量补充或归还的内存数量；
+ *        - DMEM_TCACHE_LIMIT:   每个线程缓存的内存总大小上限（字节）的默认值，可通过 dmem_tcache_set_limit() 修改。
+ */
+#ifndef DMEM_TCACHE_BIN_MAX
+    #define DMEM_TCACHE_BIN_MAX     32
+#endif
+#ifndef DMEM_TCACHE_BATCH
+    #define DMEM_TCACHE_BATCH       8
+#endif
+#ifndef DMEM_TCACHE_LIMIT
+    #define DMEM_TCACHE_LIMIT       (32 * 1024)
+#endif
+
+/**
+ * @brief 启用多分区内存堆 (arena)
+ * @note 启用后提供 dmem_arenas_xxx() 系列接口：内存池被等分为多个分区，每个分区拥有独立的内存块链表和线程锁，
+ *       多线程的分配请求分散到不同分区，避免所有线程争用同一个线程锁。
+ */
+#ifndef ENABLE_DMEM_ARENA
+    #define ENABLE_DMEM_ARENA       0
+#endif
+
+/**
+ * @brief 多分区内存堆参数
+ * @note 
+ *        - DMEM_ARENA_MAX:    每个多分区内存堆最多的分区数量；
+ *        - DMEM_ARENA_COUNT:  默认接口 dmem_init()/dmem_alloc() 等使用的分区数量，大于 1 时默认接口改为作用于多分区内存堆；
+ *        - DMEM_ARENA_POLICY: 线程分配分区的方式，
+ *                             DMEM_ARENA_ROUND_ROBIN 按线程首次使用的顺序轮流分配（需要线程局部存储），
+ *                             DMEM_ARENA_CPU_ID      按移植层 dmem_get_cpu_id() 返回的 CPU 编号分配。
+ */
+#define DMEM_ARENA_ROUND_ROBIN      0
+#define DMEM_ARENA_CPU_ID           1
+#ifndef DMEM_ARENA_MAX
+    #define DMEM_ARENA_MAX          8
+#endif
+#ifndef DMEM_ARENA_COUNT
+    #define DMEM_ARENA_COUNT        1
+#endif
+#ifndef DMEM_ARENA_POLICY
+    #define DMEM_ARENA_POLICY       DMEM_ARENA_ROUND_ROBIN
+#endif
+
+/**
+ * @brief 启用分配记录
+ * @note 启用后可通过 dmem_heap_record_start() 记录内存堆的每次分配与释放（操作类型、大小、句柄及时间戳），
+ *       记录写入用户提供的环形缓冲区，写满时交给回调函数取走（例如写入文件或经串口发出），
+ *       之后可使用 bench/dmem_replay.c 在任意内存池大小与配置下重放。时间戳由移植层 dmem_get_tick() 提供。
+ */
+#ifndef ENABLE_DMEM_RECORD
+    #define ENABLE_DMEM_RECORD      0
+#endif
+
+/**
+ * @brief 启用事件日志
+ * @note 启用后可通过 dmem_heap_event_start() 为内存堆设置环形缓冲区，分配、释放、合并、拆分等事件
+ *       以固定格式的二进制数据（事件类型、级别、时间戳及两个数值参数）写入缓冲区，写满时覆盖最早的事件，
+ *       不在临界区内格式化字符串；事件级别可在运行时通过 dmem_heap_event_set_level() 调整。
+ *       未设置缓冲区时每个事件点仅多一次比较，可在发布版本中保持开启。
+ *       读出的事件可使用 bench/dmem_events.c 格式化显示，时间戳由移植层 dmem_get_tick() 提供。
+ */
+#ifndef ENABLE_DMEM_EVENT
+    #define ENABLE_DMEM_EVENT       1
+#endif
+
+/**
+ * @brief 启用可增长的内存堆
+ * @note 启用后可通过 dmem_heap_add_region() 为内存堆添加新的内存区域，原尾内存块成为哨兵内存块链接到新内存区域的首内存块，
+ *       所有内存区域组成同一条内存块链表；通过 dmem_heap_grow_enable() 开启自动增长后，分配失败时调用移植层 dmem_get_region()
+ *       获取新的内存区域后重试（dmem_porting.c 中包含基于 mmap() 的 Linux 实现）。
+ *       内存块使用相对内存池起始地址的偏移量，新的内存区域必须位于已有内存区域之后，且处于偏移量位宽可表示的范围内，
+ *       使用系统分配的内存区域时通常需要 DMEM_OFFSET_WIDTH 为 64。
+ *        - DMEM_REGION_MAX: 每个内存堆最多的内存区域数量（含初始化时的内存池）；
+ *        - DMEM_GROW_SIZE:  自动增长时每次至少获取的大小，单位字节。
+ */
+#ifndef ENABLE_DMEM_GROW
+    #define ENABLE_DMEM_GROW        0
+#endif
+#ifndef DMEM_REGION_MAX
+    #define DMEM_REGION_MAX         8
+#endif
+#ifndef DMEM_GROW_SIZE
+    #define DMEM_GROW_SIZE          (64 * 1024)
+#endif
+
+/**
+ * @brief 启用空闲页归还 (purge)
+ * @note 启用后大空闲内存块中按页对齐的内部（空闲链表节点之后、下一内存块信息头之前的整页）通过移植层 dmem_purge_pages()
+ *       归还系统（dmem_porting.c 中包含基于 madvise() 的 Linux 实现），已归还的空闲内存块带有标记，不会被重复归还，
+ *       内存堆的常驻内存因此随当前占用下降，而不是停留在历史峰值。
+ *       归还的时机可通过 dmem_heap_set_purge_decay() 修改：0 为释放时立即归还，DMEM_PURGE_OFF 为只在调用 dmem_heap_purge() 时归还，
+ *       其余值为延迟，空闲内存块保持空闲达到该时长（移植层 dmem_get_tick() 的计数）后归还，避免反复释放与分配同一片内存时频繁调用系统接口。
+ *        - DMEM_PURGE_PAGE_SIZE: 归还的粒度，单位字节，必须为 2 的幂且不小于系统的页大小（系统按整页处理，粒度过小会波及相邻的内存块）；
+ *        - DMEM_PURGE_DECAY:     内存堆初始化时使用的延迟。
+ */
+#ifndef ENABLE_DMEM_PURGE
+    #define ENABLE_DMEM_PURGE       0
+#endif
+#ifndef DMEM_PURGE_PAGE_SIZE
+    #define DMEM_PURGE_PAGE_SIZE    4096
+#endif
+#ifndef DMEM_PURGE_DECAY
+    #define DMEM_PURGE_DECAY        0
+#endif
+
+/**
+ * @brief 启用大内存直接映射
+ * @note 启用后不小于阈值的分配请求不再占用内存池，而是通过移植层 dmem_map_huge() 单独映射（dmem_porting.c 中包含基于 mmap() 的 Linux 实现），
+ *       映射失败时仍从内存池分配；释放时通过 dmem_unmap_huge() 解除映射，dmem_realloc() 通过 dmem_remap_huge() 调整映射大小（Linux 下为 mremap()），
+ *       无需复制数据。直接映射的内存记录在所属内存堆的链表中，dmem_free()/dmem_realloc() 据此识别。
+ *        - DMEM_HUGE_THRESHOLD: 内存堆初始化时使用的阈值，单位字节，可通过 dmem_heap_set_huge_threshold() 修改；
+ *        - DMEM_HUGE_PAGE_SIZE: 映射大小的对齐粒度，单位字节，必须为 2 的幂。
+ */
+#ifndef ENABLE_DMEM_HUGE
+    #define ENABLE_DMEM_HUGE        0
+#endif
+#ifndef DMEM_HUGE_THRESHOLD
+    #define DMEM_HUGE_THRESHOLD     (256 * 1024)
+#endif
+#ifndef DMEM_HUGE_PAGE_SIZE
+    #define DMEM_HUGE_PAGE_SIZE     4096
+#endif
+
+/**
+ * @brief 启用指针碰撞分配器 (bump)
+ * @note 启用后提供 dmem_bump_xxx() 系列接口：从内存堆中按块申请较大的内存，分配时只需移动指针，适合生命周期相同、
+ *       一起释放的对象（如单次请求内的临时数据）。对象不能单独释放，通过 dmem_bump_mark()/dmem_bump_release()
+ *       成批释放标记之后分配的对象，dmem_bump_reset() 释放全部对象。
+ *        - DMEM_BUMP_CHUNK_SIZE: dmem_bump_init() 未指定块大小时使用的块大小，单位字节，超过块大小的请求单独申请一块。
+ */
+#ifndef ENABLE_DMEM_BUMP
+    #define ENABLE_DMEM_BUMP        0
+#endif
+#ifndef DMEM_BUMP_CHUNK_SIZE
+    #define DMEM_BUMP_CHUNK_SIZE    4096
+#endif
+
+/**
+ * @brief 启用可移动的句柄分配 (handle)
+ * @note 启用后提供 dmem_halloc()/dmem_hlock()/dmem_hunlock()/dmem_hfree() 及 dmem_compact()：通过句柄分配的内存块
+ *       在未锁定时可被 dmem_compact() 移动，将已使用的内存块向前紧凑排列，使分散的空闲内存块重新合并为大的空闲内存块。
+ *       用户只能在 dmem_hlock() 与 dmem_hunlock() 之间通过返回的地址访问内存，解锁后地址可能失效。
+ *        - DMEM_HANDLE_INIT_COUNT: 句柄表的初始容量，句柄表从内存堆中分配，容量不足时加倍。
+ */
+#ifndef ENABLE_DMEM_HANDLE
+    #define ENABLE_DMEM_HANDLE      0
+#endif
+#ifndef DMEM_HANDLE_INIT_COUNT
+    #define DMEM_HANDLE_INIT_COUNT  16
+#endif
+
+/**
+ * @brief 启用带标签的内存分配 (tag)
+ * @note 启用后提供 dmem_alloc_tagged()/dmem_calloc_tagged()/dmem_realloc_tagged()：标签记录在内存块信息的使用标志位中，
+ *       不占用额外的空间，内存堆按标签统计存活字节数、存活数量、峰值及累计分配次数，可通过 dmem_tag_stats() 查询，
+ *       并可通过 dmem_tag_set_limit() 为每个标签设置预算，超出预算的分配失败。标签 0 表示未标记，不参与统计。
+ *        - DMEM_TAG_BITS: 标签占用的位数（1 ~ 4），可用的标签为 1 ~ 2^DMEM_TAG_BITS - 1，
+ *          占用的位从内部浪费的记录中让出，位数越多可记录的内部浪费上限越小（4 位时为 127 字节，足以覆盖对齐与未拆分的剩余部分）。
+ */
+#ifndef ENABLE_DMEM_TAG
+    #define ENABLE_DMEM_TAG         0
+#endif
+#ifndef DMEM_TAG_BITS
+    #define DMEM_TAG_BITS           4
+#endif
+#define DMEM_TAG_COUNT              (1 << DMEM_TAG_BITS)
+
 /**
  * @brief 默认最小内存分配大小，单位字节
  * @warning 请谨慎修改，在32位平台，最小内存分配大小应当是 4 的整数倍
  */
 #define DMEM_MULTI_4(n)             ((n) << 2)                  // 结果为 4 的整数 n 倍
-#define DMEM_DEFINE_ALIGN_SIZE      DMEM_MULTI_4(1)             // 默认内存对齐大小为 4 字节, 即 DMEM_MULTI_4(1)
+#ifndef DMEM_DEFINE_ALIGN_SIZE
+    #if DMEM_OFFSET_WIDTH == 64
+        #define DMEM_DEFINE_ALIGN_SIZE  DMEM_MULTI_4(2)         // 64 位偏移量要求内存对齐大小为 8 字节, 即 DMEM_MULTI_4(2)
+    #else
+        #define DMEM_DEFINE_ALIGN_SIZE  DMEM_MULTI_4(1)         // 默认内存对齐大小为 4 字节, 即 DMEM_MULTI_4(1)
+    #endif
+#endif
 #define DMEM_MIN_ALLOC_SIZE         DMEM_DEFINE_ALIGN_SIZE      // 以默认内存对齐大小为最小内存分配大小
 
 /**
@@ -57,7 +321,10 @@ extern "C" {
  *        -  DMEM_ALIGNED(char mem_pool[128], 4);
  *        -  DMEM_DEFAULT_ALIGNED(static char mem_pool[128] = {0});
  */
-#if (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L) || (defined(__cplusplus) && __cplusplus >= 201103L)
+#if defined(__cplusplus) && __cplusplus >= 201103L
+    // C++11 标准对齐关键字
+    #define DMEM_ALIGNED(var, n)            alignas(n) var
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
     // 标准对齐关键字（跨编译器通用）
     #define DMEM_ALIGNED(var, n)            _Alignas(n) var
     // C语言需要包含标准头文件（C++无需额外头文件）
@@ -1,4 +1,15 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             // mmap() 的 MAP_ANONYMOUS、madvise() 及 mremap()
+#endif
 #include "dmem.h"
+#if (ENABLE_DMEM_GROW || ENABLE_DMEM_PURGE || ENABLE_DMEM_HUGE) && defined(__linux__)
+#include "stdint.h"
+#include "unistd.h"
+#include "sys/mman.h"
+#endif
+#if ENABLE_DMEM_TCACHE && defined(__linux__)
+#include "pthread.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -6,22 +17,239 @@ extern "C" {
 
 /**
  * @brief 获取线程锁
+ * @note 每个内存堆可使用独立的线程锁，用户可将 RTOS 的互斥量保存在 heap->lock 中
+ * @param heap 需要加锁的内存堆
  * @return int 
  */
-int dmem_get_lock(void)
+int dmem_get_lock(dmem_heap_t heap)
 {
+    (void) heap;
     return 0;
 }
 
 /**
  * @brief 释放线程锁
+ * @param heap 需要解锁的内存堆
+ * @return int 
+ */
+int dmem_rel_lock(dmem_heap_t heap)
+{
+    (void) heap;
+    return 0;
+}
+
+#if ENABLE_DMEM_ARENA && DMEM_ARENA_POLICY == DMEM_ARENA_CPU_ID
+/**
+ * @brief 获取当前线程所在的 CPU 编号，多分区内存堆以此选择分区
+ * @note 例如 Linux 下可返回 sched_getcpu()，RTOS 下可返回当前核心编号
  * @return int 
  */
-int dmem_rel_lock(void)
+int dmem_get_cpu_id(void)
 {
     return 0;
 }
+#endif
+
+#if ENABLE_DMEM_RECORD || ENABLE_DMEM_EVENT || ENABLE_DMEM_PURGE
+/**
+ * @brief 获取分配记录、事件日志及空闲页归还延迟的时间戳
+ * @note 例如 RTOS 下可返回系统节拍数，裸机下可返回硬件定时器的计数值，单位由用户自行约定
+ * @return uint32_t 
+ */
+uint32_t dmem_get_tick(void)
+{
+    return 0;
+}
+#endif
+
+#if ENABLE_DMEM_GROW
+/**
+ * @brief 为内存堆获取新的内存区域，开启自动增长后分配失败时调用（此时已持有该内存堆的线程锁）
+ * @note 内存块以相对内存池的偏移量链接，新内存区域必须位于已有内存区域之后，且不超出偏移量的表示范围；
+ *       Linux 下以上一内存区域的末尾为提示地址 mmap()，RTOS 下可从外部 SRAM/PSRAM 中划出一段返回
+ * @param heap 需要增长的内存堆
+ * @param min_size 内存区域的最小大小
+ * @param size 返回内存区域的实际大小
+ * @return void* 内存区域地址，NULL 表示无法增长
+ */
+void* dmem_get_region(dmem_heap_t heap, size_t min_size, size_t* size)
+{
+#if defined(__linux__)
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    uintptr_t hint = ((uintptr_t) heap->pool + heap->region_end[heap->region_count - 1] + page - 1) & ~(uintptr_t)(page - 1);
+    size_t len = (min_size + page - 1) & ~(page - 1);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void* p = MAP_FAILED;
+
+#ifdef MAP_FIXED_NOREPLACE
+    /** 提示地址已被占用时逐步向高地址探测，内核默认自高向低分配，不带提示的映射几乎总是低于内存池 **/
+    for(int i = 0; i < 16 && p == MAP_FAILED && hint + ((uintptr_t) len << i) > hint; i++)
+    {
+        p = mmap((void*) hint, len, PROT_READ | PROT_WRITE, flags | MAP_FIXED_NOREPLACE, -1, 0);
+        hint += (uintptr_t) len << i;
+    }
+    hint = ((uintptr_t) heap->pool + heap->region_end[heap->region_count - 1] + page - 1) & ~(uintptr_t)(page - 1);
+#endif
+    if(p == MAP_FAILED)
+        p = mmap((void*) hint, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if(p == MAP_FAILED)
+        return NULL;
+    /** 内核未采用提示地址时，映射可能位于内存池之前或超出偏移量的表示范围 **/
+    if((uintptr_t) p < hint || (uintmax_t)((uintptr_t) p + len - (uintptr_t) heap->pool) > (uintmax_t)(dmem_off_t) ~(dmem_off_t) 0)
+    {
+        munmap(p, len);
+        return NULL;
+    }
+    *size = len;
+    return p;
+#else
+    (void) heap;
+    (void) min_size;
+    (void) size;
+    return NULL;
+#endif
+}
+
+/**
+ * @brief 归还 dmem_get_region() 获取但无法使用的内存区域
+ * @param heap 内存堆
+ * @param region 内存区域地址
+ * @param size 内存区域大小
+ */
+void dmem_put_region(dmem_heap_t heap, void* region, size_t size)
+{
+    (void) heap;
+#if defined(__linux__)
+    munmap(region, size);
+#else
+    (void) region;
+    (void) size;
+#endif
+}
+#endif
+
+#if ENABLE_DMEM_PURGE
+/**
+ * @brief 将空闲内存块中的整页归还系统（此时已持有该内存堆的线程锁）
+ * @note 地址与大小均按 DMEM_PURGE_PAGE_SIZE 对齐，内存堆在这些页再次被分配之前不会读写其中的内容；
+ *       Linux 下使用 MADV_DONTNEED，常驻内存立即下降，再次访问时由系统补零；
+ *       改用 MADV_FREE 开销更小，但系统只在内存紧张时才回收这些页；无操作系统的平台可留空
+ * @param heap 内存堆
+ * @param addr 第一页的地址
+ * @param size 归还的大小
+ */
+void dmem_purge_pages(dmem_heap_t heap, void* addr, size_t size)
+{
+    (void) heap;
+#if defined(__linux__)
+    madvise(addr, size, MADV_DONTNEED);
+#else
+    (void) addr;
+    (void) size;
+#endif
+}
+#endif
+
+#if ENABLE_DMEM_HUGE
+/**
+ * @brief 为大块内存建立独立的映射
+ * @note 大小已按 DMEM_HUGE_PAGE_SIZE 对齐，返回的地址至少按 DMEM_HUGE_PAGE_SIZE 对齐；
+ *       Linux 下使用匿名 mmap()，其他平台可改为 VirtualAlloc() 等，返回 NULL 时分配回退到内存池；
+ *       映射的内存必须已清零，dmem_calloc() 不再对其清零
+ * @param heap 内存堆
+ * @param size 映射大小
+ * @return void* 映射地址，失败时返回 NULL
+ */
+void* dmem_map_huge(dmem_heap_t heap, size_t size)
+{
+    (void) heap;
+#if defined(__linux__)
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+#else
+    (void) size;
+    return NULL;
+#endif
+}
+
+/**
+ * @brief 解除 dmem_map_huge() 建立的映射
+ * @param heap 内存堆
+ * @param addr 映射地址
+ * @param size 映射大小
+ */
+void dmem_unmap_huge(dmem_heap_t heap, void* addr, size_t size)
+{
+    (void) heap;
+#if defined(__linux__)
+    munmap(addr, size);
+#else
+    (void) addr;
+    (void) size;
+#endif
+}
+
+/**
+ * @brief 调整映射大小，允许移动映射地址
+ * @note Linux 下使用 mremap() 直接移动页表，无需复制数据；返回 NULL 时由内存堆新建映射并复制
+ * @param heap 内存堆
+ * @param addr 原映射地址
+ * @param old_size 原映射大小
+ * @param new_size 新映射大小
+ * @return void* 新映射地址，失败时返回 NULL 且原映射保持不变
+ */
+void* dmem_remap_huge(dmem_heap_t heap, void* addr, size_t old_size, size_t new_size)
+{
+    (void) heap;
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+    void* p = mremap(addr, old_size, new_size, MREMAP_MAYMOVE);
+    return p == MAP_FAILED ? NULL : p;
+#else
+    (void) addr;
+    (void) old_size;
+    (void) new_size;
+    return NULL;
+#endif
+}
+#endif
+
+#if ENABLE_DMEM_TCACHE
+#if defined(__linux__)
+static pthread_key_t thread_exit_key;
+static pthread_once_t thread_exit_once = PTHREAD_ONCE_INIT;
+static void (*thread_exit_fn)(void);
+
+static void _thread_exit(void* arg)
+{
+    (void) arg;
+    thread_exit_fn();
+}
+
+static void _thread_exit_key_create(void)
+{
+    pthread_key_create(&thread_exit_key, _thread_exit);
+}
+#endif
+
+/**
+ * @brief 注册当前线程退出时的回调，线程缓存以此在线程退出时将缓存的内存归还内存堆
+ * @note 每个线程首次使用线程缓存时调用一次，fn 总是 dmem_tcache_flush()；
+ *       Linux 下以 pthread_key_create() 的析构函数实现，RTOS 下可挂接任务删除钩子，
+ *       不支持线程退出回调时留空即可，此时需由线程在退出前自行调用 dmem_tcache_flush()
+ * @param fn 线程退出时需调用的函数
+ */
+void dmem_thread_at_exit(void (*fn)(void))
+{
+#if defined(__linux__)
+    pthread_once(&thread_exit_once, _thread_exit_key_create);
+    thread_exit_fn = fn;
+    pthread_setspecific(thread_exit_key, &thread_exit_key);     // 值不为 NULL 时线程退出才会调用析构函数
+#else
+    (void) fn;
+#endif
+}
+#endif
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -16,6 +16,9 @@
 #include "stdint.h"
 #include "stddef.h"
 #include "time.h"
+#if ENABLE_DMEM_TCACHE && defined(__linux__)
+#include "pthread.h"
+#endif
 
 
 // 128字节内存池（4字节对齐）
@@ -26,8 +29,8 @@ typedef struct
 {
     uint16_t magic;
     uint16_t used;
-    uint16_t prev;
-    uint16_t next;
+    dmem_off_t prev;
+    dmem_off_t next;
 } mem_block_t;
 
 // 获取内存池使用情况
@@ -36,10 +39,10 @@ void print_mem_report(const char *title)
     struct dmem_use_report rpt = *dmem_get_use_report();
     printf("\n=== [%s] ===\n", title);
     printf("总内存: %d\n", 128);
-    printf("空闲内存: %d\n", rpt.free);
-    printf("最大使用量: %d\n", rpt.max_usage);
-    printf("初始空闲: %d\n", rpt.initf);
-    printf("已用块数: %d\n", rpt.used_count);
+    printf("空闲内存: %lu\n", (unsigned long)rpt.free);
+    printf("最大使用量: %lu\n", (unsigned long)rpt.max_usage);
+    printf("初始空闲: %lu\n", (unsigned long)rpt.initf);
+    printf("已用块数: %lu\n", (unsigned long)rpt.used_count);
 }
 
 // 计算内存池的开销（头尾块）
@@ -668,11 +671,1602 @@ static void _test_stress_allocation()
     printf("===== [测试10通过] =====\n");
 }
 
+static void _test_multi_heap()
+{
+    printf("\n===== [测试11: 多实例内存堆测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool_a[128]);
+    DMEM_DEFAULT_ALIGNED(static char pool_b[256]);
+    struct dmem_heap heap_a, heap_b;
+    struct dmem_use_report rpt_a, rpt_b;
+
+    assert(dmem_heap_init(NULL, pool_a, sizeof(pool_a)) == DMEM_INIT_HEAP_NULL);
+    assert(dmem_heap_init(&heap_a, pool_a, sizeof(pool_a)) == DMEM_ERR_NONE);
+    assert(dmem_heap_init(&heap_b, pool_b, sizeof(pool_b)) == DMEM_ERR_NONE);
+    dmem_init(test_pool, sizeof(test_pool));
+
+    // 各个堆的分配互不影响
+    void *pa = dmem_heap_alloc(&heap_a, 16);
+    void *pb = dmem_heap_calloc(&heap_b, 8, sizeof(int));
+    assert(pa != NULL && pa >= (void *)pool_a && pa < (void *)(pool_a + sizeof(pool_a)));
+    assert(pb != NULL && pb >= (void *)pool_b && pb < (void *)(pool_b + sizeof(pool_b)));
+
+    dmem_heap_report(&heap_a, &rpt_a);
+    dmem_heap_report(&heap_b, &rpt_b);
+    printf("堆A 空闲: %u, 堆B 空闲: %u\n", (unsigned)rpt_a.free, (unsigned)rpt_b.free);
+    assert(rpt_a.used_count == 1 && rpt_b.used_count == 1);
+    assert(rpt_a.free == sizeof(pool_a) - get_fixed_overhead() - get_block_overhead() - 16);
+    assert(rpt_b.initf == sizeof(pool_b) - get_fixed_overhead());
+    assert(dmem_get_use_report()->used_count == 0);
+
+    // 不属于该堆的内存不可释放
+    assert(dmem_heap_free(&heap_a, pb) == DMEM_FREE_INVALID_MEM);
+    assert(dmem_free(pa) == DMEM_FREE_INVALID_MEM);
+
+    // 在各自的堆上扩展与释放
+    pa = dmem_heap_realloc(&heap_a, pa, 32);
+    assert(pa != NULL);
+    assert(dmem_heap_free(&heap_a, pa) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap_b, pb) == DMEM_ERR_NONE);
+
+    dmem_heap_report(&heap_a, &rpt_a);
+    dmem_heap_report(&heap_b, &rpt_b);
+    assert(rpt_a.free == rpt_a.initf && rpt_a.used_count == 0);
+    assert(rpt_b.free == rpt_b.initf && rpt_b.used_count == 0);
+
+    // 默认堆即为 dmem_default_heap()
+    void *pd = dmem_heap_alloc(dmem_default_heap(), 8);
+    assert(is_pointer_valid(pd));
+    assert(dmem_free(pd) == DMEM_ERR_NONE);
+
+    printf("===== [测试11通过] =====\n");
+}
+
+static void _test_offset_width()
+{
+    printf("\n===== [测试12: 偏移量位宽测试] =====\n");
+
+    // 超过 64 KiB 的内存池
+    static DMEM_ALIGNED(char big_pool[192 * 1024], 8);
+    struct dmem_heap heap;
+    struct dmem_use_report rpt;
+
+    printf("偏移量位宽: %d, 内存块头大小: %zu字节\n", DMEM_OFFSET_WIDTH, sizeof(mem_block_t));
+    assert(dmem_heap_init(&heap, big_pool, sizeof(big_pool)) == DMEM_ERR_NONE);
+    dmem_heap_report(&heap, &rpt);
+
+#if DMEM_OFFSET_WIDTH == 16
+    // 16 位偏移量只能管理前 64 KiB
+    assert(rpt.initf == 65536 - get_fixed_overhead());
+    assert(dmem_heap_alloc(&heap, 70000) == NULL);
+#else
+    // 单次分配超过 64 KiB
+    assert(rpt.initf == sizeof(big_pool) - get_fixed_overhead());
+    char *p1 = dmem_heap_alloc(&heap, 100 * 1024);
+    char *p2 = dmem_heap_alloc(&heap, 80 * 1024);
+    assert(p1 != NULL && p2 != NULL);
+    memset(p1, 0x11, 100 * 1024);
+    memset(p2, 0x22, 80 * 1024);
+    assert(dmem_heap_free(&heap, p1) == DMEM_ERR_NONE);
+    assert(p2[80 * 1024 - 1] == 0x22);
+    assert(dmem_heap_free(&heap, p2) == DMEM_ERR_NONE);
+#endif
+
+    // 整个可用空间可被一次性分配
+    void *all = dmem_heap_alloc(&heap, rpt.initf);
+    assert(all != NULL);
+    assert(dmem_heap_free(&heap, all) == DMEM_ERR_NONE);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+
+    printf("===== [测试12通过] =====\n");
+}
+
+static void _test_free_list_first_fit()
+{
+    printf("\n===== [测试13: 空闲链表首次适配测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[1024]);
+    struct dmem_heap heap;
+    void *p[8];
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    for (int i = 0; i < 8; i++)
+    {
+        p[i] = dmem_heap_alloc(&heap, 32 + 16 * (i % 2));
+        assert(p[i] != NULL);
+    }
+
+    // 按逆序释放偶数块，制造多个不相邻的空隙（32 字节）
+    for (int i = 6; i >= 0; i -= 2)
+        assert(dmem_heap_free(&heap, p[i]) == DMEM_ERR_NONE);
+
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+    // 首次适配：总是返回地址最低且足够大的空闲块
+    void *q1 = dmem_heap_alloc(&heap, 32);
+    void *q2 = dmem_heap_alloc(&heap, 32);
+    assert(q1 == p[0]);
+    assert(q2 == p[2]);
+#else
+    void *q1 = dmem_heap_alloc(&heap, 32);
+    void *q2 = dmem_heap_alloc(&heap, 32);
+    assert(q1 != NULL && q2 != NULL && q1 != q2);
+#endif
+
+    // 大于任意空隙的请求只能从尾部的大空闲块分配
+    void *big = dmem_heap_alloc(&heap, 64);
+    assert(big > p[7]);
+
+    dmem_heap_free(&heap, q1);
+    dmem_heap_free(&heap, q2);
+    dmem_heap_free(&heap, big);
+    for (int i = 1; i < 8; i += 2)
+        dmem_heap_free(&heap, p[i]);
+
+    struct dmem_use_report rpt;
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+
+    printf("===== [测试13通过] =====\n");
+}
+
+#if ENABLE_DMEM_SLAB
+static void _test_slab()
+{
+    printf("\n===== [测试14: 小对象分配器测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool_a[32 * 1024]);
+    DMEM_DEFAULT_ALIGNED(static char pool_b[32 * 1024]);
+    struct dmem_heap slab_heap, plain_heap;
+    struct dmem_use_report ra, rb;
+    static void *p[200];
+
+    dmem_heap_init(&slab_heap, pool_a, sizeof(pool_a));
+    dmem_heap_init(&plain_heap, pool_b, sizeof(pool_b));
+    assert(dmem_heap_slab_enable(&slab_heap, true));
+
+    // 同一尺寸类别的小对象连续排列，不携带内存块信息头
+    for (int i = 0; i < 200; i++)
+    {
+        p[i] = dmem_heap_alloc(&slab_heap, 8);
+        assert(p[i] != NULL && IS_DMEM_VAR_ALIGNED(p[i], DMEM_DEFINE_ALIGN_SIZE));
+        memset(p[i], i, 8);
+        assert(dmem_heap_alloc(&plain_heap, 8) != NULL);
+    }
+    assert((char *)p[1] - (char *)p[0] == 8);
+
+    // 小对象的内存消耗应明显低于普通分配
+    dmem_heap_report(&slab_heap, &ra);
+    dmem_heap_report(&plain_heap, &rb);
+    printf("slab usage: %lu, plain usage: %lu\n", (unsigned long)(ra.initf - ra.free), (unsigned long)(rb.initf - rb.free));
+    assert(ra.initf - ra.free < rb.initf - rb.free);
+    assert(ra.used_count == 200);
+
+    // 非法地址与重复释放
+    assert(dmem_heap_free(&slab_heap, (char *)p[0] + 4) == DMEM_FREE_INVALID_MEM);
+    assert(dmem_heap_free(&slab_heap, p[0]) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&slab_heap, p[0]) == DMEM_FREE_REPEATED);
+
+    // 释放后的槽位可被再次分配
+    void *q = dmem_heap_alloc(&slab_heap, 5);
+    assert(q == p[0]);
+    p[0] = q;
+
+    // realloc: 槽位足够则原地返回，超出尺寸类别则迁移并保留数据
+    assert(dmem_heap_realloc(&slab_heap, p[1], 8) == p[1]);
+    p[1] = dmem_heap_realloc(&slab_heap, p[1], 100);
+    assert(p[1] != NULL);
+    for (int k = 0; k < 8; k++)
+        assert(((unsigned char *)p[1])[k] == 1);
+    p[2] = dmem_heap_realloc(&slab_heap, p[2], 1024);
+    assert(p[2] != NULL && ((unsigned char *)p[2])[7] == 2);
+
+    // calloc 同样经过小对象分配器
+    void *z = dmem_heap_calloc(&slab_heap, 4, 8);
+    assert(z != NULL);
+    for (int k = 0; k < 32; k++)
+        assert(((char *)z)[k] == 0);
+    dmem_heap_free(&slab_heap, z);
+
+    for (int i = 0; i < 200; i++)
+        assert(dmem_heap_free(&slab_heap, p[i]) == DMEM_ERR_NONE);
+
+    // 关闭后空闲的页归还内存池
+    dmem_heap_slab_enable(&slab_heap, false);
+    dmem_heap_report(&slab_heap, &ra);
+    assert(ra.free == ra.initf && ra.used_count == 0);
+
+    // 关闭时仍有小对象：之后释放最后一个小对象时页与页映射表一并归还
+    assert(dmem_heap_slab_enable(&slab_heap, true));
+    assert((q = dmem_heap_alloc(&slab_heap, 32)) != NULL);
+    assert((z = dmem_heap_alloc(&slab_heap, 8)) != NULL);
+    dmem_heap_slab_enable(&slab_heap, false);
+    assert(slab_heap.slab_pages == 2 && slab_heap.slab_map != NULL);
+    assert(dmem_heap_free(&slab_heap, q) == DMEM_ERR_NONE);
+    assert(slab_heap.slab_pages == 1 && slab_heap.slab_map != NULL);
+    assert(dmem_heap_free(&slab_heap, z) == DMEM_ERR_NONE);
+    assert(slab_heap.slab_pages == 0 && slab_heap.slab_map == NULL);
+    dmem_heap_report(&slab_heap, &ra);
+    assert(ra.free == ra.initf && ra.used_count == 0);
+
+    printf("===== [测试14通过] =====\n");
+}
+#endif
+
+#if ENABLE_DMEM_TCACHE
+#if defined(__linux__)
+static void *_tcache_thread(void *arg)
+{
+    dmem_heap_t heap = (dmem_heap_t)arg;
+    void *p = dmem_heap_alloc(heap, 24);
+    assert(p != NULL);
+    assert(dmem_heap_free(heap, p) == DMEM_ERR_NONE);
+    return NULL;    // 线程退出时由移植层注册的回调归还缓存
+}
+#endif
+
+static void _test_tcache()
+{
+    printf("\n===== [测试15: 线程缓存测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[32 * 1024]);
+    struct dmem_heap heap;
+    struct dmem_use_report rpt;
+    static void *p[100];
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    dmem_heap_tcache_enable(&heap, true);
+
+    // 首次分配从内存堆批量补充，缓存中的内存对内存堆而言仍是已分配的
+    void *a = dmem_heap_alloc(&heap, 24);
+    assert(a != NULL);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.used_count == DMEM_TCACHE_BATCH);
+
+    // 释放后立即被同一线程再次使用
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(dmem_heap_alloc(&heap, 20) == a);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, a) == DMEM_FREE_REPEATED);
+
+    // 超过单个尺寸类别的上限后批量归还内存堆
+    for (int i = 0; i < 100; i++)
+        assert((p[i] = dmem_heap_alloc(&heap, 16)) != NULL);
+    for (int i = 0; i < 100; i++)
+        assert(dmem_heap_free(&heap, p[i]) == DMEM_ERR_NONE);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.used_count <= DMEM_TCACHE_BIN_MAX + DMEM_TCACHE_BATCH);
+
+    // 大内存不经过线程缓存
+    void *big = dmem_heap_alloc(&heap, 1024);
+    assert(big != NULL);
+    assert(dmem_heap_free(&heap, big) == DMEM_ERR_NONE);
+
+    // 缓存上限为 0 时立即全部归还
+    dmem_tcache_set_limit(0);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+
+    dmem_tcache_set_limit(DMEM_TCACHE_LIMIT);
+    assert((a = dmem_heap_calloc(&heap, 2, 12)) != NULL);
+    for (int k = 0; k < 24; k++)
+        assert(((char *)a)[k] == 0);
+    dmem_heap_free(&heap, a);
+    dmem_tcache_flush();
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+
+    // 关闭线程缓存时当前线程缓存的内存立即归还
+    assert((a = dmem_heap_alloc(&heap, 24)) != NULL);
+    dmem_heap_free(&heap, a);
+    dmem_heap_tcache_enable(&heap, false);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+    dmem_heap_tcache_enable(&heap, true);
+
+    // 重新初始化内存堆后，不再使用此前缓存的内存
+    assert((a = dmem_heap_alloc(&heap, 24)) != NULL);
+    dmem_heap_free(&heap, a);
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    dmem_heap_tcache_enable(&heap, true);
+    assert((a = dmem_heap_alloc(&heap, 24)) != NULL);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.used_count == DMEM_TCACHE_BATCH);
+    dmem_heap_free(&heap, a);
+    dmem_tcache_flush();
+
+#if defined(__linux__)
+    // 线程退出时自动归还线程缓存
+    pthread_t tid;
+    assert(pthread_create(&tid, NULL, _tcache_thread, &heap) == 0);
+    pthread_join(tid, NULL);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+#endif
+
+#if ENABLE_DMEM_SLAB
+    // 线程缓存无锁读取页映射表，开启过线程缓存后关闭小对象分配器也保留页映射表
+    assert(dmem_heap_slab_enable(&heap, true));
+    assert((a = dmem_heap_alloc(&heap, 8)) != NULL);
+    dmem_heap_free(&heap, a);
+    dmem_tcache_flush();
+    dmem_heap_slab_enable(&heap, false);
+    assert(heap.slab_pages == 0 && heap.slab_map != NULL);
+#endif
+
+    printf("===== [测试15通过] =====\n");
+}
+#endif
+
+#if ENABLE_DMEM_ARENA
+static void _test_arenas()
+{
+    printf("\n===== [测试16: 多分区内存堆测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[32 * 1024]);
+    static struct dmem_arenas arenas;
+    struct dmem_use_report rpt, part;
+    static void *p[64];
+    int n = 0;
+
+    assert(dmem_arenas_init(&arenas, pool, sizeof(pool), 0) == DMEM_INIT_ARENA_COUNT);
+    assert(dmem_arenas_init(&arenas, pool, sizeof(pool), DMEM_ARENA_MAX + 1) == DMEM_INIT_ARENA_COUNT);
+    assert(dmem_arenas_init(&arenas, pool, sizeof(pool), 4) == DMEM_ERR_NONE);
+
+    // 报告为各分区之和
+    dmem_arenas_report(&arenas, &rpt);
+    dmem_heap_report(&arenas.heaps[0], &part);
+    assert(rpt.initf == part.initf * 4 && rpt.free == rpt.initf);
+
+    // 同一线程始终从同一分区分配
+    dmem_heap_t own = dmem_arenas_heap(&arenas);
+    p[n] = dmem_arenas_alloc(&arenas, 1024);
+    assert(p[n] != NULL && (char *)p[n] >= own->pool && (char *)p[n] < own->pool + own->size);
+    n++;
+
+    // 所属分区耗尽后从其他分区分配
+    while (n < 64 && (p[n] = dmem_arenas_alloc(&arenas, 1024)) != NULL)
+    {
+        if ((char *)p[n] < own->pool || (char *)p[n] >= own->pool + own->size)
+            break;
+        n++;
+    }
+    assert(n < 64 && p[n] != NULL);
+    n++;
+
+    // 所属分区无法扩展时迁移到其他分区，数据保持不变
+    memset(p[0], 0x5a, 1024);
+    void *q = dmem_arenas_realloc(&arenas, p[0], 2048);
+    assert(q != NULL && q != p[0]);
+    for (int k = 0; k < 1024; k++)
+        assert(((unsigned char *)q)[k] == 0x5a);
+    p[0] = q;
+
+    // 释放按地址归还所属的分区
+    assert(dmem_arenas_free(&arenas, NULL) == DMEM_FREE_NULL);
+    for (int i = 0; i < n; i++)
+        assert(dmem_arenas_free(&arenas, p[i]) == DMEM_ERR_NONE);
+    dmem_arenas_report(&arenas, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+
+    printf("===== [测试16通过] =====\n");
+}
+#endif
+
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+static void _test_placement_policy()
+{
+    printf("\n===== [测试17: 放置策略测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[8 * 1024]);
+    static const char *names[] = {"first-fit", "next-fit", "best-fit", "lifo"};
+    struct dmem_heap heap;
+    struct dmem_frag_report frag;
+    void *blk[6], *q;
+
+    assert(dmem_heap_set_policy(&heap, 4) == DMEM_POLICY_INVALID);
+
+    for (int policy = DMEM_POLICY_FIRST_FIT; policy <= DMEM_POLICY_LIFO; policy++)
+    {
+        static const int sizes[6] = {64, 32, 128, 32, 48, 32};
+        dmem_heap_init(&heap, pool, sizeof(pool));
+        assert(dmem_heap_set_policy(&heap, policy) == DMEM_ERR_NONE);
+
+        // 制造 64/128/48 字节的空隙，最后释放 128 字节的空隙
+        for (int i = 0; i < 6; i++)
+            assert((blk[i] = dmem_heap_alloc(&heap, sizes[i])) != NULL);
+        dmem_heap_free(&heap, blk[0]);
+        dmem_heap_free(&heap, blk[4]);
+        dmem_heap_free(&heap, blk[2]);
+
+        q = dmem_heap_alloc(&heap, 40);
+        switch (policy)
+        {
+        case DMEM_POLICY_FIRST_FIT: assert(q == blk[0]); break;     // 地址最低的空隙
+        case DMEM_POLICY_NEXT_FIT:  assert(q > blk[5]); break;      // 从上一次分配之后继续
+        case DMEM_POLICY_BEST_FIT:  assert(q == blk[4]); break;     // 最小的足够大的空隙
+        case DMEM_POLICY_LIFO:      assert(q == blk[2]); break;     // 最近释放的空隙
+        }
+
+        dmem_heap_frag_report(&heap, &frag);
+        assert(frag.free_blocks >= 3 && frag.fragmentation > 0);
+
+        // 同一负载下对比各策略的碎片情况
+        static void *p[96];
+        uint32_t seed = 12345;
+        for (int i = 0; i < 96; i++)
+            p[i] = NULL;
+        for (int round = 0; round < 2000; round++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            int i = (seed >> 16) % 96;
+            if (p[i])
+            {
+                dmem_heap_free(&heap, p[i]);
+                p[i] = NULL;
+            }
+            else
+                p[i] = dmem_heap_alloc(&heap, 8 + (seed >> 8) % 120);
+        }
+        dmem_heap_frag_report(&heap, &frag);
+        printf("%-10s free blocks: %lu, largest free: %lu, fragmentation: %u.%u%%\n", names[policy],
+               (unsigned long)frag.free_blocks, (unsigned long)frag.largest_free,
+               (unsigned)(frag.fragmentation / 10), (unsigned)(frag.fragmentation % 10));
+    }
+
+    // 全部释放后没有碎片
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    dmem_heap_frag_report(&heap, &frag);
+    assert(frag.free_blocks == 1 && frag.fragmentation == 0);
+
+    printf("===== [测试17通过] =====\n");
+}
+#endif
+
+static void _test_aligned_alloc()
+{
+    printf("\n===== [测试18: 对齐分配测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[8 * 1024]);
+    static const size_t aligns[] = {8, 16, 32, 64, 128, 256};
+    struct dmem_heap heap;
+    struct dmem_use_report rpt;
+    void *p[6], *q;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    assert(dmem_heap_aligned_alloc(&heap, 24, 64) == NULL);        // 非 2 的幂
+    assert(dmem_heap_aligned_alloc(&heap, 64, 0) == NULL);
+    assert(dmem_heap_aligned_alloc(&heap, 4096, sizeof(pool)) == NULL);
+
+    // 各种对齐要求均满足，且互不重叠
+    for (int i = 0; i < 6; i++)
+    {
+        p[i] = dmem_heap_aligned_alloc(&heap, aligns[i], 100 + i);
+        assert(p[i] != NULL && ((uintptr_t)p[i] & (aligns[i] - 1)) == 0);
+        memset(p[i], 0x30 + i, 100 + i);
+    }
+    for (int i = 0; i < 6; i++)
+        for (int k = 0; k < 100 + i; k++)
+            assert(((unsigned char *)p[i])[k] == 0x30 + i);
+
+    // 对齐填充放回内存堆：释放全部后空闲内存完全恢复
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.used_count == 6);
+    assert(rpt.initf - rpt.free < 6 * (256 + 128));
+
+    // dmem_heap_realloc() 可用于对齐分配的内存
+    q = dmem_heap_realloc(&heap, p[5], 1024);
+    assert(q != NULL);
+    for (int k = 0; k < 105; k++)
+        assert(((unsigned char *)q)[k] == 0x35);
+    p[5] = q;
+    for (int i = 0; i < 6; i++)
+        assert(dmem_heap_free(&heap, p[i]) == DMEM_ERR_NONE);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+
+    // 默认内存堆的 posix_memalign 接口
+    dmem_init(pool, sizeof(pool));
+    q = (void *)0x1;
+    assert(dmem_posix_memalign(&q, 3 * sizeof(void *), 64) != 0 && q == (void *)0x1);
+    assert(dmem_posix_memalign(&q, 64, 0) == 0 && q == NULL);
+    assert(dmem_posix_memalign(&q, 64, 2 * sizeof(pool)) != 0);
+    assert(dmem_posix_memalign(&q, 64, 200) == 0 && q != NULL && ((uintptr_t)q & 63) == 0);
+    assert(dmem_free(q) == DMEM_ERR_NONE);
+    q = dmem_aligned_alloc(512, 1000);
+    assert(q != NULL && ((uintptr_t)q & 511) == 0);
+    assert(dmem_free(q) == DMEM_ERR_NONE);
+    dmem_read_use_report(&rpt);
+    assert(rpt.free == rpt.initf);
+
+    printf("===== [测试18通过] =====\n");
+}
+
+static void _test_batch()
+{
+    printf("\n===== [测试19: 批量分配与释放测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[8 * 1024]);
+    struct dmem_heap heap;
+    struct dmem_use_report rpt;
+    static void *p[64];
+    size_t n;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    assert(dmem_heap_alloc_batch(&heap, 0, 8, p) == 0);
+
+    // 从同一空闲内存块连续切分，内存互不重叠且地址递增
+    n = dmem_heap_alloc_batch(&heap, 60, 32, p);
+    assert(n == 32);
+    for (size_t i = 0; i < n; i++)
+    {
+        memset(p[i], (int)i, 60);
+        if (i > 0)
+            assert((char *)p[i] >= (char *)p[i - 1] + 60);
+    }
+    for (size_t i = 0; i < n; i++)
+        for (int k = 0; k < 60; k++)
+            assert(((unsigned char *)p[i])[k] == (unsigned char)i);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.used_count == 32);
+
+    // 逐个释放与批量释放可以混用，批量释放中的重复地址被检测
+    assert(dmem_heap_free(&heap, p[5]) == DMEM_ERR_NONE);
+    assert(dmem_heap_free_batch(&heap, p, 8) == DMEM_FREE_REPEATED);
+    p[5] = NULL;
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.used_count == 24);
+
+    // 乱序释放其余内存后，相邻的空闲内存块全部合并
+    for (int i = 8; i < 32; i += 2)
+    {
+        void *t = p[i];
+        p[i] = p[39 - i];
+        p[39 - i] = t;
+    }
+    assert(dmem_heap_free_batch(&heap, p + 8, 24) == DMEM_ERR_NONE);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+
+    // 空间不足时返回实际分配的数量
+    n = dmem_heap_alloc_batch(&heap, 1000, 64, p);
+    assert(n > 0 && n < 64);
+    p[n] = (void *)0x1;
+    assert(dmem_heap_free_batch(&heap, p, n + 1) == DMEM_FREE_INVALID_MEM);
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.free == rpt.initf && rpt.used_count == 0);
+
+    // 默认内存堆接口
+    dmem_init(pool, sizeof(pool));
+    assert(dmem_alloc_batch(24, 16, p) == 16);
+    assert(dmem_free_batch(p, 16) == DMEM_ERR_NONE);
+    dmem_read_use_report(&rpt);
+    assert(rpt.free == rpt.initf);
+
+    printf("===== [测试19通过] =====\n");
+}
+
+static void _test_report_snapshot()
+{
+    printf("\n===== [测试20: 内存使用报告快照测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[16 * 1024]);
+    struct dmem_heap heap;
+    struct dmem_use_report rpt;
+    static void *p[128];
+    uint32_t seed = 2024;
+    dmem_size_t live = 0, peak_free_drop = 0;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.used_count == 0 && rpt.free == rpt.initf && rpt.initf == heap.inited_free);
+#if ENABLE_DMEM_SLAB
+    dmem_heap_slab_enable(&heap, true);
+#endif
+
+    // 混合分配、扩展、收缩与释放，快照始终与内存堆的实际状态一致
+    for (int i = 0; i < 128; i++)
+        p[i] = NULL;
+    for (int round = 0; round < 3000; round++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        int i = (seed >> 16) % 128;
+        if (p[i] == NULL)
+        {
+            if ((p[i] = dmem_heap_alloc(&heap, 1 + (seed >> 4) % 400)) != NULL)
+                live++;
+        }
+        else if ((seed >> 8) % 3 == 0)
+        {
+            void *q = dmem_heap_realloc(&heap, p[i], 1 + (seed >> 6) % 600);
+            if (q != NULL)
+                p[i] = q;
+        }
+        else
+        {
+            assert(dmem_heap_free(&heap, p[i]) == DMEM_ERR_NONE);
+            p[i] = NULL;
+            live--;
+        }
+
+        dmem_heap_report(&heap, &rpt);
+        assert(rpt.used_count == live && rpt.free == heap.free && rpt.max_usage == heap.max_usage);
+        if (rpt.initf - rpt.free > peak_free_drop)
+            peak_free_drop = rpt.initf - rpt.free;
+    }
+    assert(rpt.max_usage >= peak_free_drop);
+
+    for (int i = 0; i < 128; i++)
+        if (p[i] != NULL)
+            dmem_heap_free(&heap, p[i]);
+#if ENABLE_DMEM_SLAB
+    dmem_heap_slab_enable(&heap, false);
+#endif
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.used_count == 0 && rpt.free == rpt.initf);
+
+    // 模拟写者更新快照途中被中断：序列号为奇数时立即读到上一次发布的完整快照
+    void *a = dmem_heap_alloc(&heap, 100);
+    assert(a != NULL);
+    heap.stats_seq++;
+    heap.stats[0].used_count = 0;
+    dmem_heap_report(&heap, &rpt);
+    assert(rpt.used_count == 1 && rpt.free == heap.free);
+    heap.stats_seq--;
+    heap.stats[0].used_count = 1;
+    dmem_heap_free(&heap, a);
+
+    printf("===== [测试20通过] =====\n");
+}
+
+static void _test_ext_stats()
+{
+    printf("\n===== [测试21: 扩展统计与快速失败测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[8 * 1024]);
+    struct dmem_heap heap;
+    struct dmem_stats st;
+    void *p[8];
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    dmem_heap_stats(&heap, &st);
+    assert(st.free_blocks == 1 && st.largest_free == heap.free && st.waste == 0);
+    assert(st.alloc_count == 0 && st.free_count == 0 && st.fail_count == 0);
+
+    // 对齐向上取整计入内部浪费，释放后归零
+    p[0] = dmem_heap_alloc(&heap, 13);
+    dmem_heap_stats(&heap, &st);
+    assert(st.waste == ((13 + DMEM_DEFINE_ALIGN_SIZE - 1) & ~(DMEM_DEFINE_ALIGN_SIZE - 1)) - 13 && st.alloc_count == 1);
+    dmem_heap_free(&heap, p[0]);
+    dmem_heap_stats(&heap, &st);
+    assert(st.waste == 0 && st.free_count == 1);
+
+    // 制造空隙：空闲内存块数量、直方图与最大空闲内存块
+    for (int i = 0; i < 8; i++)
+        assert((p[i] = dmem_heap_alloc(&heap, 500)) != NULL);
+    for (int i = 0; i < 8; i += 2)
+        dmem_heap_free(&heap, p[i]);
+    dmem_heap_stats(&heap, &st);
+    dmem_size_t hist_total = 0;
+    for (int b = 0; b < DMEM_STATS_HIST_BINS; b++)
+        hist_total += st.free_hist[b];
+    assert(st.free_blocks == 5 && hist_total == 5);
+    assert(st.free_hist[5] == 4);                           // 500 字节位于 [256, 512)
+    assert(st.largest_free > 500 && st.largest_free < heap.free);
+
+    // 超过最大空闲内存块的请求立即失败并计数
+    assert(dmem_heap_alloc(&heap, st.largest_free + 1) == NULL);
+    assert(dmem_heap_alloc(&heap, sizeof(pool)) == NULL);
+    dmem_heap_stats(&heap, &st);
+    assert(st.fail_count == 2);
+
+    // 释放后空闲内存重新连续，最大空闲内存块恢复
+    for (int i = 1; i < 8; i += 2)
+        dmem_heap_free(&heap, p[i]);
+    dmem_heap_stats(&heap, &st);
+    assert(st.free_blocks == 1 && st.largest_free == heap.inited_free && st.waste == 0);
+    assert(st.alloc_count == 9 && st.free_count == 9);
+    assert(dmem_heap_alloc(&heap, 4096) != NULL);
+
+    printf("===== [测试21通过] =====\n");
+}
+
+#if ENABLE_DMEM_RECORD
+static struct dmem_record drained[64];
+static size_t drained_count = 0;
+static int drain_calls = 0;
+
+static void _record_collect(const struct dmem_record* records, size_t count, void* arg)
+{
+    assert(arg == (void*) &drained_count);
+    assert(drained_count + count <= 64);
+    memcpy(&drained[drained_count], records, count * sizeof(records[0]));
+    drained_count += count;
+    drain_calls++;
+}
+
+static void _test_record()
+{
+    printf("\n===== [测试22: 分配记录测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[4 * 1024]);
+    struct dmem_heap heap;
+    struct dmem_record ring[4];
+    void *a, *b, *c, *d, *batch[3];
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    assert(dmem_heap_record_start(&heap, NULL, 4, NULL, NULL) == DMEM_RECORD_BUF_NULL);
+
+    // 缓冲区写满时交给回调函数，停止时取走剩余的记录
+    assert(dmem_heap_record_start(&heap, ring, 4, _record_collect, &drained_count) == 0);
+    a = dmem_heap_alloc(&heap, 100);
+    b = dmem_heap_calloc(&heap, 4, 10);
+    c = dmem_heap_aligned_alloc(&heap, 64, 32);
+    d = dmem_heap_realloc(&heap, a, 300);
+    assert(a && b && c && d);
+    assert(drain_calls == 0);
+    assert(dmem_heap_alloc(&heap, sizeof(pool)) == NULL);      // 第 5 条记录触发回调
+    assert(drain_calls == 1 && drained_count == 4);
+    dmem_heap_free(&heap, b);
+    dmem_heap_free(&heap, c);
+    assert(dmem_heap_free(&heap, c) == DMEM_FREE_REPEATED);     // 失败的释放不记录
+    assert(dmem_heap_alloc_batch(&heap, 16, 3, batch) == 3);
+    assert(dmem_heap_free_batch(&heap, batch, 3) == 0);
+    dmem_heap_free(&heap, d);
+    assert(dmem_heap_record_stop(&heap) == 0);
+    assert(drained_count == 14);
+
+    assert(drained[0].op == DMEM_RECORD_ALLOC && drained[0].size == 100 && drained[0].id != DMEM_RECORD_NULL);
+    assert(drained[1].op == DMEM_RECORD_CALLOC && drained[1].size == 40);
+    assert(drained[2].op == DMEM_RECORD_ALIGNED && drained[2].size == 32 && drained[2].align_log2 == 6);
+    assert(drained[3].op == DMEM_RECORD_REALLOC && drained[3].size == 300 && drained[3].old == drained[0].id);
+    assert(drained[4].op == DMEM_RECORD_ALLOC && drained[4].id == DMEM_RECORD_NULL);
+    assert(drained[5].op == DMEM_RECORD_FREE && drained[5].id == drained[1].id);
+    assert(drained[6].op == DMEM_RECORD_FREE && drained[6].id == drained[2].id);
+    for (int i = 0; i < 3; i++)
+    {
+        assert(drained[7 + i].op == DMEM_RECORD_ALLOC && drained[7 + i].size == 16);
+        assert(drained[10 + i].op == DMEM_RECORD_FREE && drained[10 + i].id == drained[7 + i].id);
+    }
+    assert(drained[13].op == DMEM_RECORD_FREE && drained[13].id == drained[3].id);
+
+    // 未设置回调函数时覆盖最早的记录
+    drained_count = 0;
+    assert(dmem_heap_record_start(&heap, ring, 4, NULL, NULL) == 0);
+    for (int i = 0; i < 3; i++)
+        dmem_heap_free(&heap, dmem_heap_alloc(&heap, 8 * (i + 1)));
+    assert(ring[0].op == DMEM_RECORD_ALLOC && ring[0].size == 24);
+    assert(ring[1].op == DMEM_RECORD_FREE && ring[2].op == DMEM_RECORD_ALLOC && ring[2].size == 16);
+    assert(dmem_heap_record_stop(&heap) == 2);
+    assert(heap.free == heap.inited_free);
+
+    printf("===== [测试22通过] =====\n");
+}
+#endif
+
+static void _test_realloc_backward()
+{
+    printf("\n===== [测试23: realloc 向前扩展测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[4 * 1024]);
+    struct dmem_heap heap;
+    struct dmem_stats st;
+    unsigned char *a, *b, *c, *d, *e, *g, *q;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    assert((a = dmem_heap_alloc(&heap, 64)) != NULL);
+    assert((b = dmem_heap_alloc(&heap, 64)) != NULL);
+    assert((c = dmem_heap_alloc(&heap, 64)) != NULL);
+    assert((d = dmem_heap_alloc(&heap, 64)) != NULL);
+    assert((e = dmem_heap_alloc(&heap, 64)) != NULL);
+    assert((g = dmem_heap_alloc(&heap, 64)) != NULL);      // 隔离尾部的空闲内存
+    for (int i = 0; i < 64; i++)
+    {
+        b[i] = (unsigned char) i;
+        c[i] = (unsigned char) (0xFF - i);
+    }
+
+    // 后一个内存块已使用、前一个内存块空闲：数据前移到前一个内存块，剩余部分过小不拆分
+    dmem_heap_free(&heap, a);
+    q = dmem_heap_realloc(&heap, b, 64 + get_block_overhead() + 64);
+    assert(q == a);
+    for (int i = 0; i < 64; i++)
+        assert(q[i] == (unsigned char) i);
+    dmem_heap_stats(&heap, &st);
+    assert(st.free_blocks == 1);                             // 只剩尾部的空闲内存块
+
+    // 前后均空闲：三者合并，剩余部分拆分为新的空闲内存块
+    dmem_heap_free(&heap, q);
+    dmem_heap_free(&heap, d);
+    q = dmem_heap_realloc(&heap, c, 250);
+    assert(q == a);
+    for (int i = 0; i < 64; i++)
+        assert(q[i] == (unsigned char) (0xFF - i));
+    dmem_heap_stats(&heap, &st);
+    assert(st.free_blocks == 2);                             // 拆分出的空闲内存块与尾部的空闲内存块
+
+    // 空间不足时回退为分配新内存
+    assert((c = dmem_heap_realloc(&heap, q, 1024)) != NULL && c != a);
+    assert(c[0] == 0xFF && c[63] == 0xFF - 63);
+
+    dmem_heap_free(&heap, c);
+    dmem_heap_free(&heap, e);
+    dmem_heap_free(&heap, g);
+    dmem_heap_stats(&heap, &st);
+    assert(st.free_blocks == 1 && heap.free == heap.inited_free && st.waste == 0);
+
+    printf("===== [测试23通过] =====\n");
+}
+
+#if ENABLE_DMEM_EVENT
+static void _test_event()
+{
+    printf("\n===== [测试24: 事件日志测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[4 * 1024]);
+    struct dmem_heap heap;
+    struct dmem_event buf[8], out[16];
+    uint32_t lost;
+    size_t n;
+    void *a, *b;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    assert(dmem_heap_event_start(&heap, NULL, 8, DMEM_EVENT_LEVEL_INFO) == DMEM_EVENT_BUF_NULL);
+    assert(dmem_heap_event_start(&heap, buf, 6, DMEM_EVENT_LEVEL_INFO) == DMEM_EVENT_BUF_SIZE);
+    assert(dmem_heap_event_start(&heap, buf, 8, DMEM_EVENT_LEVEL_INFO) == DMEM_ERR_NONE);
+
+    // INFO 级别：分配、释放与释放错误，不含合并与拆分
+    assert((a = dmem_heap_alloc(&heap, 64)) != NULL);
+    assert((b = dmem_heap_alloc(&heap, 32)) != NULL);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, a) == DMEM_FREE_REPEATED);
+    n = dmem_heap_event_read(&heap, out, 16, &lost);
+    assert(n == 4 && lost == 0);
+    assert(out[0].id == DMEM_EVENT_ALLOC && out[0].a == 0 && out[0].b == 64);
+    assert(out[1].id == DMEM_EVENT_ALLOC && out[1].a == 64 + get_block_overhead() && out[1].b == 32);
+    assert(out[2].id == DMEM_EVENT_FREE && out[2].a == 0 && out[2].b == 64);
+    assert(out[3].id == DMEM_EVENT_FREE_ERROR && out[3].level == DMEM_EVENT_LEVEL_ERROR && out[3].b == (uint32_t) -DMEM_FREE_REPEATED);
+    assert(dmem_heap_event_read(&heap, out, 16, &lost) == 0);
+
+    // 运行时提高到 DEBUG 级别：释放 b 后与前后的空闲内存块合并为一个
+    dmem_heap_event_set_level(&heap, DMEM_EVENT_LEVEL_DEBUG);
+    assert(dmem_heap_free(&heap, b) == DMEM_ERR_NONE);
+    n = dmem_heap_event_read(&heap, out, 16, &lost);
+    assert(n == 3 && out[0].id == DMEM_EVENT_FREE && out[1].id == DMEM_EVENT_MERGE && out[2].id == DMEM_EVENT_MERGE);
+    assert(out[2].a == 0 && out[2].b == heap.inited_free);
+
+    // 缓冲区写满时覆盖最早的事件
+    dmem_heap_event_set_level(&heap, DMEM_EVENT_LEVEL_INFO);
+    for (int i = 0; i < 10; i++)
+        dmem_heap_free(&heap, dmem_heap_alloc(&heap, 16));
+    n = dmem_heap_event_read(&heap, out, 16, &lost);
+    assert(n == 8 && lost == 12);
+    assert(out[0].id == DMEM_EVENT_ALLOC && out[7].id == DMEM_EVENT_FREE);
+
+    // WARNING 级别只记录分配失败
+    dmem_heap_event_set_level(&heap, DMEM_EVENT_LEVEL_WARNING);
+    assert((a = dmem_heap_alloc(&heap, 16)) != NULL);
+    assert(dmem_heap_alloc(&heap, 8 * 1024) == NULL);
+    n = dmem_heap_event_read(&heap, out, 16, &lost);
+    assert(n == 1 && out[0].id == DMEM_EVENT_ALLOC_FAIL && out[0].a == 8 * 1024 && out[0].b == heap.free);
+
+    // 批量分配为每个内存块各记录一条分配事件
+    void* batch[3];
+    dmem_heap_event_set_level(&heap, DMEM_EVENT_LEVEL_INFO);
+    assert(dmem_heap_alloc_batch(&heap, 16, 3, batch) == 3);
+    n = dmem_heap_event_read(&heap, out, 16, &lost);
+    assert(n == 3 && lost == 0);
+    for (int i = 0; i < 3; i++)
+        assert(out[i].id == DMEM_EVENT_ALLOC && out[i].b == 16);
+    assert(out[1].a == out[0].a + 16 + get_block_overhead() && out[2].a == out[1].a + 16 + get_block_overhead());
+    assert(dmem_heap_free_batch(&heap, batch, 3) == DMEM_ERR_NONE);
+    dmem_heap_event_read(&heap, out, 16, &lost);
+
+    // 关闭后不再记录
+    dmem_heap_event_set_level(&heap, DMEM_EVENT_LEVEL_OFF);
+    dmem_heap_free(&heap, a);
+    assert(dmem_heap_event_read(&heap, out, 16, &lost) == 0);
+    dmem_heap_event_stop(&heap);
+    dmem_heap_event_set_level(&heap, DMEM_EVENT_LEVEL_DEBUG);       // 未设置缓冲区时无效
+    assert((a = dmem_heap_alloc(&heap, 16)) != NULL);
+    dmem_heap_free(&heap, a);
+    assert(dmem_heap_event_read(&heap, out, 16, &lost) == 0);
+    assert(heap.free == heap.inited_free);
+
+    printf("===== [测试24通过] =====\n");
+}
+#endif
+
+static void _test_calloc_lazy_zero()
+{
+    printf("\n===== [测试25: calloc 惰性清零测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[4 * 1024]);      // 位于 .bss 段，内容为 0
+    struct dmem_heap heap;
+    unsigned char *a, *b, *c;
+    void* p[8];
+
+    // 内容未知的内存池：全部视为已写入
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    assert(heap.dirty == heap.size);
+
+    dmem_heap_init_zeroed(&heap, pool, sizeof(pool));
+    assert(heap.dirty == get_block_overhead() + 2 * sizeof(dmem_off_t));
+
+    // 从未写入的部分不再清零：在其中放入标记，calloc 后标记仍在即说明跳过了清零
+    pool[get_block_overhead() + 200] = 0x5A;
+    assert((a = dmem_heap_calloc(&heap, 1, 256)) != NULL);
+    assert(a[200] == 0x5A);
+    pool[get_block_overhead() + 200] = 0;
+    assert(heap.dirty >= (size_t)(a + 256 - (unsigned char*) pool));
+
+    // 写过的内存再次分配时必须清零
+    memset(a, 0xAA, 256);
+    dmem_heap_free(&heap, a);
+    assert((b = dmem_heap_calloc(&heap, 64, 4)) == a);
+    for (int i = 0; i < 256; i++)
+        assert(b[i] == 0);
+
+    // 部分位于已写入部分、部分位于从未写入部分
+    memset(b, 0xAA, 256);
+    dmem_heap_free(&heap, b);
+    assert((c = dmem_heap_calloc(&heap, 1, 1024)) == a);
+    for (int i = 0; i < 1024; i++)
+        assert(c[i] == 0);
+    dmem_heap_free(&heap, c);
+
+    // 混合使用 alloc/free 后 calloc 的内存仍全部为 0
+    for (int round = 0; round < 4; round++)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            assert((p[i] = dmem_heap_alloc(&heap, 32 + 48 * i)) != NULL);
+            memset(p[i], 0xCC, 32 + 48 * i);
+        }
+        for (int i = round % 2; i < 8; i += 2)
+            dmem_heap_free(&heap, p[i]);
+        assert((c = dmem_heap_calloc(&heap, 3, 40 + 16 * round)) != NULL);
+        for (int i = 0; i < 3 * (40 + 16 * round); i++)
+            assert(c[i] == 0);
+        dmem_heap_free(&heap, c);
+        for (int i = 1 - round % 2; i < 8; i += 2)
+            dmem_heap_free(&heap, p[i]);
+    }
+    assert(heap.free == heap.inited_free);
+
+#if ENABLE_DMEM_TAG
+    // 带标签的 calloc 同样只清零写过的部分
+    memset(pool, 0, sizeof(pool));
+    dmem_heap_init_zeroed(&heap, pool, sizeof(pool));
+    pool[get_block_overhead() + 200] = 0x5A;
+    assert((a = dmem_heap_calloc_tagged(&heap, 1, 256, 1)) != NULL);
+    assert(a[200] == 0x5A);
+    pool[get_block_overhead() + 200] = 0;
+    memset(a, 0xAA, 256);
+    dmem_heap_free(&heap, a);
+    assert((b = dmem_heap_calloc_tagged(&heap, 2, 512, 1)) == a);
+    for (int i = 0; i < 1024; i++)
+        assert(b[i] == 0);
+    dmem_heap_free(&heap, b);
+    assert(heap.free == heap.inited_free);
+#endif
+
+    // count * size 溢出
+    assert(dmem_heap_calloc(&heap, SIZE_MAX / 2 + 1, 2) == NULL);
+    assert(dmem_heap_calloc(&heap, 2, SIZE_MAX / 2 + 1) == NULL);
+    assert(dmem_heap_calloc(&heap, 0, 16) == NULL);
+
+    printf("===== [测试25通过] =====\n");
+}
+
+#if ENABLE_DMEM_GROW
+static void _test_grow()
+{
+    printf("\n===== [测试26: 多内存区域测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char buf[8 * 1024]);
+    struct dmem_heap heap;
+    size_t size, free0;
+    char *a, *b, *c;
+
+    // 内存池为 buf 的前 2KB，之后添加的内存区域与内存池之间留有空隙
+    dmem_heap_init(&heap, buf, 2048);
+    size = heap.size;
+    free0 = heap.free;
+    assert(heap.region_count == 1);
+
+    assert(dmem_heap_add_region(&heap, NULL, 1024) == DMEM_REGION_INVALID);
+    assert(dmem_heap_add_region(&heap, buf + 512, 1024) == DMEM_REGION_INVALID);     // 与内存池重叠
+    assert(dmem_heap_add_region(&heap, buf + 4096, 8) == DMEM_REGION_INVALID);       // 过小
+    assert(heap.region_count == 1 && heap.size == size && heap.free == free0);
+
+    assert(dmem_heap_add_region(&heap, buf + 4096, 2048) == DMEM_ERR_NONE);
+    assert(heap.region_count == 2);
+    assert(heap.size == size + 2048);
+    assert(heap.free == free0 + 2048 - 2 * get_block_overhead());
+    assert(heap.inited_free == heap.free);
+    assert(dmem_heap_add_region(&heap, buf + 3072, 512) == DMEM_REGION_INVALID);     // 位于已有内存区域之前
+
+    // 内存池用尽后从新的内存区域分配，两个内存区域的内存块不会合并
+    assert((a = dmem_heap_alloc(&heap, 1800)) != NULL);
+    assert((b = dmem_heap_alloc(&heap, 1800)) != NULL);
+    if (a > b)
+    {
+        c = a;
+        a = b;
+        b = c;
+    }
+    assert(a + 1800 <= buf + 2048);
+    assert(b >= buf + 4096 && b + 1800 <= buf + 6144);
+    assert(dmem_heap_alloc(&heap, 1800) == NULL);
+    memset(a, 0x11, 1800);
+    memset(b, 0x22, 1800);
+
+    // 原地扩展只能使用同一内存区域内的空闲内存块
+    assert((c = dmem_heap_realloc(&heap, a, 2000)) == a);
+    assert(a[1799] == 0x11 && b[0] == 0x22);
+
+    // 空隙中的地址不属于内存堆
+    assert(dmem_heap_free(&heap, buf + 3000) == DMEM_FREE_INVALID_MEM);
+    assert(dmem_heap_free(&heap, buf + 2048 + get_block_overhead()) == DMEM_FREE_INVALID_MEM);
+
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, b) == DMEM_ERR_NONE);
+    assert(heap.free == heap.inited_free);
+    assert(dmem_heap_alloc(&heap, 2040) == NULL);        // 每个内存区域的空闲内存块单独计算
+
+    // 内存区域数量上限
+    for (int i = 2; i < DMEM_REGION_MAX; i++)
+        assert(dmem_heap_add_region(&heap, buf + 6144 + (i - 2) * 256, 256) == DMEM_ERR_NONE);
+    assert(heap.region_count == DMEM_REGION_MAX);
+    assert(dmem_heap_add_region(&heap, buf + 7936, 256) == DMEM_REGION_FULL);
+    assert(heap.free == heap.inited_free);
+
+    // 内存区域已满时自动增长失败，分配返回 NULL
+    dmem_heap_grow_enable(&heap, true);
+    assert(dmem_heap_alloc(&heap, 4096) == NULL);
+    dmem_heap_grow_enable(&heap, false);
+
+#if defined(__linux__)
+    // calloc 时自动增长的内存区域内容未知（移植层可返回未清零的外部 SRAM），其中的内存仍需清零
+    {
+        DMEM_DEFAULT_ALIGNED(static char zpool[2048]);
+        struct dmem_heap zheap;
+
+        dmem_heap_init_zeroed(&zheap, zpool, sizeof(zpool));
+        dmem_heap_grow_enable(&zheap, true);
+        if ((c = dmem_heap_calloc(&zheap, 1, 4000)) != NULL)
+        {
+            assert(zheap.region_count == 2 && zheap.dirty >= (size_t)(c - zheap.pool) + 4000);
+            for (int i = 0; i < 4000; i++)
+                assert(c[i] == 0);
+        }
+    }
+#endif
+
+    printf("===== [测试26通过] =====\n");
+}
+#endif
+
+#if ENABLE_DMEM_PURGE
+static void _test_purge()
+{
+    printf("\n===== [测试27: 空闲页归还测试] =====\n");
+
+    DMEM_ALIGNED(static char pool[8 * DMEM_PURGE_PAGE_SIZE], DMEM_PURGE_PAGE_SIZE);
+    struct dmem_heap heap;
+    struct dmem_stats st;
+    char *a, *b;
+    // 整个内存池为一个空闲内存块时：首页容纳信息头与空闲链表节点，末页容纳尾内存块
+    const size_t whole = 6 * DMEM_PURGE_PAGE_SIZE;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    dmem_heap_set_purge_decay(&heap, 0);
+    assert(heap.purged == whole);
+
+    // 立即归还：释放后合并的大空闲内存块立即归还，分配时清除标记
+    assert((a = dmem_heap_alloc(&heap, 5 * DMEM_PURGE_PAGE_SIZE)) != NULL);
+    assert(heap.purged == 0);
+    memset(a, 0x5A, 5 * DMEM_PURGE_PAGE_SIZE);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(heap.purged == whole);
+    dmem_heap_stats(&heap, &st);
+    assert(st.purged == whole);
+
+    // 不足一页的空闲内存块不归还
+    assert((a = dmem_heap_alloc(&heap, 100)) != NULL);
+    assert((b = dmem_heap_alloc(&heap, 100)) != NULL);
+    assert(heap.purged == 0);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(heap.purged == 0);
+    assert(dmem_heap_free(&heap, b) == DMEM_ERR_NONE);
+    assert(heap.purged == whole);
+
+    // 归还后的内存可以正常分配和使用
+    assert((a = dmem_heap_alloc(&heap, 5 * DMEM_PURGE_PAGE_SIZE)) != NULL);
+    memset(a, 0xA5, 5 * DMEM_PURGE_PAGE_SIZE);
+    for (int i = 0; i < 5 * DMEM_PURGE_PAGE_SIZE; i++)
+        assert((unsigned char)a[i] == 0xA5);
+
+    // 只手动归还：释放时不归还，dmem_heap_purge() 不会重复归还
+    dmem_heap_set_purge_decay(&heap, DMEM_PURGE_OFF);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(heap.purged == 0);
+    assert(dmem_heap_purge(&heap) == whole);
+    assert(heap.purged == whole);
+    assert(dmem_heap_purge(&heap) == 0);
+
+    // 延迟归还：未到期前不归还，手动归还不受延迟影响
+    dmem_heap_set_purge_decay(&heap, 1000);
+    assert((a = dmem_heap_alloc(&heap, 3 * DMEM_PURGE_PAGE_SIZE)) != NULL);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(heap.purged == 0 && heap.purge_pending);
+    assert(dmem_heap_purge(&heap) == whole);
+    assert(!heap.purge_pending);
+
+    // 切换到立即归还时归还现有的空闲页
+    assert((a = dmem_heap_alloc(&heap, 3 * DMEM_PURGE_PAGE_SIZE)) != NULL);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(heap.purged == 0);
+    dmem_heap_set_purge_decay(&heap, 0);
+    assert(heap.purged == whole);
+    assert(heap.free == heap.inited_free);
+
+    printf("===== [测试27通过] =====\n");
+}
+#endif
+
+#if ENABLE_DMEM_HUGE
+static void _test_huge()
+{
+    printf("\n===== [测试28: 大内存直接映射测试] =====\n");
+
+    static char pool[16 * 1024];
+    struct dmem_heap heap;
+    struct dmem_stats st;
+    char *a, *b, *c;
+    void* ptrs[4];
+    const size_t threshold = 8 * 1024;
+    size_t i;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    dmem_heap_set_huge_threshold(&heap, threshold);
+
+    // 不小于阈值的请求直接映射，不占用内存池
+    assert((a = dmem_heap_alloc(&heap, 64 * 1024)) != NULL);
+    assert(!((uintptr_t)a >= (uintptr_t)pool && (uintptr_t)a < (uintptr_t)pool + sizeof(pool)));
+    assert(((uintptr_t)a & (DMEM_DEFINE_ALIGN_SIZE - 1)) == 0);
+    assert(heap.free == heap.inited_free);
+    memset(a, 0x5A, 64 * 1024);
+    dmem_heap_stats(&heap, &st);
+    assert(st.huge_count == 1 && st.huge >= 64 * 1024);
+    assert(heap.used_count == 1);
+
+    // 小于阈值的请求仍从内存池分配
+    assert((b = dmem_heap_alloc(&heap, 100)) != NULL);
+    assert((uintptr_t)b >= (uintptr_t)pool && (uintptr_t)b < (uintptr_t)pool + sizeof(pool));
+
+    // 扩大映射保留原有数据
+    assert((a = dmem_heap_realloc(&heap, a, 256 * 1024)) != NULL);
+    for (i = 0; i < 64 * 1024; i++)
+        assert((unsigned char)a[i] == 0x5A);
+    memset(a, 0xA5, 256 * 1024);
+    dmem_heap_stats(&heap, &st);
+    assert(st.huge_count == 1 && st.huge >= 256 * 1024);
+
+    // 缩小到阈值以下时迁回内存池
+    assert((a = dmem_heap_realloc(&heap, a, 1000)) != NULL);
+    assert((uintptr_t)a >= (uintptr_t)pool && (uintptr_t)a < (uintptr_t)pool + sizeof(pool));
+    for (i = 0; i < 1000; i++)
+        assert((unsigned char)a[i] == 0xA5);
+    assert(heap.huge_count == 0 && heap.huge_size == 0);
+
+    // 扩大到阈值以上时迁出内存池
+    assert((a = dmem_heap_realloc(&heap, a, threshold)) != NULL);
+    assert(!((uintptr_t)a >= (uintptr_t)pool && (uintptr_t)a < (uintptr_t)pool + sizeof(pool)));
+    for (i = 0; i < 1000; i++)
+        assert((unsigned char)a[i] == 0xA5);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, b) == DMEM_ERR_NONE);
+    assert(heap.huge_count == 0 && heap.free == heap.inited_free);
+
+    // calloc 返回全零的映射，对齐分配满足对齐要求
+    assert((c = dmem_heap_calloc(&heap, 1024, 16)) != NULL);
+    for (i = 0; i < 16 * 1024; i++)
+        assert(c[i] == 0);
+    assert((a = dmem_heap_aligned_alloc(&heap, 256, threshold)) != NULL);
+    assert(((uintptr_t)a & 255) == 0);
+    memset(a, 0x11, threshold);
+    assert(heap.huge_count == 2);
+
+    // 批量分配与批量释放
+    assert(dmem_heap_alloc_batch(&heap, threshold, 4, ptrs) == 4);
+    assert(heap.huge_count == 6);
+    assert(dmem_heap_free_batch(&heap, ptrs, 4) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, c) == DMEM_ERR_NONE);
+    assert(heap.huge_count == 0 && heap.huge_size == 0 && heap.used_count == 0);
+
+    // 重复释放不在内存池中的地址返回错误
+    assert(dmem_heap_free(&heap, c) != DMEM_ERR_NONE);
+
+    // 调高阈值后扩展映射的内存，迁回内存池时只复制原有的部分
+    assert((a = dmem_heap_alloc(&heap, threshold)) != NULL && heap.huge_count == 1);
+    memset(a, 0x3C, threshold);
+    dmem_heap_set_huge_threshold(&heap, 1024 * 1024);
+    assert((a = dmem_heap_realloc(&heap, a, 14000)) != NULL);
+    assert((uintptr_t)a >= (uintptr_t)pool && (uintptr_t)a < (uintptr_t)pool + sizeof(pool));
+    for (i = 0; i < threshold; i++)
+        assert((unsigned char)a[i] == 0x3C);
+    assert(heap.huge_count == 0 && heap.huge_size == 0);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+
+    // 阈值为 0 时不使用直接映射，超出内存池的请求失败
+    dmem_heap_set_huge_threshold(&heap, 0);
+    assert(dmem_heap_alloc(&heap, 64 * 1024) == NULL);
+    assert(heap.huge_count == 0);
+
+    printf("===== [测试28通过] =====\n");
+}
+#endif
+
+#if ENABLE_DMEM_BUMP
+static void _test_bump()
+{
+    printf("\n===== [测试29: 指针碰撞分配器测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[32 * 1024]);
+    struct dmem_heap heap;
+    struct dmem_bump bump;
+    struct dmem_bump_marker outer, inner;
+    char *a, *b, *c, *base;
+    int i;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    assert(dmem_bump_init(NULL, &heap, 0) == DMEM_BUMP_INVALID);
+    assert(dmem_bump_init(&bump, NULL, 0) == DMEM_BUMP_INVALID);
+    assert(dmem_bump_init(&bump, &heap, 1024) == DMEM_ERR_NONE);
+    assert(bump.chunk_count == 0 && heap.used_count == 0);
+
+    // 首次分配时申请块，之后在块内连续分配
+    assert((base = a = dmem_bump_alloc(&bump, 10)) != NULL);
+    assert((b = dmem_bump_alloc(&bump, 20)) != NULL);
+    assert(b >= a + 10 && b < a + 10 + DMEM_DEFINE_ALIGN_SIZE);
+    assert(bump.chunk_count == 1 && heap.used_count == 1);
+    assert(dmem_bump_alloc(&bump, 0) == NULL);
+
+    // 对齐分配
+    assert((c = dmem_bump_aligned_alloc(&bump, 64, 8)) != NULL);
+    assert(((uintptr_t)c & 63) == 0);
+    assert(dmem_bump_aligned_alloc(&bump, 3, 8) == NULL);
+
+    // 嵌套标记：释放内层标记只回收内层分配的内存
+    outer = dmem_bump_mark(&bump);
+    for (i = 0; i < 40; i++)
+        assert(dmem_bump_alloc(&bump, 100) != NULL);
+    assert(bump.chunk_count > 1);
+    inner = dmem_bump_mark(&bump);
+    assert((a = dmem_bump_alloc(&bump, 2000)) != NULL);        // 超过块大小的请求单独申请一块
+    memset(a, 0x5A, 2000);
+    assert(bump.ptr == a + 2000);
+    dmem_bump_release(&bump, inner);
+    assert(bump.ptr == inner.ptr && bump.chunk == inner.chunk);
+    dmem_bump_release(&bump, outer);
+    assert(bump.chunk_count == 1 && heap.used_count == 1);
+    assert(bump.ptr == outer.ptr);
+    assert(dmem_bump_alloc(&bump, 10) == outer.ptr);
+
+    // 重置只保留最早的块，销毁后归还全部块
+    for (i = 0; i < 40; i++)
+        assert(dmem_bump_alloc(&bump, 100) != NULL);
+    dmem_bump_reset(&bump);
+    assert(bump.chunk_count == 1 && heap.used_count == 1);
+    assert(dmem_bump_alloc(&bump, 8) == base);
+    dmem_bump_destroy(&bump);
+    assert(bump.chunk_count == 0 && bump.size == 0);
+    assert(heap.used_count == 0 && heap.free == heap.inited_free);
+
+    // 内存堆空间不足时分配失败，已分配的内存不受影响
+    assert((a = dmem_bump_alloc(&bump, 100)) != NULL);
+    assert(dmem_bump_alloc(&bump, 64 * 1024) == NULL);
+    assert(dmem_bump_alloc(&bump, 100) == a + 100);
+    dmem_bump_destroy(&bump);
+    assert(heap.used_count == 0);
+
+    printf("===== [测试29通过] =====\n");
+}
+#endif
+
+#if ENABLE_DMEM_HANDLE
+static void _test_handle()
+{
+    printf("\n===== [测试30: 可移动句柄分配与紧凑整理测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[16 * 1024]);
+    struct dmem_heap heap;
+    dmem_handle_t h[16];
+    char *p, *locked;
+    int i, k;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    assert(dmem_heap_halloc(&heap, 0) == DMEM_HANDLE_NULL);
+    assert(dmem_heap_hlock(&heap, DMEM_HANDLE_NULL) == NULL);
+    assert(dmem_heap_hlock(&heap, 1) == NULL);
+    assert(dmem_heap_hfree(&heap, 1) == DMEM_HANDLE_INVALID);
+
+    // 分配后隔一个释放一个，空闲内存被已使用的内存块分隔（句柄表在首次分配时分配，位于最前方且不需扩展）
+    for (i = 0; i < 16; i++)
+    {
+        assert((h[i] = dmem_heap_halloc(&heap, 400)) != DMEM_HANDLE_NULL);
+        assert((p = dmem_heap_hlock(&heap, h[i])) != NULL);
+        memset(p, i, 400);
+        assert(dmem_heap_hunlock(&heap, h[i]) == DMEM_ERR_NONE);
+    }
+    assert(heap.handle_count == 16 && heap.handle_cap == 16);
+    assert(dmem_heap_hunlock(&heap, h[0]) == DMEM_HANDLE_INVALID);      // 未锁定
+    for (i = 0; i < 16; i += 2)
+        assert(dmem_heap_hfree(&heap, h[i]) == DMEM_ERR_NONE);
+    assert(dmem_heap_hfree(&heap, h[0]) == DMEM_HANDLE_INVALID);        // 重复释放
+    assert(heap.free_blocks > 1);
+
+    // 锁定的内存块不可移动，也不能释放；句柄分配的内存不能直接释放或调整大小
+    assert((locked = dmem_heap_hlock(&heap, h[7])) != NULL);
+    assert(dmem_heap_hfree(&heap, h[7]) == DMEM_HANDLE_LOCKED);
+    assert(dmem_heap_free(&heap, locked) != DMEM_ERR_NONE);
+    assert(dmem_heap_realloc(&heap, locked, 800) == NULL);
+
+    // 按预算分步整理，每次至少移动一个内存块
+    assert(dmem_heap_compact(&heap, 1) == false);
+    assert(dmem_heap_compact(&heap, 0) == true);
+    assert(dmem_heap_hlock(&heap, h[7]) == locked);
+    assert(dmem_heap_hunlock(&heap, h[7]) == DMEM_ERR_NONE);
+    assert(heap.free_blocks == 2);                  // 锁定的内存块前后各一段
+    assert(dmem_heap_hunlock(&heap, h[7]) == DMEM_ERR_NONE);
+
+    // 全部解锁后空闲内存汇聚为一个空闲内存块，可以满足大的请求
+    assert(dmem_heap_compact(&heap, 0) == true);
+    assert(heap.free_blocks == 1);
+    assert((p = dmem_heap_alloc(&heap, heap.free)) != NULL);
+    assert(dmem_heap_free(&heap, p) == DMEM_ERR_NONE);
+
+    // 移动后数据保持不变
+    for (i = 1; i < 16; i += 2)
+    {
+        assert((p = dmem_heap_hlock(&heap, h[i])) != NULL);
+        for (k = 0; k < 400; k++)
+            assert(p[k] == (char) i);
+        assert(dmem_heap_hunlock(&heap, h[i]) == DMEM_ERR_NONE);
+        assert(dmem_heap_hfree(&heap, h[i]) == DMEM_ERR_NONE);
+    }
+    assert(heap.handle_count == 0 && heap.used_count == 1);             // 只剩句柄表
+
+    printf("===== [测试30通过] =====\n");
+}
+#endif
+
+#define WALK_MAX    16
+struct walk_collect
+{
+    struct dmem_walk_info info[WALK_MAX];
+    size_t count;
+    size_t stop_at;             // 收集到该数量时停止遍历，为 0 时不停止
+};
+
+static bool _walk_collect(const struct dmem_walk_info* info, void* ctx)
+{
+    struct walk_collect* wc = (struct walk_collect*) ctx;
+    if (wc->count < WALK_MAX)
+        wc->info[wc->count] = *info;
+    wc->count++;
+    return wc->stop_at == 0 || wc->count < wc->stop_at;
+}
+
+static void _test_walk()
+{
+    printf("\n===== [测试31: 内存块遍历测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[4 * 1024]);
+    struct dmem_heap heap;
+    struct walk_collect wc;
+    char *a, *b, *c;
+    size_t i, hdr = sizeof(mem_block_t);
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+    memset(&wc, 0, sizeof(wc));
+    assert(dmem_heap_walk(&heap, _walk_collect, &wc) == 1);
+    assert(wc.info[0].offset == 0 && wc.info[0].state == DMEM_WALK_FREE && wc.info[0].size == heap.free);
+
+    // 已分配 - 空闲 - 已分配 - 空闲：按地址顺序报告，相邻内存块首尾相接
+    assert((a = dmem_heap_alloc(&heap, 100)) != NULL);
+    assert((b = dmem_heap_alloc(&heap, 200)) != NULL);
+    assert((c = dmem_heap_alloc(&heap, 64)) != NULL);
+    assert(dmem_heap_free(&heap, b) == DMEM_ERR_NONE);
+    memset(&wc, 0, sizeof(wc));
+    assert(dmem_heap_walk(&heap, _walk_collect, &wc) == 4);
+    assert(wc.info[0].state == DMEM_WALK_USED && wc.info[0].size >= 100);
+    assert(wc.info[0].slack == wc.info[0].size - 100);
+    assert(wc.info[1].state == DMEM_WALK_FREE && wc.info[1].size >= 200);
+    assert(wc.info[2].state == DMEM_WALK_USED && wc.info[2].offset == (size_t)(c - pool) - hdr);
+    assert(wc.info[3].state == DMEM_WALK_FREE);
+    for (i = 0; i + 1 < wc.count; i++)
+        assert(wc.info[i + 1].offset == wc.info[i].offset + hdr + wc.info[i].size);
+    assert(wc.info[3].offset + hdr + wc.info[3].size == heap.size - hdr);            // 尾内存块不报告
+    assert(wc.info[1].size + wc.info[3].size == heap.free);
+
+    // 回调函数返回 false 时停止
+    memset(&wc, 0, sizeof(wc));
+    wc.stop_at = 2;
+    assert(dmem_heap_walk(&heap, _walk_collect, &wc) == 2);
+
+#if ENABLE_DMEM_HANDLE
+    {
+        dmem_handle_t h = dmem_heap_halloc(&heap, 32);
+        bool found = false;
+        assert(h != DMEM_HANDLE_NULL);
+        memset(&wc, 0, sizeof(wc));
+        dmem_heap_walk(&heap, _walk_collect, &wc);
+        for (i = 0; i < wc.count && i < WALK_MAX; i++)
+            found |= wc.info[i].state == DMEM_WALK_MOVABLE;
+        assert(found);
+        assert(dmem_heap_hfree(&heap, h) == DMEM_ERR_NONE);
+    }
+#endif
+#if ENABLE_DMEM_GROW
+    // 内存区域之间的哨兵内存块报告为间隔
+    {
+        DMEM_DEFAULT_ALIGNED(static char grow_buf[4 * 1024]);
+        dmem_heap_init(&heap, grow_buf, 1024);
+        assert(dmem_heap_add_region(&heap, grow_buf + 2048, 1024) == DMEM_ERR_NONE);
+        memset(&wc, 0, sizeof(wc));
+        assert(dmem_heap_walk(&heap, _walk_collect, &wc) == 3);
+        assert(wc.info[0].state == DMEM_WALK_FREE && wc.info[2].state == DMEM_WALK_FREE);
+        assert(wc.info[1].state == DMEM_WALK_GAP && wc.info[1].offset == 1024 - hdr);
+        assert(wc.info[2].offset == 2048);
+    }
+#endif
+
+    printf("===== [测试31通过] =====\n");
+}
+
+#if ENABLE_DMEM_TAG
+// 读取内存块的用户内存大小（信息头中的 next 为下一内存块相对内存池的偏移量）
+static size_t _tag_block_size(const char* pool, const char* mem)
+{
+    const mem_block_t* blk = (const mem_block_t*)(mem - sizeof(mem_block_t));
+    return (size_t) blk->next - (size_t)((const char*) blk - pool) - sizeof(mem_block_t);
+}
+
+static void _test_tag()
+{
+    printf("\n===== [测试32: 带标签的分配与标签统计测试] =====\n");
+
+    DMEM_DEFAULT_ALIGNED(static char pool[8 * 1024]);
+    struct dmem_heap heap;
+    struct dmem_tag_stats st;
+    char *a, *b, *c, *p, *q;
+    size_t a_size, b_size;
+    int i;
+
+    dmem_heap_init(&heap, pool, sizeof(pool));
+#if ENABLE_DMEM_TCACHE
+    dmem_heap_tcache_enable(&heap, true);           // 带标签的内存块不进入线程缓存
+#endif
+    assert(dmem_heap_tag_stats(&heap, 0, &st) == DMEM_TAG_INVALID);
+    assert(dmem_heap_tag_stats(&heap, DMEM_TAG_COUNT, &st) == DMEM_TAG_INVALID);
+    assert(dmem_heap_tag_set_limit(&heap, 0, 100) == DMEM_TAG_INVALID);
+    assert(dmem_heap_alloc_tagged(&heap, 16, DMEM_TAG_COUNT) == NULL);
+    assert(dmem_heap_alloc_tagged(&heap, 0, 1) == NULL);
+
+    // 各标签分别统计，存活字节数按内存块的实际大小计入
+    assert((a = dmem_heap_alloc_tagged(&heap, 100, 1)) != NULL);
+    assert((b = dmem_heap_alloc_tagged(&heap, 200, 1)) != NULL);
+    assert((c = dmem_heap_calloc_tagged(&heap, 4, 50, 2)) != NULL);
+    for (i = 0; i < 200; i++)
+        assert(c[i] == 0);
+    a_size = _tag_block_size(pool, a);
+    b_size = _tag_block_size(pool, b);
+    assert(dmem_heap_tag_of(&heap, a) == 1 && dmem_heap_tag_of(&heap, c) == 2);
+    assert(dmem_heap_tag_stats(&heap, 1, &st) == DMEM_ERR_NONE);
+    assert(st.live_count == 2 && st.live_bytes == a_size + b_size && st.peak_bytes == st.live_bytes);
+    assert(st.alloc_count == 2 && st.alloc_bytes == 300 && st.fail_count == 0);
+    assert(dmem_heap_tag_stats(&heap, 2, &st) == DMEM_ERR_NONE);
+    assert(st.live_count == 1 && st.live_bytes >= 200);
+
+    // 未标记的内存不计入
+    assert((p = dmem_heap_alloc(&heap, 64)) != NULL);
+    assert(dmem_heap_tag_of(&heap, p) == 0);
+    assert(dmem_heap_free(&heap, p) == DMEM_ERR_NONE);
+
+    // dmem_heap_realloc() 保留原标签，dmem_heap_realloc_tagged() 改为新标签，调整大小不计入分配次数
+    memset(a, 0x5A, 100);
+    assert((a = dmem_heap_realloc(&heap, a, 600)) != NULL);
+    assert(dmem_heap_tag_of(&heap, a) == 1);
+    a_size = _tag_block_size(pool, a);
+    assert(dmem_heap_tag_stats(&heap, 1, &st) == DMEM_ERR_NONE);
+    assert(st.live_count == 2 && st.live_bytes == a_size + b_size && st.alloc_count == 2);
+    assert((a = dmem_heap_realloc_tagged(&heap, a, 40, 3)) != NULL);
+    for (i = 0; i < 40; i++)
+        assert(a[i] == 0x5A);
+    assert(dmem_heap_tag_of(&heap, a) == 3);
+    assert(dmem_heap_tag_stats(&heap, 1, &st) == DMEM_ERR_NONE && st.live_count == 1 && st.live_bytes == b_size);
+    assert(dmem_heap_tag_stats(&heap, 3, &st) == DMEM_ERR_NONE && st.live_count == 1);
+
+    // 释放后移出统计，峰值保留
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, b) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, c) == DMEM_ERR_NONE);
+    for (i = 1; i <= 3; i++)
+    {
+        assert(dmem_heap_tag_stats(&heap, (uint8_t) i, &st) == DMEM_ERR_NONE);
+        assert(st.live_count == 0 && st.live_bytes == 0 && st.peak_bytes > 0);
+    }
+
+    // 超出预算的分配失败，扩展失败时保留原内存
+    assert(dmem_heap_tag_set_limit(&heap, 1, 512) == DMEM_ERR_NONE);
+    assert((a = dmem_heap_alloc_tagged(&heap, 400, 1)) != NULL);
+    assert(dmem_heap_alloc_tagged(&heap, 200, 1) == NULL);
+    assert((b = dmem_heap_alloc_tagged(&heap, 200, 2)) != NULL);      // 其他标签不受影响
+    assert(dmem_heap_realloc(&heap, a, 600) == a);
+    assert(dmem_heap_tag_stats(&heap, 1, &st) == DMEM_ERR_NONE);
+    assert(st.fail_count == 2 && st.live_count == 1 && st.limit == 512);
+    assert(dmem_heap_free(&heap, a) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, b) == DMEM_ERR_NONE);
+    assert(dmem_heap_tag_set_limit(&heap, 1, 0) == DMEM_ERR_NONE);
+
+#if ENABLE_DMEM_HUGE
+    // 带标签的内存不使用直接映射；直接映射的内存改为带标签时迁回内存池
+    dmem_heap_set_huge_threshold(&heap, 1024);
+    assert((p = dmem_heap_alloc_tagged(&heap, 2048, 4)) != NULL);
+    assert(dmem_heap_tag_of(&heap, p) == 4);
+    assert((q = dmem_heap_alloc(&heap, 2048)) != NULL && heap.huge_count == 1);
+    memset(q, 0x33, 2048);
+    assert((q = dmem_heap_realloc_tagged(&heap, q, 2048, 4)) != NULL && heap.huge_count == 0);
+    assert(dmem_heap_tag_of(&heap, q) == 4 && q[2047] == 0x33);
+    assert(dmem_heap_tag_stats(&heap, 4, &st) == DMEM_ERR_NONE && st.live_count == 2);
+    assert(dmem_heap_free(&heap, p) == DMEM_ERR_NONE);
+    assert(dmem_heap_free(&heap, q) == DMEM_ERR_NONE);
+    dmem_heap_set_huge_threshold(&heap, 0);
+#else
+    (void) q;
+#endif
+
+#if ENABLE_DMEM_ARENA
+    // 多分区内存堆的各分区共享同一预算，统计中的预算与设置的值一致
+    {
+        DMEM_DEFAULT_ALIGNED(static char arena_pool[16 * 1024]);
+        static struct dmem_arenas arenas;
+        void *x, *y;
+
+        assert(dmem_arenas_init(&arenas, arena_pool, sizeof(arena_pool), 2) == DMEM_ERR_NONE);
+        assert(dmem_arenas_tag_set_limit(&arenas, 1, 1000) == DMEM_ERR_NONE);
+        assert((x = dmem_heap_alloc_tagged(&arenas.heaps[0], 600, 1)) != NULL);
+        assert(dmem_heap_alloc_tagged(&arenas.heaps[1], 600, 1) == NULL);
+        assert((y = dmem_heap_alloc_tagged(&arenas.heaps[1], 300, 1)) != NULL);
+        assert(dmem_arenas_tag_stats(&arenas, 1, &st) == DMEM_ERR_NONE);
+        assert(st.limit == 1000 && st.live_count == 2 && st.fail_count == 1);
+        assert(dmem_heap_tag_stats(&arenas.heaps[1], 1, &st) == DMEM_ERR_NONE && st.limit == 1000);
+        assert(dmem_arenas_free(&arenas, x) == DMEM_ERR_NONE);
+        assert((x = dmem_heap_alloc_tagged(&arenas.heaps[1], 600, 1)) != NULL);
+        assert(dmem_arenas_free(&arenas, x) == DMEM_ERR_NONE);
+        assert(dmem_arenas_free(&arenas, y) == DMEM_ERR_NONE);
+        assert(arenas.tag_budget.live_bytes[1] == 0);
+    }
+#endif
+
+#if ENABLE_DMEM_TCACHE
+    dmem_tcache_flush();
+#endif
+    assert(heap.used_count == 0 && heap.free == heap.inited_free);
+
+    printf("===== [测试32通过] =====\n");
+}
+#endif
 
 void example_test(void)
 {
     printf("\n===== 开始内存管理库测试 =====\n");
     printf("内存池大小: %zu字节\n", sizeof(test_pool));
+    printf("内存分配引擎: %s\n", DMEM_ALLOC_ENGINE == DMEM_ENGINE_TLSF ? "TLSF" : "首次适配");
     printf("内存对齐要求: %d字节\n", DMEM_DEFINE_ALIGN_SIZE);
     printf("最小分配大小: %d字节\n", DMEM_MIN_ALLOC_SIZE);
     printf("内存块头大小: %zu字节\n", sizeof(mem_block_t));
@@ -690,6 +2284,52 @@ void example_test(void)
     _test_report_accuracy();        
     _test_dmem_realloc_extra();    
     _test_stress_allocation();        
+    _test_multi_heap();
+    _test_offset_width();
+    _test_free_list_first_fit();
+#if ENABLE_DMEM_SLAB
+    _test_slab();
+#endif
+#if ENABLE_DMEM_TCACHE
+    _test_tcache();
+#endif
+#if ENABLE_DMEM_ARENA
+    _test_arenas();
+#endif
+#if DMEM_ALLOC_ENGINE == DMEM_ENGINE_FIRST_FIT
+    _test_placement_policy();
+#endif
+    _test_aligned_alloc();
+    _test_batch();
+    _test_report_snapshot();
+    _test_ext_stats();
+#if ENABLE_DMEM_RECORD
+    _test_record();
+#endif
+    _test_realloc_backward();
+#if ENABLE_DMEM_EVENT
+    _test_event();
+#endif
+    _test_calloc_lazy_zero();
+#if ENABLE_DMEM_GROW
+    _test_grow();
+#endif
+#if ENABLE_DMEM_PURGE
+    _test_purge();
+#endif
+#if ENABLE_DMEM_HUGE
+    _test_huge();
+#endif
+#if ENABLE_DMEM_BUMP
+    _test_bump();
+#endif
+#if ENABLE_DMEM_HANDLE
+    _test_handle();
+#endif
+    _test_walk();
+#if ENABLE_DMEM_TAG
+    _test_tag();
+#endif
 
     printf("\n===== 所有测试通过! =====\n");
 }